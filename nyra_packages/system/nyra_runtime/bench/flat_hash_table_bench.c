@@ -0,0 +1,188 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+// The insertion and the lookup of int and string keys in the open addressing
+// 'nyra_flat_hashtable_t' of 'nyra_utils/container/flat_hash_table.h',
+// compared with the chained 'nyra_hashtable_t'. The flat table is measured
+// with and without 'nyra_flat_hashtable_reserve()'.
+//
+//   # From the root of the app, see the 'nyra_runtime_bench' target of '../BUILD.gn'.
+//   gn gen out --args='nyra_runtime_enable_tests=true'
+//   ninja -C out flat_hash_table_bench
+//   out/flat_hash_table_bench [keys]
+//
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "nyra_utils/container/flat_hash_table.h"
+#include "nyra_utils/container/hash_handle.h"
+#include "nyra_utils/container/hash_table.h"
+#include "nyra_utils/macro/field.h"
+
+#define KEY_SIZE 24
+
+typedef struct item_t {
+  nyra_hashhandle_t hh;
+  int32_t int_key;
+  char str_key[KEY_SIZE];
+} item_t;
+
+static item_t *items;
+
+// The lookups use copies of the keys, so that the string keys are really
+// compared rather than matched by their addresses.
+static int32_t *int_keys;
+static char (*str_keys)[KEY_SIZE];
+
+static size_t cnt;
+
+// Keeps the compiler from dropping the lookups.
+static volatile uintptr_t sink;
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void report(const char *name, double start, double end) {
+  printf("  %-28s %8.1f ns/op\n", name, (end - start) / (double)cnt);
+}
+
+static void bench_hashtable_int(void) {
+  nyra_hashtable_t table;
+  nyra_hashtable_init(&table, offsetof(item_t, hh));
+
+  double start = now_ns();
+  for (size_t i = 0; i < cnt; i++) {
+    nyra_hashtable_add_int(&table, &items[i].hh, &items[i].int_key, NULL);
+  }
+  double mid = now_ns();
+  for (size_t i = 0; i < cnt; i++) {
+    nyra_hashhandle_t *hh = nyra_hashtable_find_int(&table, &int_keys[i]);
+    sink += (uintptr_t)CONTAINER_OF_FROM_FIELD(hh, item_t, hh);
+  }
+  double end = now_ns();
+
+  report("nyra_hashtable_t insert", start, mid);
+  report("nyra_hashtable_t find", mid, end);
+
+  // The items are not owned by the table.
+  nyra_hashtable_deinit(&table);
+}
+
+static void bench_hashtable_string(void) {
+  nyra_hashtable_t table;
+  nyra_hashtable_init(&table, offsetof(item_t, hh));
+
+  double start = now_ns();
+  for (size_t i = 0; i < cnt; i++) {
+    nyra_hashtable_add_string(&table, &items[i].hh, items[i].str_key, NULL);
+  }
+  double mid = now_ns();
+  for (size_t i = 0; i < cnt; i++) {
+    nyra_hashhandle_t *hh = nyra_hashtable_find_string(&table, str_keys[i]);
+    sink += (uintptr_t)CONTAINER_OF_FROM_FIELD(hh, item_t, hh);
+  }
+  double end = now_ns();
+
+  report("nyra_hashtable_t insert", start, mid);
+  report("nyra_hashtable_t find", mid, end);
+
+  nyra_hashtable_deinit(&table);
+}
+
+static void bench_flat_int(bool reserve) {
+  nyra_flat_hashtable_t table;
+  nyra_flat_hashtable_init(&table, NYRA_FLAT_HASHTABLE_KEY_TYPE_U64, NULL);
+
+  double start = now_ns();
+  if (reserve) {
+    nyra_flat_hashtable_reserve(&table, cnt);
+  }
+  for (size_t i = 0; i < cnt; i++) {
+    nyra_flat_hashtable_set_int(&table, items[i].int_key, &items[i]);
+  }
+  double mid = now_ns();
+  for (size_t i = 0; i < cnt; i++) {
+    sink += (uintptr_t)nyra_flat_hashtable_get_int(&table, int_keys[i]);
+  }
+  double end = now_ns();
+
+  report(reserve ? "flat (reserved) insert" : "flat insert", start, mid);
+  report(reserve ? "flat (reserved) find" : "flat find", mid, end);
+
+  nyra_flat_hashtable_deinit(&table);
+}
+
+static void bench_flat_string(bool reserve) {
+  nyra_flat_hashtable_t table;
+  nyra_flat_hashtable_init(&table, NYRA_FLAT_HASHTABLE_KEY_TYPE_BYTES, NULL);
+
+  double start = now_ns();
+  if (reserve) {
+    nyra_flat_hashtable_reserve(&table, cnt);
+  }
+  for (size_t i = 0; i < cnt; i++) {
+    nyra_flat_hashtable_set_string(&table, items[i].str_key, &items[i]);
+  }
+  double mid = now_ns();
+  for (size_t i = 0; i < cnt; i++) {
+    sink += (uintptr_t)nyra_flat_hashtable_get_string(&table, str_keys[i]);
+  }
+  double end = now_ns();
+
+  report(reserve ? "flat (reserved) insert" : "flat insert", start, mid);
+  report(reserve ? "flat (reserved) find" : "flat find", mid, end);
+
+  nyra_flat_hashtable_deinit(&table);
+}
+
+int main(int argc, char **argv) {
+  cnt = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+  if (!cnt || cnt > INT32_MAX) {
+    fprintf(stderr, "Invalid key count.\n");
+    return 1;
+  }
+
+  items = (item_t *)calloc(cnt, sizeof(item_t));
+  int_keys = (int32_t *)calloc(cnt, sizeof(int32_t));
+  str_keys = (char (*)[KEY_SIZE])calloc(cnt, KEY_SIZE);
+  if (!items || !int_keys || !str_keys) {
+    fprintf(stderr, "Failed to allocate memory.\n");
+    return 1;
+  }
+
+  // Look the keys up in another order than the one they are inserted in.
+  srand(1);
+  for (size_t i = 0; i < cnt; i++) {
+    items[i].int_key = (int32_t)i;
+    snprintf(items[i].str_key, KEY_SIZE, "property_%zu", i);
+  }
+  for (size_t i = 0; i < cnt; i++) {
+    size_t j = (size_t)rand() % cnt;
+    int_keys[i] = items[j].int_key;
+    memcpy(str_keys[i], items[j].str_key, KEY_SIZE);
+  }
+
+  printf("%zu int keys:\n", cnt);
+  bench_hashtable_int();
+  bench_flat_int(false);
+  bench_flat_int(true);
+
+  printf("%zu string keys:\n", cnt);
+  bench_hashtable_string();
+  bench_flat_string(false);
+  bench_flat_string(true);
+
+  free(str_keys);
+  free(int_keys);
+  free(items);
+
+  return 0;
+}
@@ -0,0 +1,177 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+// The parsing of JSON texts into a 'nyra_value_t' by 'nyra_value_from_json_str()'
+// of 'nyra_utils/value/value_json_parser.h', compared with the tree path,
+// 'nyra_json_from_string()' + 'nyra_value_from_json()'. The time of a document
+// includes the destruction of its value.
+//
+// The documents are the property.json files given on the command line, the
+// ones of the example agents by default, and two LLM payloads: a streamed
+// tool-call chunk and a chat history of 200 messages.
+//
+//   # From the root of the app, see the 'nyra_runtime_bench' target of '../BUILD.gn'.
+//   gn gen out --args='nyra_runtime_enable_tests=true'
+//   ninja -C out json_parser_bench
+//   out/json_parser_bench [property.json ...]
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "nyra_utils/lib/json.h"
+#include "nyra_utils/value/value.h"
+#include "nyra_utils/value/value_json.h"
+#include "nyra_utils/value/value_json_parser.h"
+
+// Each document is parsed for at least that long by each path.
+#define MIN_BENCH_NS 200e6
+
+#define CHAT_MESSAGES 200
+
+static const char *default_files[] = {
+    "../../../../agents/examples/experimental/property.json",
+    "../../../../agents/examples/default/property.json",
+};
+
+static const char tool_call_chunk[] =
+    "{\"id\":\"chatcmpl-9hXz0sQ1\",\"object\":\"chat.completion.chunk\","
+    "\"created\":1720000000,\"model\":\"gpt-4o-mini\",\"choices\":[{\"index\":"
+    "0,\"delta\":{\"role\":\"assistant\",\"content\":null,\"tool_calls\":[{"
+    "\"index\":0,\"id\":\"call_Vx81nS2k\",\"type\":\"function\",\"function\":{"
+    "\"name\":\"get_current_weather\",\"arguments\":\"{\\\"location\\\": "
+    "\\\"San Francisco, CA\\\", \\\"unit\\\": \\\"celsius\\\"}\"}}]},"
+    "\"logprobs\":null,\"finish_reason\":null}],\"usage\":null}";
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static char *read_file(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    return NULL;
+  }
+
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+
+  char *data = size >= 0 ? (char *)malloc((size_t)size + 1) : NULL;
+  if (data && fread(data, 1, (size_t)size, f) != (size_t)size) {
+    free(data);
+    data = NULL;
+  }
+  if (data) {
+    data[size] = '\0';
+  }
+
+  fclose(f);
+  return data;
+}
+
+static char *make_chat_history(void) {
+  static const char *roles[] = {"user", "assistant"};
+  size_t cap = CHAT_MESSAGES * 256 + 64;
+  char *data = (char *)malloc(cap);
+  if (!data) {
+    return NULL;
+  }
+
+  size_t len = (size_t)snprintf(data, cap, "{\"model\":\"gpt-4o\",\"messages\":[");
+  for (int i = 0; i < CHAT_MESSAGES; i++) {
+    len += (size_t)snprintf(
+        data + len, cap - len,
+        "%s{\"role\":\"%s\",\"content\":\"Message %d of the conversation, "
+        "about the weather in Paris, the \\\"best\\\" caf\\u00e9s and the "
+        "opening hours of the museums.\\nThanks!\"}",
+        i ? "," : "", roles[i % 2], i);
+  }
+  snprintf(data + len, cap - len, "],\"stream\":true,\"temperature\":0.7}");
+
+  return data;
+}
+
+static double bench_tree(const char *json) {
+  int rounds = 0;
+  double start = now_ns();
+  double elapsed = 0;
+
+  do {
+    nyra_json_t *tree = nyra_json_from_string(json, NULL);
+    nyra_value_t *value = nyra_value_from_json(tree);
+    nyra_json_destroy(tree);
+    nyra_value_destroy(value);
+
+    rounds++;
+    elapsed = now_ns() - start;
+  } while (elapsed < MIN_BENCH_NS);
+
+  return elapsed / rounds;
+}
+
+static double bench_parser(const char *json) {
+  size_t len = strlen(json);
+  int rounds = 0;
+  double start = now_ns();
+  double elapsed = 0;
+
+  do {
+    nyra_value_t *value = nyra_value_from_json_str_with_len(json, len, NULL);
+    nyra_value_destroy(value);
+
+    rounds++;
+    elapsed = now_ns() - start;
+  } while (elapsed < MIN_BENCH_NS);
+
+  return elapsed / rounds;
+}
+
+static void bench(const char *name, const char *json) {
+  nyra_value_t *value = nyra_value_from_json_str(json, NULL);
+  if (!value) {
+    fprintf(stderr, "%s is not valid JSON, skipped.\n", name);
+    return;
+  }
+  nyra_value_destroy(value);
+
+  double tree_ns = bench_tree(json);
+  double parser_ns = bench_parser(json);
+
+  printf("%-56s %7zu B %10.1f us -> %10.1f us  %.1fx\n", name, strlen(json),
+         tree_ns / 1e3, parser_ns / 1e3, tree_ns / parser_ns);
+}
+
+int main(int argc, char **argv) {
+  const char **files = argc > 1 ? (const char **)argv + 1 : default_files;
+  int file_cnt = argc > 1 ? argc - 1
+                          : (int)(sizeof(default_files) / sizeof(char *));
+
+  printf("%-56s %9s %13s    %10s\n", "document", "size", "tree", "parser");
+
+  for (int i = 0; i < file_cnt; i++) {
+    char *json = read_file(files[i]);
+    if (!json) {
+      fprintf(stderr, "Failed to read %s.\n", files[i]);
+      continue;
+    }
+    bench(files[i], json);
+    free(json);
+  }
+
+  bench("LLM tool-call chunk", tool_call_chunk);
+
+  char *chat = make_chat_history();
+  if (chat) {
+    bench("LLM chat history", chat);
+    free(chat);
+  }
+
+  return 0;
+}
@@ -0,0 +1,139 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+// The round trip of a small message over the unix domain sockets of
+// 'nyra_utils/io/unix_socket.h', compared with the loopback TCP.
+//
+//   # From the root of the app, see the 'nyra_runtime_bench' target of '../BUILD.gn'.
+//   gn gen out --args='nyra_runtime_enable_tests=true'
+//   ninja -C out unix_socket_bench
+//   out/unix_socket_bench [round_trips]
+//
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "nyra_utils/io/unix_socket.h"
+
+#define MSG_SIZE 64
+#define TCP_PORT 38123
+
+static int listen_fd = -1;
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static bool read_full(int fd, char *buf, size_t size) {
+  size_t got = 0;
+  while (got < size) {
+    ssize_t n = read(fd, buf + got, size - got);
+    if (n <= 0) {
+      return false;
+    }
+    got += (size_t)n;
+  }
+  return true;
+}
+
+static void *echo_thread(void *arg) {
+  (void)arg;
+
+  int fd = accept(listen_fd, NULL, NULL);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  char buf[MSG_SIZE];
+  while (read_full(fd, buf, sizeof(buf))) {
+    if (write(fd, buf, sizeof(buf)) != sizeof(buf)) {
+      break;
+    }
+  }
+
+  close(fd);
+  return NULL;
+}
+
+static void run(const char *name, int family, const struct sockaddr *addr,
+                socklen_t addr_len, int round_trips) {
+  int one = 1;
+
+  listen_fd = socket(family, SOCK_STREAM, 0);
+  setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  if (bind(listen_fd, addr, addr_len) != 0 || listen(listen_fd, 1) != 0) {
+    perror(name);
+    close(listen_fd);
+    return;
+  }
+
+  pthread_t thread;
+  pthread_create(&thread, NULL, echo_thread, NULL);
+
+  int fd = socket(family, SOCK_STREAM, 0);
+  if (connect(fd, addr, addr_len) != 0) {
+    perror(name);
+    exit(EXIT_FAILURE);
+  }
+  if (family != AF_UNIX) {
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  }
+
+  char buf[MSG_SIZE] = {0};
+  double begin = now_ns();
+  for (int i = 0; i < round_trips; i++) {
+    if (write(fd, buf, sizeof(buf)) != sizeof(buf) ||
+        !read_full(fd, buf, sizeof(buf))) {
+      perror(name);
+      exit(EXIT_FAILURE);
+    }
+  }
+  double elapsed = now_ns() - begin;
+
+  printf("%-16s %8.2f us/round trip\n", name, elapsed / round_trips / 1000);
+
+  close(fd);
+  pthread_join(thread, NULL);
+  close(listen_fd);
+}
+
+int main(int argc, char **argv) {
+  int round_trips = argc > 1 ? atoi(argv[1]) : 50000;
+
+  struct sockaddr_un un;
+  socklen_t un_len = 0;
+
+  #if defined(__linux__)
+  if (nyra_unix_socket_addr_from_uri("unix://@nyra_unix_socket_bench", &un,
+                                     &un_len)) {
+    run("unix (abstract)", AF_UNIX, (struct sockaddr *)&un, un_len,
+        round_trips);
+  }
+  #endif
+
+  const char *file_uri = "unix:///tmp/nyra_unix_socket_bench.sock";
+  if (nyra_unix_socket_addr_from_uri(file_uri, &un, &un_len)) {
+    nyra_unix_socket_unlink(file_uri);
+    run("unix (file)", AF_UNIX, (struct sockaddr *)&un, un_len, round_trips);
+    nyra_unix_socket_unlink(file_uri);
+  }
+
+  struct sockaddr_in in;
+  memset(&in, 0, sizeof(in));
+  in.sin_family = AF_INET;
+  in.sin_port = htons(TCP_PORT);
+  in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  run("tcp (loopback)", AF_INET, (struct sockaddr *)&in, sizeof(in),
+      round_trips);
+
+  return 0;
+}
@@ -10,6 +10,7 @@
 #include <cxxabi.h>
 #endif
 
+#include <cstdlib>
 #include <string>
 
 #include "nyra_utils/lib/alloc.h"
@@ -26,8 +27,10 @@ NYRA_UNUSED inline std::string curr_exception_type_name() {
   char *exception_type = abi::__cxa_demangle(
       abi::__cxa_current_exception_type()->name(), nullptr, nullptr, &status);
   std::string result(exception_type);
+  // The name is allocated by the 'malloc()' of libc, not by 'NYRA_MALLOC',
+  // which might be routed to a custom allocator.
   // NOLINTNEXTLINE(cppcoreguidelines-no-malloc,cppcoreguidelines-owning-memory,hicpp-no-malloc)
-  NYRA_FREE(exception_type);
+  free(exception_type);
   return result;
 }
 #else
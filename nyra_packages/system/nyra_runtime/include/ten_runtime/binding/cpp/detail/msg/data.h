@@ -14,6 +14,7 @@
 
 #include "nyra_runtime/binding/cpp/detail/msg/msg.h"
 #include "nyra_runtime/msg/data/data.h"
+#include "nyra_utils/lang/cpp/io/mmap_file.h"
 #include "nyra_utils/lang/cpp/lib/buf.h"
 #include "nyra_utils/lib/smart_ptr.h"
 
@@ -60,7 +61,17 @@ class data_t : public msg_t {
     return nyra_data_alloc_buf(c_msg, size) != nullptr;
   }
 
+  // The buf set from an mmap file is read-only, so it could not be locked, use
+  // 'get_buf()' to read it.
   buf_t lock_buf(error_t *err = nullptr) {
+    if (nyra_data_is_buf_read_only(c_msg)) {
+      if (err != nullptr && err->get_c_error() != nullptr) {
+        nyra_error_set(err->get_c_error(), NYRA_ERRNO_GENERIC,
+                      "The buf is a read-only mmap file view.");
+      }
+      return {};
+    }
+
     if (!nyra_msg_add_locked_res_buf(
             c_msg, nyra_data_peek_buf(c_msg)->data,
             err != nullptr ? err->get_c_error() : nullptr)) {
@@ -98,6 +109,21 @@ class data_t : public msg_t {
     return buf;
   }
 
+  // Use the content of `file` as the buf without copying. The data message
+  // keeps the file mapped until it is destroyed, and the buf is read-only.
+  bool set_buf(const mmap_file_t &file, error_t *err = nullptr) {
+    if (!file.is_valid()) {
+      if (err != nullptr && err->get_c_error() != nullptr) {
+        nyra_error_set(err->get_c_error(), NYRA_ERRNO_INVALID_ARGUMENT,
+                      "Invalid mmap file.");
+      }
+      return false;
+    }
+
+    return nyra_data_set_buf_with_mmap_file(
+        c_msg, file.c_file, err != nullptr ? err->get_c_error() : nullptr);
+  }
+
   // @{
   data_t(data_t &other) = delete;
   data_t(data_t &&other) = delete;
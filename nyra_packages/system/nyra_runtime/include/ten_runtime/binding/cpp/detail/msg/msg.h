@@ -8,11 +8,16 @@
 
 #include "nyra_runtime/nyra_config.h"
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include "nyra_runtime/common/errno.h"
 #include "nyra_runtime/msg/msg.h"
+#include "nyra_runtime/msg/msg_arena.h"
 #include "nyra_utils/lang/cpp/lib/error.h"
+#include "nyra_utils/lang/cpp/lib/fixed_layout.h"
+#include "nyra_utils/lang/cpp/lib/struct_binding.h"
 #include "nyra_utils/lang/cpp/lib/value.h"
 #include "nyra_utils/lib/buf.h"
 #include "nyra_utils/lib/json.h"
@@ -21,6 +26,7 @@
 #include "nyra_utils/value/value.h"
 #include "nyra_utils/value/value_get.h"
 #include "nyra_utils/value/value_json.h"
+#include "nyra_utils/value/value_json_parser.h"
 
 namespace ten {
 
@@ -224,41 +230,39 @@ class msg_t {
 
   std::string get_property_to_json(const char *path = nullptr,
                                    error_t *err = nullptr) const {
+    std::string result;
+    get_property_to_json(path, result, err);
+    return result;
+  }
+
+  /**
+   * @brief Append the JSON text of the property at @a path to @a out. The
+   * memory of @a out is reused, so a string which is cleared and kept across
+   * the calls stops allocating once it is big enough.
+   */
+  bool get_property_to_json(const char *path, std::string &out,
+                            error_t *err = nullptr) const {
     if (c_msg == nullptr) {
       if (err != nullptr && err->get_c_error() != nullptr) {
         nyra_error_set(err->get_c_error(), NYRA_ERRNO_INVALID_ARGUMENT,
                       "Invalid NYRA message.");
       }
-      return "";
+      return false;
     }
 
-    std::string result;
-
     auto *value = peek_property_value(path, err);
     if (value == nullptr) {
-      return result;
+      return false;
     }
-    nyra_json_t *c_json = nyra_value_to_json(value);
-    if (c_json == nullptr) {
+    if (!value_t::write_json(value, out)) {
       if (err != nullptr && err->get_c_error() != nullptr) {
         nyra_error_set(err->get_c_error(), NYRA_ERRNO_GENERIC,
-                      "Invalid NYRA message.");
+                      "Failed to write JSON.");
       }
-      return result;
-    }
-
-    bool must_free = false;
-    const char *json_str = nyra_json_to_string(c_json, nullptr, &must_free);
-    NYRA_ASSERT(json_str, "Failed to convert a JSON to a string");
-
-    result = json_str;
-
-    nyra_json_destroy(c_json);
-    if (must_free) {
-      NYRA_FREE(json_str);
+      return false;
     }
 
-    return result;
+    return true;
   }
 
   bool set_property(const char *path, int8_t value, error_t *err = nullptr) {
@@ -344,11 +348,60 @@ class msg_t {
       }
       return false;
     }
+    NYRA_ASSERT(c_msg, "Should not happen.");
+
+    // The copy is carved from the arena of the message, if it has one.
     nyra_buf_t buf;
-    nyra_buf_init_with_copying_data(&buf, value.data(), value.size());
+    nyra_msg_init_buf_with_copying_data(c_msg, &buf, value.data(),
+                                       value.size());
     return set_property_impl(path, nyra_value_create_buf_with_move(buf), err);
   }
 
+  // Set an array property. The items of @a value are moved rather than cloned,
+  // and @a value is left empty.
+  template <typename V>
+  bool set_property(const char *path, std::vector<V> &&value,
+                    error_t *err = nullptr) {
+    value_t array(std::move(value));
+    nyra_value_t *c_value = array.c_value_;
+    array.c_value_ = nullptr;
+    return set_property_impl(path, c_value, err);
+  }
+
+  // Set an object property. The values of @a value are moved rather than
+  // cloned, and @a value is left empty.
+  template <typename V>
+  bool set_property(const char *path, std::map<std::string, V> &&value,
+                    error_t *err = nullptr) {
+    value_t object(std::move(value));
+    nyra_value_t *c_value = object.c_value_;
+    object.c_value_ = nullptr;
+    return set_property_impl(path, c_value, err);
+  }
+
+  /**
+   * @brief Let the buf properties set afterwards be carved from an arena owned
+   * by this message, rather than allocated one by one. It is worth it for the
+   * messages carrying several bufs, ex: audio/video frames with side data.
+   *
+   * @param chunk_size 0 for the default one.
+   */
+  bool enable_arena(size_t chunk_size = 0, error_t *err = nullptr) {
+    NYRA_ASSERT(c_msg, "Should not happen.");
+
+    if (c_msg == nullptr) {
+      if (err != nullptr && err->get_c_error() != nullptr) {
+        nyra_error_set(err->get_c_error(), NYRA_ERRNO_GENERIC,
+                      "Invalid NYRA message.");
+      }
+      return false;
+    }
+
+    return nyra_msg_enable_arena(c_msg, chunk_size,
+                                err != nullptr ? err->get_c_error()
+                                               : nullptr) != nullptr;
+  }
+
   bool set_property_from_json(const char *path, const char *json,
                               error_t *err = nullptr) {
     NYRA_ASSERT(c_msg, "Should not happen.");
@@ -361,18 +414,93 @@ class msg_t {
       return false;
     }
 
-    nyra_json_t *c_json = nyra_json_from_string(
+    nyra_value_t *value = nyra_value_from_json_str(
         json, err != nullptr ? err->get_c_error() : nullptr);
-    if (c_json == nullptr) {
+    if (value == nullptr) {
       return false;
     }
 
-    nyra_value_t *value = nyra_value_from_json(c_json);
-    nyra_json_destroy(c_json);
-
     return set_property_impl(path, value, err);
   }
 
+  /**
+   * @brief Fill @a result, a struct bound by NYRA_STRUCT_BINDING, from the
+   * object at @a path in one pass.
+   */
+  template <typename S>
+  bool get_property_struct(const char *path, S &result,
+                           error_t *err = nullptr) const {
+    if (c_msg == nullptr) {
+      if (err != nullptr && err->get_c_error() != nullptr) {
+        nyra_error_set(err->get_c_error(), NYRA_ERRNO_INVALID_ARGUMENT,
+                      "Invalid NYRA message.");
+      }
+      return false;
+    }
+
+    auto *value = peek_property_value(path, err);
+    if (value == nullptr) {
+      return false;
+    }
+
+    error_t cpp_err;
+    bool rc = struct_from_value(value, result, cpp_err.get_c_error());
+    if (!rc && err != nullptr && err->get_c_error() != nullptr) {
+      nyra_error_copy(err->get_c_error(), cpp_err.get_c_error());
+    }
+
+    return rc;
+  }
+
+  /**
+   * @brief Set the members of @a value, a struct bound by NYRA_STRUCT_BINDING,
+   * as an object at @a path, without going through 'value_t'.
+   */
+  template <typename S>
+  bool set_property_struct(const char *path, const S &value,
+                           error_t *err = nullptr) {
+    return set_property_impl(path, struct_to_value(value), err);
+  }
+
+  /**
+   * @brief Set @a value, a trivially copyable struct bound by
+   * NYRA_STRUCT_BINDING, at @a path as a fixed layout, see 'fixed_layout.h'.
+   */
+  template <typename S>
+  bool set_property_fixed(const char *path, const S &value,
+                          error_t *err = nullptr) {
+    return set_property_impl(path, fixed_layout_to_value(value), err);
+  }
+
+  /**
+   * @brief Fill @a result from the fixed layout at @a path, or from the object
+   * of dynamic properties at @a path if it has been set as such.
+   */
+  template <typename S>
+  bool get_property_fixed(const char *path, S &result,
+                          error_t *err = nullptr) const {
+    if (c_msg == nullptr) {
+      if (err != nullptr && err->get_c_error() != nullptr) {
+        nyra_error_set(err->get_c_error(), NYRA_ERRNO_INVALID_ARGUMENT,
+                      "Invalid NYRA message.");
+      }
+      return false;
+    }
+
+    auto *value = peek_property_value(path, err);
+    if (value == nullptr) {
+      return false;
+    }
+
+    error_t cpp_err;
+    bool rc = fixed_layout_from_value(value, result, cpp_err.get_c_error());
+    if (!rc && err != nullptr && err->get_c_error() != nullptr) {
+      nyra_error_copy(err->get_c_error(), cpp_err.get_c_error());
+    }
+
+    return rc;
+  }
+
   // Internal use only.
   nyra_shared_ptr_t *get_underlying_msg() const { return c_msg; }
 
@@ -395,6 +523,15 @@ class msg_t {
                          error_t *err = nullptr) {
     NYRA_ASSERT(c_msg, "Should not happen.");
 
+    if (nyra_msg_property_path_is_private(path)) {
+      if (err != nullptr && err->get_c_error() != nullptr) {
+        nyra_error_set(err->get_c_error(), NYRA_ERRNO_INVALID_ARGUMENT,
+                      "Private property: %s", path);
+      }
+      nyra_value_destroy(value);
+      return false;
+    }
+
     bool rc = nyra_msg_set_property(
         c_msg, path, value, err != nullptr ? err->get_c_error() : nullptr);
 
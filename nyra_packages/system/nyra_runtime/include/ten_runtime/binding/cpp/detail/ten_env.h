@@ -7,7 +7,10 @@
 #pragma once
 
 #include <functional>
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "nyra_runtime/binding/common.h"
 #include "nyra_runtime/binding/cpp/detail/msg/audio_frame.h"
@@ -20,9 +23,11 @@
 #include "nyra_runtime/ten.h"
 #include "nyra_runtime/nyra_env/internal/metadata.h"
 #include "nyra_runtime/nyra_env/internal/on_xxx_done.h"
+#include "nyra_runtime/nyra_env/internal/property_watcher.h"
 #include "nyra_runtime/nyra_env/internal/return.h"
 #include "nyra_runtime/nyra_env/nyra_env.h"
 #include "nyra_utils/lang/cpp/lib/error.h"
+#include "nyra_utils/lang/cpp/lib/struct_binding.h"
 #include "nyra_utils/lang/cpp/lib/value.h"
 #include "nyra_utils/lib/buf.h"
 #include "nyra_utils/lib/error.h"
@@ -30,6 +35,7 @@
 #include "nyra_utils/macro/check.h"
 #include "nyra_utils/value/value.h"
 #include "nyra_utils/value/value_json.h"
+#include "nyra_utils/value/value_json_parser.h"
 
 using nyra_env_t = struct nyra_env_t;
 
@@ -50,6 +56,9 @@ using result_handler_func_t =
 
 using error_handler_func_t = std::function<void(nyra_env_t &, error_t *)>;
 
+using property_changed_func_t =
+    std::function<void(nyra_env_t &, const std::vector<std::string> &)>;
+
 class nyra_env_t {
  public:
   // @{
@@ -310,52 +319,93 @@ class nyra_env_t {
 
   std::string get_property_to_json(const char *path, error_t *err = nullptr) {
     std::string result;
+    get_property_to_json(path, result, err);
+    return result;
+  }
 
+  /**
+   * @brief Append the JSON text of the property at @a path to @a out. The
+   * memory of @a out is reused, so a string which is cleared and kept across
+   * the calls stops allocating once it is big enough.
+   */
+  bool get_property_to_json(const char *path, std::string &out,
+                            error_t *err = nullptr) {
     if ((path == nullptr) || (strlen(path) == 0)) {
       if (err != nullptr && err->get_c_error() != nullptr) {
         nyra_error_set(err->get_c_error(), NYRA_ERRNO_INVALID_ARGUMENT,
                       "path should not be empty.");
       }
-      return result;
+      return false;
     }
 
     auto *value = peek_property_value(path, err);
     if (value == nullptr) {
-      return result;
-    }
-    nyra_json_t *c_json = nyra_value_to_json(value);
-    if (c_json == nullptr) {
-      return result;
+      return false;
     }
-
-    bool must_free = false;
-    const char *json_str = nyra_json_to_string(c_json, nullptr, &must_free);
-    NYRA_ASSERT(json_str, "Failed to convert a JSON to a string");
-
-    result = json_str;
-
-    nyra_json_destroy(c_json);
-    if (must_free) {
-      NYRA_FREE(json_str);
+    if (!value_t::write_json(value, out)) {
+      if (err != nullptr && err->get_c_error() != nullptr) {
+        nyra_error_set(err->get_c_error(), NYRA_ERRNO_GENERIC,
+                      "Failed to write JSON.");
+      }
+      return false;
     }
 
-    return result;
+    return true;
   }
 
   bool set_property_from_json(const char *path, const char *json_str,
                               error_t *err = nullptr) {
-    nyra_json_t *c_json = nyra_json_from_string(
+    nyra_value_t *value = nyra_value_from_json_str(
         json_str, err != nullptr ? err->get_c_error() : nullptr);
-    if (c_json == nullptr) {
+    if (value == nullptr) {
       return false;
     }
 
-    nyra_value_t *value = nyra_value_from_json(c_json);
-    nyra_json_destroy(c_json);
-
     return set_property_impl(path, value, err);
   }
 
+  /**
+   * @brief Fill @a result, a struct bound by NYRA_STRUCT_BINDING, from the
+   * object at @a path in one pass.
+   */
+  template <typename S>
+  bool get_property_struct(const char *path, S &result,
+                           error_t *err = nullptr) {
+    if ((path == nullptr) || (strlen(path) == 0)) {
+      if (err != nullptr && err->get_c_error() != nullptr) {
+        nyra_error_set(err->get_c_error(), NYRA_ERRNO_INVALID_ARGUMENT,
+                      "path should not be empty.");
+      }
+      return false;
+    }
+
+    auto *value = peek_property_value(path, err);
+    if (value == nullptr) {
+      return false;
+    }
+
+    error_t cpp_err;
+    bool rc = struct_from_value(value, result, cpp_err.get_c_error());
+    if (!rc) {
+      NYRA_LOGW("Failed to get property %s: %s", path, cpp_err.err_msg());
+    }
+    if (err != nullptr) {
+      nyra_error_copy(err->get_c_error(), cpp_err.get_c_error());
+    }
+
+    return rc;
+  }
+
+  /**
+   * @brief Set the members of @a value, a struct bound by NYRA_STRUCT_BINDING,
+   * as an object at @a path, without going through 'value_t'.
+   */
+  template <typename S>
+  bool set_property_struct(const char *path, const S &value,
+                           error_t *err = nullptr) {
+    return set_property_impl(path, struct_to_value(value), err);
+  }
+
   uint8_t get_property_uint8(const char *path, error_t *err = nullptr) {
     nyra_value_t *c_value = peek_property_value(path, err);
     if (c_value == nullptr) {
@@ -661,6 +711,67 @@ class nyra_env_t {
     return set_property_impl(path, nyra_value_create_buf_with_move(buf), err);
   }
 
+  // Set an array property. The items of @a value are moved rather than cloned,
+  // and @a value is left empty.
+  template <typename V>
+  bool set_property(const char *path, std::vector<V> &&value,
+                    error_t *err = nullptr) {
+    value_t array(std::move(value));
+    nyra_value_t *c_value = array.c_value_;
+    array.c_value_ = nullptr;
+    return set_property_impl(path, c_value, err);
+  }
+
+  // Set an object property. The values of @a value are moved rather than
+  // cloned, and @a value is left empty.
+  template <typename V>
+  bool set_property(const char *path, std::map<std::string, V> &&value,
+                    error_t *err = nullptr) {
+    value_t object(std::move(value));
+    nyra_value_t *c_value = object.c_value_;
+    object.c_value_ = nullptr;
+    return set_property_impl(path, c_value, err);
+  }
+
+  /**
+   * @brief Call @a on_changed, on the runloop of the extension, when the
+   * properties under @a subtree ("" for all of them) are set through this
+   * nyra_env_t. The changes made in a row are batched into a single call.
+   *
+   * @return The id of the subscription, 0 on error.
+   */
+  uint64_t subscribe_property(const char *subtree,
+                              property_changed_func_t &&on_changed,
+                              error_t *err = nullptr) {
+    NYRA_ASSERT(c_nyra_env, "Should not happen.");
+
+    if (subtree == nullptr || on_changed == nullptr) {
+      if (err != nullptr && err->get_c_error() != nullptr) {
+        nyra_error_set(err->get_c_error(), NYRA_ERRNO_INVALID_ARGUMENT,
+                      "subtree and on_changed are required.");
+      }
+      return 0;
+    }
+
+    if (property_watcher == nullptr) {
+      property_watcher = nyra_env_property_watcher_create(c_nyra_env);
+    }
+
+    return nyra_env_property_watcher_subscribe(
+        property_watcher, subtree, proxy_handle_property_changed,
+        new property_changed_func_t(std::move(on_changed)),
+        [](void *user_data) {
+          delete static_cast<property_changed_func_t *>(user_data);
+        });
+  }
+
+  bool unsubscribe_property(uint64_t id) {
+    NYRA_ASSERT(c_nyra_env, "Should not happen.");
+
+    return property_watcher != nullptr &&
+           nyra_env_property_watcher_unsubscribe(property_watcher, id);
+  }
+
   bool on_configure_done(error_t *err = nullptr) {
     NYRA_ASSERT(c_nyra_env, "Should not happen.");
 
@@ -755,6 +866,9 @@ class nyra_env_t {
 
   ::nyra_env_t *c_nyra_env;
 
+  // Created by the first subscription.
+  ::nyra_env_property_watcher_t *property_watcher = nullptr;
+
   explicit nyra_env_t(::nyra_env_t *c_nyra_env) : c_nyra_env(c_nyra_env) {
     NYRA_ASSERT(c_nyra_env, "Should not happen.");
 
@@ -763,7 +877,13 @@ class nyra_env_t {
         static_cast<void *>(this));
   }
 
-  ~nyra_env_t() { NYRA_ASSERT(c_nyra_env, "Should not happen."); }
+  ~nyra_env_t() {
+    NYRA_ASSERT(c_nyra_env, "Should not happen.");
+
+    if (property_watcher != nullptr) {
+      nyra_env_property_watcher_destroy(property_watcher);
+    }
+  }
 
   ::nyra_env_t *get_c_nyra_env() { return c_nyra_env; }
 
@@ -859,6 +979,8 @@ class nyra_env_t {
 
     if (!rc) {
       nyra_value_destroy(value);
+    } else if (property_watcher != nullptr) {
+      nyra_env_property_watcher_notify(property_watcher, path);
     }
     return rc;
   }
@@ -902,6 +1024,19 @@ class nyra_env_t {
     }
   }
 
+  static void proxy_handle_property_changed(::nyra_env_t *nyra_env,
+                                            const char *const *paths,
+                                            size_t paths_count,
+                                            void *user_data) {
+    auto *on_changed = static_cast<property_changed_func_t *>(user_data);
+    auto *cpp_nyra_env =
+        static_cast<nyra_env_t *>(nyra_binding_handle_get_me_in_target_lang(
+            reinterpret_cast<nyra_binding_handle_t *>(nyra_env)));
+
+    std::vector<std::string> changed_paths(paths, paths + paths_count);
+    (*on_changed)(*cpp_nyra_env, changed_paths);
+  }
+
   static void proxy_handle_error(::nyra_env_t *nyra_env,
                                  nyra_shared_ptr_t *c_cmd_result, void *cb_data,
                                  nyra_error_t *err) {
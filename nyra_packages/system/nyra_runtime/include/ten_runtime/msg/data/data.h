@@ -10,9 +10,18 @@
 
 #include <stddef.h>
 
+#include "nyra_runtime/msg/msg.h"
+#include "nyra_utils/io/mmap_file.h"
 #include "nyra_utils/lib/buf.h"
 #include "nyra_utils/lib/error.h"
 #include "nyra_utils/lib/smart_ptr.h"
+#include "nyra_utils/value/value.h"
+#include "nyra_utils/value/value_get.h"
+#include "nyra_utils/value/value_is.h"
+
+// The private property which keeps the mmap file view alive as long as the data
+// message, see 'nyra_data_set_buf_with_mmap_file()'.
+#define NYRA_DATA_MMAP_FILE_PROPERTY NYRA_MSG_PRIVATE_PROPERTY_NS ".mmap_file"
 
 typedef struct nyra_data_t nyra_data_t;
 
@@ -26,3 +35,86 @@ NYRA_RUNTIME_API void nyra_data_set_buf_with_move(nyra_shared_ptr_t *self,
 
 NYRA_RUNTIME_API uint8_t *nyra_data_alloc_buf(nyra_shared_ptr_t *self,
                                             size_t size);
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_data_mmap_file_value_copy_(nyra_value_t *dest,
+                                                  nyra_value_t *src,
+                                                  nyra_error_t *err) {
+  (void)err;
+  dest->content.ptr = src->content.ptr;
+  nyra_mmap_file_retain((nyra_mmap_file_t *)dest->content.ptr);
+  return true;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_data_mmap_file_value_destruct_(nyra_value_t *value,
+                                                      nyra_error_t *err) {
+  (void)err;
+  nyra_mmap_file_release((nyra_mmap_file_t *)value->content.ptr);
+  return true;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_mmap_file_t *nyra_data_peek_mmap_file_(
+    nyra_shared_ptr_t *self) {
+  if (!nyra_msg_is_property_exist(self, NYRA_DATA_MMAP_FILE_PROPERTY, NULL)) {
+    return NULL;
+  }
+
+  nyra_value_t *holder =
+      nyra_msg_peek_property(self, NYRA_DATA_MMAP_FILE_PROPERTY, NULL);
+  if (!holder || !nyra_value_is_ptr(holder)) {
+    return NULL;
+  }
+
+  return (nyra_mmap_file_t *)nyra_value_get_ptr(holder, NULL);
+}
+
+/**
+ * @brief Use the mmap file view @a file as the buf of the data message without
+ * copying. The message takes one reference of @a file, which is dropped when
+ * the message (and all its clones) are destroyed, so the caller could release
+ * its own reference right after this call.
+ *
+ * @note The view is read-only, so the buf could not be locked for writing, see
+ * 'nyra_data_is_buf_read_only()'. It is only valid in the current process. When
+ * the message is sent to another app, the buf content is serialized as usual.
+ */
+static inline bool nyra_data_set_buf_with_mmap_file(nyra_shared_ptr_t *self,
+                                                   nyra_mmap_file_t *file,
+                                                   nyra_error_t *err) {
+  NYRA_ASSERT(self && file && nyra_mmap_file_check_integrity(file),
+             "Invalid argument.");
+
+  nyra_mmap_file_retain(file);
+
+  nyra_value_t *holder = nyra_value_create_ptr(
+      file, NULL, nyra_data_mmap_file_value_copy_,
+      nyra_data_mmap_file_value_destruct_);
+  if (!nyra_msg_set_property(self, NYRA_DATA_MMAP_FILE_PROPERTY, holder,
+                            err)) {
+    // The reference taken above is dropped by the destructor of 'holder'.
+    nyra_value_destroy(holder);
+    return false;
+  }
+
+  nyra_buf_t buf = nyra_mmap_file_to_buf(file);
+  nyra_data_set_buf_with_move(self, &buf);
+
+  return true;
+}
+
+/**
+ * @brief Check if the buf of the data message is an mmap file view, which is
+ * mapped read-only, so it must not be written, ex: through a locked buf.
+ */
+static inline bool nyra_data_is_buf_read_only(nyra_shared_ptr_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  nyra_mmap_file_t *file = nyra_data_peek_mmap_file_(self);
+  nyra_buf_t *buf = nyra_data_peek_buf(self);
+
+  // The buf might have been replaced since, ex: by 'nyra_data_alloc_buf()'.
+  return file && buf && buf->data &&
+         (const uint8_t *)buf->data == nyra_mmap_file_get_data(file);
+}
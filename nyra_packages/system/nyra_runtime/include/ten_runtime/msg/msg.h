@@ -8,7 +8,9 @@
 
 #include "nyra_runtime/nyra_config.h"
 
+#include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "nyra_utils/container/list.h"
 #include "nyra_utils/value/value.h"
@@ -30,6 +32,16 @@ typedef struct nyra_msg_t nyra_msg_t;
 //   This can be declared in 'dests' in the graph declaration. The message
 //   will be cloned to N copies, and sent to the N destinations.
 
+// The properties under this key are not user properties. The runtime headers
+// use them to tie a resource to the lifetime of a message, ex: the mmap file
+// behind the buf of a data message, and the C++ and Go bindings refuse to set
+// them, so such a resource could not be released while the message still
+// refers to it.
+//
+// Note: 'nyra_msg_set_property()' itself and the Python binding do not check
+// the prefix, so C and Python code must not write paths under it.
+#define NYRA_MSG_PRIVATE_PROPERTY_NS "__nyra"
+
 // Note: To achieve the best compatibility, any new enum item, whether it is
 // cmd/data/video_frame/audio_frame, should be added to the end to avoid
 // changing the value of previous enum items.
@@ -69,7 +81,9 @@ NYRA_RUNTIME_API bool nyra_msg_set_property(nyra_shared_ptr_t *self,
 
 // Because each NYRA extension has its own messages (in almost all cases, except
 // for the data-type messages), so the returned value_kv of this function is
-// from the message directly, not a cloned one.
+// from the message directly, not a cloned one. Its bufs might be carved from
+// the arena of the message, see 'nyra_msg_clone_property()' in 'msg_arena.h'
+// to clone it out of the message.
 NYRA_RUNTIME_API nyra_value_t *nyra_msg_peek_property(nyra_shared_ptr_t *self,
                                                    const char *path,
                                                    nyra_error_t *err);
@@ -99,3 +113,17 @@ NYRA_RUNTIME_API NYRA_MSG_TYPE nyra_msg_get_type(nyra_shared_ptr_t *self);
 
 NYRA_RUNTIME_API bool nyra_msg_set_name(nyra_shared_ptr_t *self,
                                       const char *msg_name, nyra_error_t *err);
+
+/**
+ * @brief Check if @a path refers to the private properties of the message, see
+ * 'NYRA_MSG_PRIVATE_PROPERTY_NS'.
+ */
+static inline bool nyra_msg_property_path_is_private(const char *path) {
+  size_t ns_len = strlen(NYRA_MSG_PRIVATE_PROPERTY_NS);
+  if (!path || strncmp(path, NYRA_MSG_PRIVATE_PROPERTY_NS, ns_len) != 0) {
+    return false;
+  }
+
+  char next = path[ns_len];
+  return next == '\0' || next == '.' || next == '[';
+}
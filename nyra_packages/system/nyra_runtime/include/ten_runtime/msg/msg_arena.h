@@ -0,0 +1,290 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_runtime/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nyra_runtime/msg/msg.h"
+#include "nyra_utils/lib/arena.h"
+#include "nyra_utils/lib/buf.h"
+#include "nyra_utils/container/list.h"
+#include "nyra_utils/lib/error.h"
+#include "nyra_utils/lib/smart_ptr.h"
+#include "nyra_utils/value/value.h"
+#include "nyra_utils/value/value_get.h"
+#include "nyra_utils/value/value_is.h"
+
+// A message could own an optional 'nyra_arena_t', from which the buffers of its
+// properties are carved, so building a message with a handful of buf
+// properties costs a single heap allocation rather than one per property. The
+// arena is held by a private property of the message, so it is released
+// together with the message when the last 'nyra_shared_ptr_t' is dropped.
+//
+// The arena is not thread safe, and the clones of a message could be filled by
+// different extensions on different threads, so a clone never allocates from
+// the arena of its origin. It starts without an arena, and only keeps a
+// reference of the arenas of its origins, since the cloned bufs might still
+// point into them.
+//
+// A buf carved from the arena does not own its memory, and neither does a
+// clone of it made by 'nyra_value_clone()', so a property which holds one, at
+// any depth, must not be cloned out of the message with 'nyra_value_clone()'
+// if the clone could outlive the message. Use 'nyra_msg_clone_property()'
+// instead, which gives the bufs of the clone their own memory.
+#define NYRA_MSG_ARENA_PROPERTY NYRA_MSG_PRIVATE_PROPERTY_NS ".arena"
+
+typedef struct nyra_msg_arena_holder_t {
+  // The arena from which the bufs of this message are carved, NULL if it does
+  // not have one.
+  nyra_arena_t *arena;
+
+  // The arenas of the messages this one has been cloned from, which are never
+  // allocated from.
+  nyra_arena_t **inherited;
+  size_t inherited_cnt;
+} nyra_msg_arena_holder_t;
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_msg_arena_holder_t *nyra_msg_arena_holder_create_(
+    nyra_arena_t *arena, size_t inherited_cnt) {
+  nyra_msg_arena_holder_t *self =
+      (nyra_msg_arena_holder_t *)NYRA_MALLOC(sizeof(nyra_msg_arena_holder_t));
+  NYRA_ASSERT(self, "Failed to allocate memory.");
+
+  self->arena = arena;
+  self->inherited = NULL;
+  self->inherited_cnt = inherited_cnt;
+  if (inherited_cnt) {
+    self->inherited =
+        (nyra_arena_t **)NYRA_MALLOC(inherited_cnt * sizeof(nyra_arena_t *));
+    NYRA_ASSERT(self->inherited, "Failed to allocate memory.");
+  }
+
+  return self;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_msg_arena_holder_destroy_(
+    nyra_msg_arena_holder_t *self) {
+  if (self->arena) {
+    nyra_arena_release(self->arena);
+  }
+  for (size_t i = 0; i < self->inherited_cnt; i++) {
+    nyra_arena_release(self->inherited[i]);
+  }
+  if (self->inherited) {
+    NYRA_FREE_(self->inherited);
+  }
+  NYRA_FREE_(self);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_msg_arena_value_copy_(nyra_value_t *dest,
+                                             nyra_value_t *src,
+                                             nyra_error_t *err) {
+  (void)err;
+
+  nyra_msg_arena_holder_t *origin =
+      (nyra_msg_arena_holder_t *)src->content.ptr;
+
+  // The clone gets no arena of its own, and keeps all the arenas of its origin
+  // alive.
+  size_t cnt = origin->inherited_cnt + (origin->arena ? 1 : 0);
+  nyra_msg_arena_holder_t *clone = nyra_msg_arena_holder_create_(NULL, cnt);
+  for (size_t i = 0; i < origin->inherited_cnt; i++) {
+    clone->inherited[i] = origin->inherited[i];
+  }
+  if (origin->arena) {
+    clone->inherited[cnt - 1] = origin->arena;
+  }
+  for (size_t i = 0; i < cnt; i++) {
+    nyra_arena_retain(clone->inherited[i]);
+  }
+
+  dest->content.ptr = clone;
+  return true;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_msg_arena_value_destruct_(nyra_value_t *value,
+                                                 nyra_error_t *err) {
+  (void)err;
+  nyra_msg_arena_holder_destroy_(
+      (nyra_msg_arena_holder_t *)value->content.ptr);
+  return true;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_msg_arena_holder_t *nyra_msg_peek_arena_holder_(
+    nyra_shared_ptr_t *self) {
+  if (!nyra_msg_is_property_exist(self, NYRA_MSG_ARENA_PROPERTY, NULL)) {
+    return NULL;
+  }
+
+  nyra_value_t *holder =
+      nyra_msg_peek_property(self, NYRA_MSG_ARENA_PROPERTY, NULL);
+  if (!holder || !nyra_value_is_ptr(holder)) {
+    return NULL;
+  }
+
+  return (nyra_msg_arena_holder_t *)nyra_value_get_ptr(holder, NULL);
+}
+
+/**
+ * @brief The arena of the message, NULL if it does not have one. A clone does
+ * not have one until 'nyra_msg_enable_arena()' is called on it.
+ */
+static inline nyra_arena_t *nyra_msg_get_arena(nyra_shared_ptr_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  nyra_msg_arena_holder_t *holder = nyra_msg_peek_arena_holder_(self);
+  return holder ? holder->arena : NULL;
+}
+
+/**
+ * @brief Attach an arena to the message if it does not have one yet.
+ *
+ * @param chunk_size 0 for the default one.
+ *
+ * @return The arena of the message, NULL if it could not be attached.
+ */
+static inline nyra_arena_t *nyra_msg_enable_arena(nyra_shared_ptr_t *self,
+                                                 size_t chunk_size,
+                                                 nyra_error_t *err) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  nyra_msg_arena_holder_t *holder = nyra_msg_peek_arena_holder_(self);
+  if (holder) {
+    // A clone gets a fresh arena, which is only touched by its own thread.
+    if (!holder->arena) {
+      holder->arena = nyra_arena_create(chunk_size);
+    }
+    return holder->arena;
+  }
+
+  nyra_arena_t *arena = nyra_arena_create(chunk_size);
+
+  // The ownership of the only reference is transferred to the holder.
+  nyra_value_t *value = nyra_value_create_ptr(
+      nyra_msg_arena_holder_create_(arena, 0), NULL,
+      nyra_msg_arena_value_copy_, nyra_msg_arena_value_destruct_);
+  if (!nyra_msg_set_property(self, NYRA_MSG_ARENA_PROPERTY, value, err)) {
+    // The arena is released by the destructor of 'value'.
+    nyra_value_destroy(value);
+    return NULL;
+  }
+
+  return arena;
+}
+
+// Give the bufs under @a value which do not own their memory a copy of it, so
+// that @a value no longer points into an arena.
+//
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_msg_arena_own_bufs_(nyra_value_t *value) {
+  if (nyra_value_is_buf(value)) {
+    nyra_buf_t *buf = nyra_value_peek_buf(value);
+    if (!buf->owns_memory && buf->data) {
+      nyra_buf_t copy;
+      nyra_buf_init_with_copying_data(&copy, buf->data, buf->size);
+      *buf = copy;
+    }
+  } else if (nyra_value_is_object(value)) {
+    nyra_value_object_foreach(value, iter) {
+      nyra_value_kv_t *kv = (nyra_value_kv_t *)nyra_ptr_listnode_get(iter.node);
+      NYRA_ASSERT(kv, "Invalid argument.");
+      nyra_msg_arena_own_bufs_(kv->value);
+    }
+  } else if (nyra_value_is_array(value)) {
+    nyra_value_array_foreach(value, iter) {
+      nyra_value_t *item = (nyra_value_t *)nyra_ptr_listnode_get(iter.node);
+      NYRA_ASSERT(item, "Invalid argument.");
+      nyra_msg_arena_own_bufs_(item);
+    }
+  }
+}
+
+/**
+ * @brief Clone the property at @a path out of the message. Unlike
+ * 'nyra_value_clone()' on the value peeked from the message, the bufs of the
+ * clone, at any depth, own their memory even if they have been carved from the
+ * arena of the message, so the clone could outlive the message.
+ *
+ * @return The clone, owned by the caller, NULL if there is no such property.
+ */
+static inline nyra_value_t *nyra_msg_clone_property(nyra_shared_ptr_t *self,
+                                                  const char *path,
+                                                  nyra_error_t *err) {
+  NYRA_ASSERT(self && path, "Invalid argument.");
+
+  nyra_value_t *value = nyra_msg_peek_property(self, path, err);
+  if (!value) {
+    return NULL;
+  }
+
+  nyra_value_t *clone = nyra_value_clone(value);
+  if (clone) {
+    nyra_msg_arena_own_bufs_(clone);
+  }
+  return clone;
+}
+
+/**
+ * @brief Initialize @a buf with a copy of @a data. The copy is carved from the
+ * arena of the message if it has one, otherwise it is allocated from the heap
+ * as usual. Either way, @a buf could be moved into a property of the message,
+ * and must not outlive the message. Neither could a clone of it, or of a value
+ * holding it, made by 'nyra_value_clone()', see 'nyra_msg_clone_property()'.
+ */
+static inline void nyra_msg_init_buf_with_copying_data(nyra_shared_ptr_t *self,
+                                                      nyra_buf_t *buf,
+                                                      const uint8_t *data,
+                                                      size_t size) {
+  NYRA_ASSERT(self && buf && (data || !size), "Invalid argument.");
+
+  nyra_arena_t *arena = nyra_msg_get_arena(self);
+  uint8_t *copy =
+      arena && size ? (uint8_t *)nyra_arena_alloc(arena, size) : NULL;
+  if (copy) {
+    memcpy(copy, data, size);
+
+    // The arena lives as long as the message, so the buf does not need to own
+    // the memory.
+    *buf = NYRA_BUF_STATIC_INIT_WITH_DATA_UNOWNED(copy, size);
+  } else {
+    nyra_buf_init_with_copying_data(buf, (uint8_t *)data, size);
+  }
+}
+
+/**
+ * @brief Set a buf property whose content is a copy of @a data, see
+ * 'nyra_msg_init_buf_with_copying_data()'. The property, or any object or
+ * array holding it, must be cloned out of the message with
+ * 'nyra_msg_clone_property()' if the clone could outlive the message.
+ */
+static inline bool nyra_msg_set_property_buf(nyra_shared_ptr_t *self,
+                                            const char *path,
+                                            const uint8_t *data, size_t size,
+                                            nyra_error_t *err) {
+  NYRA_ASSERT(self && path, "Invalid argument.");
+
+  nyra_buf_t buf;
+  nyra_msg_init_buf_with_copying_data(self, &buf, data, size);
+
+  nyra_value_t *value = nyra_value_create_buf_with_move(buf);
+  if (!nyra_msg_set_property(self, path, value, err)) {
+    nyra_value_destroy(value);
+    return false;
+  }
+
+  return true;
+}
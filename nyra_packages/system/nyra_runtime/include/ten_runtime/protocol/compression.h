@@ -0,0 +1,291 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_runtime/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(_WIN32)
+  #include <Windows.h>
+#else
+  #include <time.h>
+#endif
+
+#include "nyra_utils/lib/buf.h"
+#include "nyra_utils/lib/lz4.h"
+#include "nyra_utils/macro/check.h"
+
+// Optional per-connection compression for the serialized messages flowing
+// through a 'nyra_protocol_t'. An implementation protocol keeps one
+// 'nyra_protocol_compression_t' for each connection, calls
+// 'nyra_protocol_compression_encode()' in its 'on_output()' after the message
+// has been serialized, and 'nyra_protocol_compression_decode()' before the
+// input bytes are deserialized.
+//
+// Every encoded frame starts with a one byte header which indicates the method
+// used for that frame, so a link could mix compressed and uncompressed frames,
+// and messages smaller than the threshold are sent nearly as is.
+//
+//   [ NYRA_PROTOCOL_COMPRESSION_NONE ][ payload ]
+//   [ NYRA_PROTOCOL_COMPRESSION_LZ4 ][ original size (u32, LE) ][ LZ4 block ]
+//
+// The text-heavy traffic between apps (LLM tokens, transcripts, tool JSON)
+// repeats the same property keys and message names constantly, so both ends
+// could share a dictionary built from typical messages, which makes the
+// compression effective even for short messages.
+
+#define NYRA_PROTOCOL_COMPRESSION_DEFAULT_THRESHOLD 256
+
+#define NYRA_PROTOCOL_COMPRESSION_LZ4_HEADER_SIZE 5
+
+// The original size in an LZ4 frame is sent by the peer, so it is not trusted
+// beyond this, and beyond what the block could expand to.
+#define NYRA_PROTOCOL_COMPRESSION_DEFAULT_MAX_DATA_SIZE (64 * 1024 * 1024)
+
+// A byte of an LZ4 block expands to 255 bytes at most.
+#define NYRA_PROTOCOL_COMPRESSION_LZ4_MAX_RATIO 255
+
+typedef enum NYRA_PROTOCOL_COMPRESSION {
+  NYRA_PROTOCOL_COMPRESSION_NONE = 0,
+  NYRA_PROTOCOL_COMPRESSION_LZ4 = 1,
+} NYRA_PROTOCOL_COMPRESSION;
+
+typedef struct nyra_protocol_compression_stats_t {
+  uint64_t encoded_frames;
+  uint64_t compressed_frames;
+
+  // The bytes before and after the compression, only the frames which are
+  // compressed are counted.
+  uint64_t raw_bytes;
+  uint64_t compressed_bytes;
+
+  // The CPU time spent by the calling threads in the LZ4 calls, so that the
+  // time they are preempted is not counted.
+  uint64_t compress_time_us;
+  uint64_t decompress_time_us;
+} nyra_protocol_compression_stats_t;
+
+typedef struct nyra_protocol_compression_t {
+  NYRA_PROTOCOL_COMPRESSION method;
+
+  // The messages whose serialized size is smaller than this will not be
+  // compressed.
+  size_t threshold;
+
+  // The decoded frames larger than this are rejected.
+  size_t max_data_size;
+
+  // The shared dictionary, its bytes are not owned by
+  // 'nyra_protocol_compression_t', and must be identical on both ends of the
+  // connection.
+  nyra_lz4_dict_t dict;
+
+  nyra_protocol_compression_stats_t stats;
+} nyra_protocol_compression_t;
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline int64_t nyra_protocol_compression_cpu_time_us_(void) {
+#if defined(_WIN32)
+  FILETIME creation_time;
+  FILETIME exit_time;
+  FILETIME kernel_time;
+  FILETIME user_time;
+  if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time,
+                      &kernel_time, &user_time)) {
+    return 0;
+  }
+
+  // In units of 100 nanoseconds.
+  uint64_t kernel = ((uint64_t)kernel_time.dwHighDateTime << 32) |
+                    kernel_time.dwLowDateTime;
+  uint64_t user =
+      ((uint64_t)user_time.dwHighDateTime << 32) | user_time.dwLowDateTime;
+  return (int64_t)((kernel + user) / 10);
+#else
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+    return 0;
+  }
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+static inline void nyra_protocol_compression_init(
+    nyra_protocol_compression_t *self, NYRA_PROTOCOL_COMPRESSION method,
+    size_t threshold) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  memset(self, 0, sizeof(nyra_protocol_compression_t));
+  self->method = method;
+  self->threshold = threshold;
+  self->max_data_size = NYRA_PROTOCOL_COMPRESSION_DEFAULT_MAX_DATA_SIZE;
+  nyra_lz4_dict_init(&self->dict, NULL, 0);
+}
+
+static inline void nyra_protocol_compression_set_dict(
+    nyra_protocol_compression_t *self, const uint8_t *dict, size_t dict_len) {
+  NYRA_ASSERT(self && (dict || !dict_len), "Invalid argument.");
+
+  nyra_lz4_dict_init(&self->dict, dict, dict_len);
+}
+
+static inline void nyra_protocol_compression_set_max_data_size(
+    nyra_protocol_compression_t *self, size_t max_data_size) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  self->max_data_size = max_data_size;
+}
+
+/**
+ * @brief Encode the serialized message @a data into a frame. @a frame will be
+ * initialized by this function, and the caller needs to deinit it.
+ */
+static inline bool nyra_protocol_compression_encode(
+    nyra_protocol_compression_t *self, const uint8_t *data, size_t data_len,
+    nyra_buf_t *frame) {
+  NYRA_ASSERT(self && (data || !data_len) && frame, "Invalid argument.");
+
+  self->stats.encoded_frames++;
+
+  if (self->method == NYRA_PROTOCOL_COMPRESSION_LZ4 &&
+      data_len >= self->threshold && data_len <= UINT32_MAX) {
+    size_t cap = NYRA_PROTOCOL_COMPRESSION_LZ4_HEADER_SIZE +
+                 nyra_lz4_compress_bound(data_len);
+    if (!nyra_buf_init_with_owned_data(frame, cap)) {
+      return false;
+    }
+
+    int64_t begin = nyra_protocol_compression_cpu_time_us_();
+    size_t compressed_len = nyra_lz4_compress_with_dict(
+        data, data_len, frame->data + NYRA_PROTOCOL_COMPRESSION_LZ4_HEADER_SIZE,
+        cap - NYRA_PROTOCOL_COMPRESSION_LZ4_HEADER_SIZE, &self->dict);
+    self->stats.compress_time_us +=
+        nyra_protocol_compression_cpu_time_us_() - begin;
+
+    // Fall back to the uncompressed frame if the compression does not help.
+    if (compressed_len &&
+        compressed_len + NYRA_PROTOCOL_COMPRESSION_LZ4_HEADER_SIZE <
+            data_len + 1) {
+      frame->data[0] = NYRA_PROTOCOL_COMPRESSION_LZ4;
+      frame->data[1] = (uint8_t)(data_len & 0xFF);
+      frame->data[2] = (uint8_t)((data_len >> 8) & 0xFF);
+      frame->data[3] = (uint8_t)((data_len >> 16) & 0xFF);
+      frame->data[4] = (uint8_t)((data_len >> 24) & 0xFF);
+      frame->content_size =
+          NYRA_PROTOCOL_COMPRESSION_LZ4_HEADER_SIZE + compressed_len;
+
+      self->stats.compressed_frames++;
+      self->stats.raw_bytes += data_len;
+      self->stats.compressed_bytes += frame->content_size;
+
+      return true;
+    }
+
+    nyra_buf_deinit(frame);
+  }
+
+  if (!nyra_buf_init_with_owned_data(frame, data_len + 1)) {
+    return false;
+  }
+
+  frame->data[0] = NYRA_PROTOCOL_COMPRESSION_NONE;
+  if (data_len) {
+    memcpy(frame->data + 1, data, data_len);
+  }
+  frame->content_size = data_len + 1;
+
+  return true;
+}
+
+/**
+ * @brief Decode a frame produced by 'nyra_protocol_compression_encode()' into
+ * @a data. @a data will be initialized by this function, and the caller needs
+ * to deinit it.
+ *
+ * @return false if the frame is malformed, or would be decoded into more than
+ * 'max_data_size' bytes.
+ */
+static inline bool nyra_protocol_compression_decode(
+    nyra_protocol_compression_t *self, const uint8_t *frame, size_t frame_len,
+    nyra_buf_t *data) {
+  NYRA_ASSERT(self && frame && data, "Invalid argument.");
+
+  if (frame_len < 1) {
+    return false;
+  }
+
+  switch (frame[0]) {
+    case NYRA_PROTOCOL_COMPRESSION_NONE:
+      return nyra_buf_init_with_copying_data(data, (uint8_t *)frame + 1,
+                                            frame_len - 1);
+
+    case NYRA_PROTOCOL_COMPRESSION_LZ4: {
+      if (frame_len < NYRA_PROTOCOL_COMPRESSION_LZ4_HEADER_SIZE) {
+        return false;
+      }
+
+      size_t data_len = (size_t)frame[1] | ((size_t)frame[2] << 8) |
+                        ((size_t)frame[3] << 16) | ((size_t)frame[4] << 24);
+      size_t block_len = frame_len - NYRA_PROTOCOL_COMPRESSION_LZ4_HEADER_SIZE;
+      if (data_len > self->max_data_size ||
+          (data_len + NYRA_PROTOCOL_COMPRESSION_LZ4_MAX_RATIO - 1) /
+                  NYRA_PROTOCOL_COMPRESSION_LZ4_MAX_RATIO >
+              block_len) {
+        return false;
+      }
+
+      // The encoder never compresses an empty message, and there would be no
+      // buffer to decompress it into.
+      if (!data_len) {
+        return false;
+      }
+
+      if (!nyra_buf_init_with_owned_data(data, data_len)) {
+        return false;
+      }
+
+      int64_t begin = nyra_protocol_compression_cpu_time_us_();
+      size_t decompressed_len = 0;
+      bool rc = nyra_lz4_decompress(
+          frame + NYRA_PROTOCOL_COMPRESSION_LZ4_HEADER_SIZE, block_len,
+          data->data, data_len, self->dict.data, self->dict.len,
+          &decompressed_len);
+      self->stats.decompress_time_us +=
+        nyra_protocol_compression_cpu_time_us_() - begin;
+
+      if (!rc || decompressed_len != data_len) {
+        nyra_buf_deinit(data);
+        return false;
+      }
+
+      data->content_size = data_len;
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief The ratio of the compressed size to the raw size of the compressed
+ * frames, 1.0 if no frame has been compressed yet.
+ */
+static inline double nyra_protocol_compression_get_ratio(
+    nyra_protocol_compression_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  if (!self->stats.raw_bytes) {
+    return 1.0;
+  }
+
+  return (double)self->stats.compressed_bytes / (double)self->stats.raw_bytes;
+}
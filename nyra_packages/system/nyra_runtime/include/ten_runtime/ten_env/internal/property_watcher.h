@@ -0,0 +1,467 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_runtime/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nyra_runtime/nyra_env/internal/metadata.h"
+#include "nyra_utils/container/list.h"
+#include "nyra_utils/container/list_ptr.h"
+#include "nyra_utils/container/list_str.h"
+#include "nyra_utils/io/runloop.h"
+#include "nyra_utils/lib/alloc.h"
+#include "nyra_utils/lib/error.h"
+#include "nyra_utils/lib/signature.h"
+#include "nyra_utils/lib/string.h"
+#include "nyra_utils/macro/check.h"
+#include "nyra_utils/value/value.h"
+
+// Subscriptions to the changes of the properties of a 'nyra_env_t', so that an
+// extension is told when, ex: the voice or the prompt it uses is updated,
+// rather than getting these properties again and again to find out.
+//
+// A subscription is for a subtree of the properties, ex: "tts" for "tts",
+// "tts.voice_id" or "tts.params[0]", and a change of a parent of the subtree,
+// ex: setting the whole "tts" object, is a change of the subtree too. The
+// changes are collected until the tasks already queued on the runloop of the
+// extension have run, then each subscription is called once, on that runloop,
+// with the paths of the changes in its subtree. Setting a property several
+// times in a row thus costs a single call.
+//
+// The changes are the ones made through the watcher, i.e.
+// 'nyra_env_property_watcher_set_property()', its async variant, or a call to
+// 'nyra_env_property_watcher_notify()' after a change made in another way. The
+// watcher belongs to the thread of its 'nyra_env_t', like the 'nyra_env_t'
+// itself.
+
+#define NYRA_ENV_PROPERTY_WATCHER_SIGNATURE 0x7C1B0E94D2A6F35DU
+
+typedef void (*nyra_env_property_changed_func_t)(nyra_env_t *nyra_env,
+                                                const char *const *paths,
+                                                size_t paths_count,
+                                                void *user_data);
+
+typedef struct nyra_env_property_subscription_t {
+  uint64_t id;
+  char *subtree;
+  size_t subtree_len;
+
+  nyra_env_property_changed_func_t on_changed;
+  void *user_data;
+  void (*user_data_destroy)(void *user_data);
+
+  // Unsubscribed while the subscriptions are being called, so it is removed
+  // after they have been.
+  bool removed;
+} nyra_env_property_subscription_t;
+
+typedef struct nyra_env_property_watcher_t {
+  nyra_signature_t signature;
+
+  nyra_env_t *nyra_env;
+  nyra_runloop_t *runloop;
+
+  nyra_list_t subscriptions;  // nyra_env_property_subscription_t*
+  uint64_t last_id;
+
+  nyra_list_t changed_paths;  // Since the last flush, without duplicates.
+  bool flush_posted;
+  bool flushing;
+
+  // Held by the owner, a posted flush and the pending async sets, as the
+  // owner could destroy the watcher before they come back.
+  size_t refs;
+  bool destroyed;
+} nyra_env_property_watcher_t;
+
+static inline bool nyra_env_property_watcher_check_integrity(
+    nyra_env_property_watcher_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  return nyra_signature_get(&self->signature) ==
+         NYRA_ENV_PROPERTY_WATCHER_SIGNATURE;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_env_property_subscription_destroy_(
+    nyra_env_property_subscription_t *self) {
+  if (self->user_data_destroy) {
+    self->user_data_destroy(self->user_data);
+  }
+  NYRA_FREE_(self->subtree);
+  NYRA_FREE_(self);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_env_property_watcher_release_(
+    nyra_env_property_watcher_t *self) {
+  NYRA_ASSERT(self->refs, "Should not happen.");
+
+  if (--self->refs) {
+    return;
+  }
+
+  nyra_list_clear(&self->subscriptions);
+  nyra_list_clear(&self->changed_paths);
+  nyra_signature_set(&self->signature, 0);
+  NYRA_FREE_(self);
+}
+
+/**
+ * @brief Whether a change of @a path is a change of the subtree at @a subtree,
+ * i.e. one of them is the other or a descendant of it.
+ */
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_env_property_watcher_is_related_(const char *subtree,
+                                                        size_t subtree_len,
+                                                        const char *path,
+                                                        size_t path_len) {
+  if (!subtree_len) {
+    return true;
+  }
+
+  size_t common = subtree_len < path_len ? subtree_len : path_len;
+  if (memcmp(subtree, path, common) != 0) {
+    return false;
+  }
+  if (subtree_len == path_len) {
+    return true;
+  }
+
+  char next = subtree_len < path_len ? path[common] : subtree[common];
+  return next == '.' || next == '[';
+}
+
+/**
+ * @brief Call the subscriptions with the changes collected since the last
+ * flush, which is done by a task on the runloop.
+ */
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_env_property_watcher_flush_(
+    nyra_env_property_watcher_t *self) {
+  // The changes made by the subscriptions are for the next flush.
+  nyra_list_t changed_paths;
+  nyra_list_init(&changed_paths);
+  nyra_list_swap(&changed_paths, &self->changed_paths);
+
+  size_t changed_count = nyra_list_size(&changed_paths);
+  if (!changed_count || self->destroyed) {
+    nyra_list_clear(&changed_paths);
+    return;
+  }
+
+  const char **paths =
+      (const char **)NYRA_MALLOC(changed_count * sizeof(const char *));
+  const char **related =
+      (const char **)NYRA_MALLOC(changed_count * sizeof(const char *));
+  size_t *path_lens = (size_t *)NYRA_MALLOC(changed_count * sizeof(size_t));
+  NYRA_ASSERT(paths && related && path_lens, "Failed to allocate memory.");
+
+  size_t i = 0;
+  nyra_list_foreach (&changed_paths, iter) {
+    nyra_string_t *path = nyra_str_listnode_get(iter.node);
+    path_lens[i] = nyra_string_len(path);
+    paths[i++] = nyra_string_get_raw_str(path);
+  }
+
+  // The ones subscribed while this flush is running only see the later ones.
+  uint64_t last_id = self->last_id;
+
+  self->refs++;
+  self->flushing = true;
+
+  nyra_list_foreach (&self->subscriptions, iter) {
+    nyra_env_property_subscription_t *subscription =
+        (nyra_env_property_subscription_t *)nyra_ptr_listnode_get(iter.node);
+    if (subscription->removed || subscription->id > last_id) {
+      continue;
+    }
+
+    size_t related_count = 0;
+    for (i = 0; i < changed_count; ++i) {
+      if (nyra_env_property_watcher_is_related_(subscription->subtree,
+                                               subscription->subtree_len,
+                                               paths[i], path_lens[i])) {
+        related[related_count++] = paths[i];
+      }
+    }
+
+    if (related_count) {
+      subscription->on_changed(self->nyra_env, related, related_count,
+                               subscription->user_data);
+    }
+
+    if (self->destroyed) {
+      break;
+    }
+  }
+
+  self->flushing = false;
+
+  nyra_list_foreach (&self->subscriptions, iter) {
+    nyra_env_property_subscription_t *subscription =
+        (nyra_env_property_subscription_t *)nyra_ptr_listnode_get(iter.node);
+    if (subscription->removed) {
+      nyra_list_remove_node(&self->subscriptions, iter.node);
+    }
+  }
+
+  NYRA_FREE_(paths);
+  NYRA_FREE_(related);
+  NYRA_FREE_(path_lens);
+  nyra_list_clear(&changed_paths);
+
+  nyra_env_property_watcher_release_(self);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_env_property_watcher_flush_task_(void *from,
+                                                        void *arg) {
+  (void)from;
+
+  nyra_env_property_watcher_t *self = (nyra_env_property_watcher_t *)arg;
+  self->flush_posted = false;
+  nyra_env_property_watcher_flush_(self);
+  nyra_env_property_watcher_release_(self);
+}
+
+/**
+ * @brief Create the watcher of the properties of @a nyra_env, which calls its
+ * subscriptions on the runloop of the current thread, i.e. the one of
+ * @a nyra_env.
+ */
+static inline nyra_env_property_watcher_t *nyra_env_property_watcher_create(
+    nyra_env_t *nyra_env) {
+  NYRA_ASSERT(nyra_env, "Invalid argument.");
+
+  nyra_env_property_watcher_t *self =
+      (nyra_env_property_watcher_t *)NYRA_MALLOC(
+          sizeof(nyra_env_property_watcher_t));
+  NYRA_ASSERT(self, "Failed to allocate memory.");
+
+  nyra_signature_set(&self->signature, NYRA_ENV_PROPERTY_WATCHER_SIGNATURE);
+  self->nyra_env = nyra_env;
+  self->runloop = nyra_runloop_current();
+  nyra_list_init(&self->subscriptions);
+  self->last_id = 0;
+  nyra_list_init(&self->changed_paths);
+  self->flush_posted = false;
+  self->flushing = false;
+  self->refs = 1;
+  self->destroyed = false;
+
+  return self;
+}
+
+/**
+ * @brief Destroy the watcher and its subscriptions. A change which has not
+ * been flushed yet is dropped.
+ */
+static inline void nyra_env_property_watcher_destroy(
+    nyra_env_property_watcher_t *self) {
+  NYRA_ASSERT(self && nyra_env_property_watcher_check_integrity(self),
+             "Invalid argument.");
+  NYRA_ASSERT(!self->destroyed, "Should not happen.");
+
+  self->destroyed = true;
+  if (!self->flushing) {
+    nyra_list_clear(&self->subscriptions);
+  }
+  nyra_env_property_watcher_release_(self);
+}
+
+/**
+ * @brief Call @a on_changed with the paths of the changes of the subtree at
+ * @a subtree, "" for all the properties.
+ *
+ * @param user_data_destroy Called with @a user_data when the subscription is
+ * removed, could be NULL.
+ *
+ * @return The id of the subscription, for
+ * 'nyra_env_property_watcher_unsubscribe()'.
+ */
+static inline uint64_t nyra_env_property_watcher_subscribe(
+    nyra_env_property_watcher_t *self, const char *subtree,
+    nyra_env_property_changed_func_t on_changed, void *user_data,
+    void (*user_data_destroy)(void *user_data)) {
+  NYRA_ASSERT(self && nyra_env_property_watcher_check_integrity(self) &&
+                 subtree && on_changed,
+             "Invalid argument.");
+
+  nyra_env_property_subscription_t *subscription =
+      (nyra_env_property_subscription_t *)NYRA_MALLOC(
+          sizeof(nyra_env_property_subscription_t));
+  NYRA_ASSERT(subscription, "Failed to allocate memory.");
+
+  subscription->id = ++self->last_id;
+  subscription->subtree_len = strlen(subtree);
+  subscription->subtree = (char *)NYRA_MALLOC(subscription->subtree_len + 1);
+  NYRA_ASSERT(subscription->subtree, "Failed to allocate memory.");
+  memcpy(subscription->subtree, subtree, subscription->subtree_len + 1);
+  subscription->on_changed = on_changed;
+  subscription->user_data = user_data;
+  subscription->user_data_destroy = user_data_destroy;
+  subscription->removed = false;
+
+  nyra_list_push_ptr_back(&self->subscriptions, subscription,
+                         (nyra_ptr_listnode_destroy_func_t)
+                             nyra_env_property_subscription_destroy_);
+
+  return subscription->id;
+}
+
+/**
+ * @return false if there is no subscription @a id.
+ */
+static inline bool nyra_env_property_watcher_unsubscribe(
+    nyra_env_property_watcher_t *self, uint64_t id) {
+  NYRA_ASSERT(self && nyra_env_property_watcher_check_integrity(self),
+             "Invalid argument.");
+
+  nyra_list_foreach (&self->subscriptions, iter) {
+    nyra_env_property_subscription_t *subscription =
+        (nyra_env_property_subscription_t *)nyra_ptr_listnode_get(iter.node);
+    if (subscription->id != id || subscription->removed) {
+      continue;
+    }
+
+    if (self->flushing) {
+      subscription->removed = true;
+    } else {
+      nyra_list_remove_node(&self->subscriptions, iter.node);
+    }
+    return true;
+  }
+
+  return false;
+}
+
+/**
+ * @brief Record that the property at @a path has changed. The subscriptions
+ * are called on the runloop, once for all the changes recorded before.
+ */
+static inline void nyra_env_property_watcher_notify(
+    nyra_env_property_watcher_t *self, const char *path) {
+  NYRA_ASSERT(self && nyra_env_property_watcher_check_integrity(self) && path,
+             "Invalid argument.");
+
+  if (self->destroyed || nyra_list_is_empty(&self->subscriptions)) {
+    return;
+  }
+
+  if (!nyra_list_find_string(&self->changed_paths, path)) {
+    nyra_list_push_str_back(&self->changed_paths, path);
+  }
+
+  if (self->flush_posted) {
+    return;
+  }
+
+  if (self->runloop) {
+    self->refs++;
+    self->flush_posted = true;
+    if (nyra_runloop_post_task_tail(self->runloop,
+                                   nyra_env_property_watcher_flush_task_, self,
+                                   self) == 0) {
+      return;
+    }
+    self->flush_posted = false;
+    self->refs--;
+  }
+
+  // Not created on a runloop.
+  nyra_env_property_watcher_flush_(self);
+}
+
+/**
+ * @brief 'nyra_env_set_property()', then notify the change.
+ *
+ * @note The ownership of @a value is transferred, as for
+ * 'nyra_env_set_property()'.
+ */
+static inline bool nyra_env_property_watcher_set_property(
+    nyra_env_property_watcher_t *self, const char *path, nyra_value_t *value,
+    nyra_error_t *err) {
+  NYRA_ASSERT(self && nyra_env_property_watcher_check_integrity(self),
+             "Invalid argument.");
+
+  if (!nyra_env_set_property(self->nyra_env, path, value, err)) {
+    return false;
+  }
+
+  nyra_env_property_watcher_notify(self, path);
+  return true;
+}
+
+typedef struct nyra_env_property_watcher_set_ctx_t {
+  nyra_env_property_watcher_t *watcher;
+  char *path;
+  nyra_env_set_property_async_cb_t cb;
+  void *cb_data;
+} nyra_env_property_watcher_set_ctx_t;
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_env_property_watcher_on_set_done_(nyra_env_t *nyra_env,
+                                                         bool res,
+                                                         void *cb_data,
+                                                         nyra_error_t *err) {
+  nyra_env_property_watcher_set_ctx_t *ctx =
+      (nyra_env_property_watcher_set_ctx_t *)cb_data;
+
+  if (ctx->cb) {
+    ctx->cb(nyra_env, res, ctx->cb_data, err);
+  }
+
+  if (res && !ctx->watcher->destroyed) {
+    nyra_env_property_watcher_notify(ctx->watcher, ctx->path);
+  }
+
+  nyra_env_property_watcher_release_(ctx->watcher);
+  NYRA_FREE_(ctx->path);
+  NYRA_FREE_(ctx);
+}
+
+/**
+ * @brief 'nyra_env_set_property_async()', then notify the change once it is
+ * done, after @a cb has been called.
+ */
+static inline bool nyra_env_property_watcher_set_property_async(
+    nyra_env_property_watcher_t *self, const char *path, nyra_value_t *value,
+    nyra_env_set_property_async_cb_t cb, void *cb_data, nyra_error_t *err) {
+  NYRA_ASSERT(self && nyra_env_property_watcher_check_integrity(self) && path,
+             "Invalid argument.");
+
+  nyra_env_property_watcher_set_ctx_t *ctx =
+      (nyra_env_property_watcher_set_ctx_t *)NYRA_MALLOC(
+          sizeof(nyra_env_property_watcher_set_ctx_t));
+  NYRA_ASSERT(ctx, "Failed to allocate memory.");
+
+  size_t path_len = strlen(path);
+  ctx->path = (char *)NYRA_MALLOC(path_len + 1);
+  NYRA_ASSERT(ctx->path, "Failed to allocate memory.");
+  memcpy(ctx->path, path, path_len + 1);
+  ctx->watcher = self;
+  ctx->cb = cb;
+  ctx->cb_data = cb_data;
+
+  self->refs++;
+
+  if (!nyra_env_set_property_async(self->nyra_env, path, value,
+                                  nyra_env_property_watcher_on_set_done_, ctx,
+                                  err)) {
+    self->refs--;
+    NYRA_FREE_(ctx->path);
+    NYRA_FREE_(ctx);
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,647 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define NYRA_FLAT_HASHTABLE_USE_SSE2
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+  #include <intrin.h>
+#endif
+
+#include "nyra_utils/lib/alloc.h"
+#include "nyra_utils/lib/hash.h"
+#include "nyra_utils/macro/check.h"
+
+// An open addressing hash table in the style of the Swiss tables, for the maps
+// which do not need the insertion order kept by 'nyra_hashtable_t'.
+//
+// The entries are stored in one flat array, next to an array of one control
+// byte per entry, which holds 7 bits of the hash of a full entry, or marks an
+// empty or deleted one. A lookup compares the control bytes of a whole group of
+// entries at once (16 with SSE2, 8 with a portable SWAR otherwise), and only
+// touches the entries whose 7 bits match, so most lookups read one cache line
+// of control bytes and one entry, without chasing any pointer.
+//
+// Unlike 'nyra_hashtable_t', the table is not intrusive, an entry is a key and
+// a 'void *' value. The byte and string keys are not copied, they must outlive
+// their entries, as the keys of 'nyra_hashtable_t'. The integer and pointer
+// keys are stored in the entries.
+//
+// The entries move when the table grows, so do not keep a pointer to an entry
+// across an insertion. The lookups return NULL for a missing key, so the NULL
+// values could not be told from the missing ones.
+
+#define NYRA_FLAT_HASHTABLE_CTRL_EMPTY ((uint8_t)0x80)
+#define NYRA_FLAT_HASHTABLE_CTRL_DELETED ((uint8_t)0xFE)
+
+#define NYRA_FLAT_HASHTABLE_MIN_CAPACITY 16
+
+#if defined(NYRA_FLAT_HASHTABLE_USE_SSE2)
+  #define NYRA_FLAT_HASHTABLE_GROUP_WIDTH 16
+  // One bit per control byte.
+  #define NYRA_FLAT_HASHTABLE_GROUP_SHIFT 0
+#else
+  #define NYRA_FLAT_HASHTABLE_GROUP_WIDTH 8
+  // The high bit of each control byte.
+  #define NYRA_FLAT_HASHTABLE_GROUP_SHIFT 3
+#endif
+
+typedef enum NYRA_FLAT_HASHTABLE_KEY_TYPE {
+  // The keys are the bytes pointed to by 'key.ptr', ex: strings.
+  NYRA_FLAT_HASHTABLE_KEY_TYPE_BYTES,
+
+  // The keys are the integers in 'key.u64', ex: ids or pointers.
+  NYRA_FLAT_HASHTABLE_KEY_TYPE_U64,
+} NYRA_FLAT_HASHTABLE_KEY_TYPE;
+
+typedef struct nyra_flat_hashtable_entry_t {
+  uint32_t hash;
+  uint32_t keylen;
+
+  union {
+    const void *ptr;
+    uint64_t u64;
+  } key;
+
+  void *value;
+} nyra_flat_hashtable_entry_t;
+
+typedef struct nyra_flat_hashtable_t {
+  NYRA_FLAT_HASHTABLE_KEY_TYPE key_type;
+
+  // The per-process seed of 'nyra_hash_*()', fetched once.
+  uint64_t seed;
+
+  // 'capacity + NYRA_FLAT_HASHTABLE_GROUP_WIDTH' bytes, the last group is a
+  // copy of the first one, so that a group could be loaded from any position.
+  uint8_t *ctrl;
+  nyra_flat_hashtable_entry_t *entries;
+
+  // 0 or a power of 2, not less than 'NYRA_FLAT_HASHTABLE_MIN_CAPACITY'.
+  size_t capacity;
+  size_t size;
+
+  // The number of empty entries which could still be filled before the table
+  // has to grow, to keep the load factor under 7/8.
+  size_t growth_left;
+
+  // Called on the values which are still in the table when it is cleared.
+  void (*value_destroy)(void *value);
+} nyra_flat_hashtable_t;
+
+typedef struct nyra_flat_hashtable_iterator_t {
+  nyra_flat_hashtable_t *table;
+  nyra_flat_hashtable_entry_t *entry;
+  size_t index;
+} nyra_flat_hashtable_iterator_t;
+
+#define nyra_flat_hashtable_foreach(table, iter)                    \
+  for (nyra_flat_hashtable_iterator_t iter =                        \
+           nyra_flat_hashtable_iterator_begin_((table));            \
+       (iter).entry; nyra_flat_hashtable_iterator_next_(&(iter)))
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint32_t nyra_flat_hashtable_ctz_(uint64_t x) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index = 0;
+  _BitScanForward64(&index, x);
+  return (uint32_t)index;
+#else
+  return (uint32_t)__builtin_ctzll(x);
+#endif
+}
+
+#if defined(NYRA_FLAT_HASHTABLE_USE_SSE2)
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint64_t nyra_flat_hashtable_group_match_(const uint8_t *ctrl,
+                                                       uint8_t h2) {
+  __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+  return (uint32_t)_mm_movemask_epi8(
+      _mm_cmpeq_epi8(group, _mm_set1_epi8((char)h2)));
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint64_t nyra_flat_hashtable_group_match_empty_(
+    const uint8_t *ctrl) {
+  return nyra_flat_hashtable_group_match_(ctrl, NYRA_FLAT_HASHTABLE_CTRL_EMPTY);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint64_t nyra_flat_hashtable_group_match_empty_or_deleted_(
+    const uint8_t *ctrl) {
+  // Only the empty and deleted control bytes have the high bit set.
+  __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+  return (uint32_t)_mm_movemask_epi8(group);
+}
+
+#else
+
+#define NYRA_FLAT_HASHTABLE_LSBS 0x0101010101010101ULL
+#define NYRA_FLAT_HASHTABLE_MSBS 0x8080808080808080ULL
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint64_t nyra_flat_hashtable_group_load_(const uint8_t *ctrl) {
+  uint64_t group = 0;
+  memcpy(&group, ctrl, sizeof(group));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  group = __builtin_bswap64(group);
+#endif
+  return group;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint64_t nyra_flat_hashtable_group_match_(const uint8_t *ctrl,
+                                                       uint8_t h2) {
+  // Could have false positives right after a real match, which are filtered
+  // out by the key comparison.
+  uint64_t x = nyra_flat_hashtable_group_load_(ctrl) ^
+               (NYRA_FLAT_HASHTABLE_LSBS * h2);
+  return (x - NYRA_FLAT_HASHTABLE_LSBS) & ~x & NYRA_FLAT_HASHTABLE_MSBS;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint64_t nyra_flat_hashtable_group_match_empty_(
+    const uint8_t *ctrl) {
+  // 0x80 is the only control byte with the bit 7 set and the bit 1 unset.
+  uint64_t group = nyra_flat_hashtable_group_load_(ctrl);
+  return group & ~(group << 6) & NYRA_FLAT_HASHTABLE_MSBS;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint64_t nyra_flat_hashtable_group_match_empty_or_deleted_(
+    const uint8_t *ctrl) {
+  return nyra_flat_hashtable_group_load_(ctrl) & NYRA_FLAT_HASHTABLE_MSBS;
+}
+
+#endif
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint32_t nyra_flat_hashtable_hash_u64_(
+    nyra_flat_hashtable_t *self, uint64_t key) {
+  return (uint32_t)nyra_hash_u64_with_seed(key, self->seed);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint32_t nyra_flat_hashtable_hash_bytes_(
+    nyra_flat_hashtable_t *self, const void *key, uint32_t keylen) {
+  return (uint32_t)nyra_hash_bytes_with_seed(key, keylen, self->seed);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_flat_hashtable_set_ctrl_(nyra_flat_hashtable_t *self,
+                                                size_t index, uint8_t ctrl) {
+  self->ctrl[index] = ctrl;
+  if (index < NYRA_FLAT_HASHTABLE_GROUP_WIDTH) {
+    self->ctrl[self->capacity + index] = ctrl;
+  }
+}
+
+static inline void nyra_flat_hashtable_init(
+    nyra_flat_hashtable_t *self, NYRA_FLAT_HASHTABLE_KEY_TYPE key_type,
+    void (*value_destroy)(void *)) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  memset(self, 0, sizeof(nyra_flat_hashtable_t));
+  self->key_type = key_type;
+  self->seed = nyra_hash_get_default_seed();
+  self->value_destroy = value_destroy;
+}
+
+/**
+ * @brief Destroy the values left in the table, and keep its memory for the
+ * coming entries.
+ */
+static inline void nyra_flat_hashtable_clear(nyra_flat_hashtable_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  if (!self->capacity) {
+    return;
+  }
+
+  if (self->value_destroy) {
+    for (size_t i = 0; i < self->capacity; ++i) {
+      if (!(self->ctrl[i] & 0x80)) {
+        self->value_destroy(self->entries[i].value);
+      }
+    }
+  }
+
+  memset(self->ctrl, NYRA_FLAT_HASHTABLE_CTRL_EMPTY,
+         self->capacity + NYRA_FLAT_HASHTABLE_GROUP_WIDTH);
+  self->size = 0;
+  self->growth_left = self->capacity - self->capacity / 8;
+}
+
+static inline void nyra_flat_hashtable_deinit(nyra_flat_hashtable_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  nyra_flat_hashtable_clear(self);
+
+  // The entries are the start of the allocation.
+  NYRA_FREE_(self->entries);
+  self->ctrl = NULL;
+  self->entries = NULL;
+  self->capacity = 0;
+  self->growth_left = 0;
+}
+
+static inline nyra_flat_hashtable_t *nyra_flat_hashtable_create(
+    NYRA_FLAT_HASHTABLE_KEY_TYPE key_type, void (*value_destroy)(void *)) {
+  nyra_flat_hashtable_t *self =
+      (nyra_flat_hashtable_t *)NYRA_MALLOC(sizeof(nyra_flat_hashtable_t));
+  NYRA_ASSERT(self, "Failed to allocate memory.");
+
+  nyra_flat_hashtable_init(self, key_type, value_destroy);
+  return self;
+}
+
+static inline void nyra_flat_hashtable_destroy(nyra_flat_hashtable_t *self) {
+  nyra_flat_hashtable_deinit(self);
+  NYRA_FREE_(self);
+}
+
+static inline size_t nyra_flat_hashtable_size(nyra_flat_hashtable_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  return self->size;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_flat_hashtable_key_equal_(
+    nyra_flat_hashtable_t *self, nyra_flat_hashtable_entry_t *entry,
+    uint32_t hash, const void *key, uint32_t keylen, uint64_t u64) {
+  if (entry->hash != hash) {
+    return false;
+  }
+
+  if (self->key_type == NYRA_FLAT_HASHTABLE_KEY_TYPE_U64) {
+    return entry->key.u64 == u64;
+  }
+
+  return entry->keylen == keylen && memcmp(entry->key.ptr, key, keylen) == 0;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_flat_hashtable_entry_t *nyra_flat_hashtable_find_(
+    nyra_flat_hashtable_t *self, uint32_t hash, const void *key,
+    uint32_t keylen, uint64_t u64) {
+  if (!self->size) {
+    return NULL;
+  }
+
+  size_t mask = self->capacity - 1;
+  size_t pos = (hash >> 7) & mask;
+  uint8_t h2 = hash & 0x7F;
+
+  for (size_t step = NYRA_FLAT_HASHTABLE_GROUP_WIDTH;;
+       pos = (pos + step) & mask, step += NYRA_FLAT_HASHTABLE_GROUP_WIDTH) {
+    const uint8_t *group = self->ctrl + pos;
+
+    for (uint64_t match = nyra_flat_hashtable_group_match_(group, h2); match;
+         match &= match - 1) {
+      size_t index = (pos + (nyra_flat_hashtable_ctz_(match) >>
+                             NYRA_FLAT_HASHTABLE_GROUP_SHIFT)) &
+                     mask;
+      nyra_flat_hashtable_entry_t *entry = &self->entries[index];
+      if (nyra_flat_hashtable_key_equal_(self, entry, hash, key, keylen,
+                                         u64)) {
+        return entry;
+      }
+    }
+
+    if (nyra_flat_hashtable_group_match_empty_(group)) {
+      return NULL;
+    }
+  }
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline size_t nyra_flat_hashtable_find_free_(
+    nyra_flat_hashtable_t *self, uint32_t hash) {
+  size_t mask = self->capacity - 1;
+  size_t pos = (hash >> 7) & mask;
+
+  for (size_t step = NYRA_FLAT_HASHTABLE_GROUP_WIDTH;;
+       pos = (pos + step) & mask, step += NYRA_FLAT_HASHTABLE_GROUP_WIDTH) {
+    uint64_t match =
+        nyra_flat_hashtable_group_match_empty_or_deleted_(self->ctrl + pos);
+    if (match) {
+      return (pos + (nyra_flat_hashtable_ctz_(match) >>
+                     NYRA_FLAT_HASHTABLE_GROUP_SHIFT)) &
+             mask;
+    }
+  }
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_flat_hashtable_resize_(nyra_flat_hashtable_t *self,
+                                              size_t capacity) {
+  NYRA_ASSERT(capacity >= NYRA_FLAT_HASHTABLE_MIN_CAPACITY &&
+                 (capacity & (capacity - 1)) == 0,
+             "Invalid argument.");
+
+  uint8_t *old_ctrl = self->ctrl;
+  nyra_flat_hashtable_entry_t *old_entries = self->entries;
+  size_t old_capacity = self->capacity;
+
+  // The control bytes and the entries share one allocation, the entries come
+  // first to keep them aligned.
+  size_t ctrl_size = capacity + NYRA_FLAT_HASHTABLE_GROUP_WIDTH;
+  uint8_t *mem = (uint8_t *)NYRA_MALLOC(
+      capacity * sizeof(nyra_flat_hashtable_entry_t) + ctrl_size);
+  NYRA_ASSERT(mem, "Failed to allocate memory.");
+
+  self->entries = (nyra_flat_hashtable_entry_t *)mem;
+  self->ctrl = mem + capacity * sizeof(nyra_flat_hashtable_entry_t);
+  self->capacity = capacity;
+  memset(self->ctrl, NYRA_FLAT_HASHTABLE_CTRL_EMPTY, ctrl_size);
+
+  // The tombstones are dropped on the way.
+  for (size_t i = 0; i < old_capacity; ++i) {
+    if (!(old_ctrl[i] & 0x80)) {
+      nyra_flat_hashtable_entry_t *entry = &old_entries[i];
+      size_t index = nyra_flat_hashtable_find_free_(self, entry->hash);
+
+      nyra_flat_hashtable_set_ctrl_(self, index, entry->hash & 0x7F);
+      self->entries[index] = *entry;
+    }
+  }
+
+  self->growth_left = capacity - capacity / 8 - self->size;
+
+  // 'old_entries' is the start of the old allocation.
+  NYRA_FREE_(old_entries);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void *nyra_flat_hashtable_set_(nyra_flat_hashtable_t *self,
+                                            uint32_t hash, const void *key,
+                                            uint32_t keylen, uint64_t u64,
+                                            void *value) {
+  nyra_flat_hashtable_entry_t *entry =
+      nyra_flat_hashtable_find_(self, hash, key, keylen, u64);
+  if (entry) {
+    // The new key replaces the old one, which might die with the old value.
+    if (self->key_type == NYRA_FLAT_HASHTABLE_KEY_TYPE_BYTES) {
+      entry->key.ptr = key;
+    }
+
+    void *old_value = entry->value;
+    entry->value = value;
+    return old_value;
+  }
+
+  if (!self->capacity) {
+    nyra_flat_hashtable_resize_(self, NYRA_FLAT_HASHTABLE_MIN_CAPACITY);
+  }
+
+  size_t index = nyra_flat_hashtable_find_free_(self, hash);
+  if (!self->growth_left &&
+      self->ctrl[index] == NYRA_FLAT_HASHTABLE_CTRL_EMPTY) {
+    // Grow if the table is really full, otherwise it is full of tombstones,
+    // and a rehash in place is enough.
+    size_t capacity = self->size > self->capacity / 2 ? self->capacity * 2
+                                                      : self->capacity;
+    nyra_flat_hashtable_resize_(self, capacity);
+    index = nyra_flat_hashtable_find_free_(self, hash);
+  }
+
+  if (self->ctrl[index] == NYRA_FLAT_HASHTABLE_CTRL_EMPTY) {
+    self->growth_left--;
+  }
+  nyra_flat_hashtable_set_ctrl_(self, index, hash & 0x7F);
+  self->size++;
+
+  entry = &self->entries[index];
+  entry->hash = hash;
+  entry->keylen = keylen;
+  if (self->key_type == NYRA_FLAT_HASHTABLE_KEY_TYPE_U64) {
+    entry->key.u64 = u64;
+  } else {
+    entry->key.ptr = key;
+  }
+  entry->value = value;
+
+  return NULL;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void *nyra_flat_hashtable_del_(nyra_flat_hashtable_t *self,
+                                            uint32_t hash, const void *key,
+                                            uint32_t keylen, uint64_t u64) {
+  nyra_flat_hashtable_entry_t *entry =
+      nyra_flat_hashtable_find_(self, hash, key, keylen, u64);
+  if (!entry) {
+    return NULL;
+  }
+
+  size_t index = (size_t)(entry - self->entries);
+
+  // The entry could be marked as empty only if no probe sequence has ever
+  // passed it while it was full, which is the case if there is an empty entry
+  // in every group containing it.
+  size_t mask = self->capacity - 1;
+  size_t before = (index - NYRA_FLAT_HASHTABLE_GROUP_WIDTH) & mask;
+  uint64_t empty_after =
+      nyra_flat_hashtable_group_match_empty_(self->ctrl + index);
+  uint64_t empty_before =
+      nyra_flat_hashtable_group_match_empty_(self->ctrl + before);
+
+  bool was_never_full = false;
+  if (empty_after && empty_before) {
+    // The distance to the nearest empty entry after, and the one before.
+    size_t after_cnt = nyra_flat_hashtable_ctz_(empty_after) >>
+                       NYRA_FLAT_HASHTABLE_GROUP_SHIFT;
+    size_t before_cnt = 0;
+    for (size_t i = NYRA_FLAT_HASHTABLE_GROUP_WIDTH; i > 0; --i) {
+      if (self->ctrl[(before + i - 1) & mask] ==
+          NYRA_FLAT_HASHTABLE_CTRL_EMPTY) {
+        break;
+      }
+      before_cnt++;
+    }
+    was_never_full =
+        after_cnt + before_cnt < NYRA_FLAT_HASHTABLE_GROUP_WIDTH;
+  }
+
+  void *value = entry->value;
+
+  if (was_never_full) {
+    nyra_flat_hashtable_set_ctrl_(self, index, NYRA_FLAT_HASHTABLE_CTRL_EMPTY);
+    self->growth_left++;
+  } else {
+    nyra_flat_hashtable_set_ctrl_(self, index,
+                                  NYRA_FLAT_HASHTABLE_CTRL_DELETED);
+  }
+  self->size--;
+
+  return value;
+}
+
+/**
+ * @brief Make the table able to hold @a size entries without growing.
+ */
+static inline void nyra_flat_hashtable_reserve(nyra_flat_hashtable_t *self,
+                                              size_t size) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  size_t capacity = NYRA_FLAT_HASHTABLE_MIN_CAPACITY;
+  while (capacity - capacity / 8 < size) {
+    capacity *= 2;
+  }
+
+  if (capacity > self->capacity) {
+    nyra_flat_hashtable_resize_(self, capacity);
+  }
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_flat_hashtable_iterator_next_(
+    nyra_flat_hashtable_iterator_t *self) {
+  nyra_flat_hashtable_t *table = self->table;
+
+  for (size_t i = self->index; i < table->capacity; ++i) {
+    if (!(table->ctrl[i] & 0x80)) {
+      self->entry = &table->entries[i];
+      self->index = i + 1;
+      return;
+    }
+  }
+
+  self->entry = NULL;
+  self->index = table->capacity;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_flat_hashtable_iterator_t
+nyra_flat_hashtable_iterator_begin_(nyra_flat_hashtable_t *table) {
+  NYRA_ASSERT(table, "Invalid argument.");
+
+  nyra_flat_hashtable_iterator_t iter = {table, NULL, 0};
+  nyra_flat_hashtable_iterator_next_(&iter);
+  return iter;
+}
+
+/**
+ * @brief Map the @a keylen bytes of @a key to @a value. The key is not copied,
+ * and replaces the key of the existing entry if there is one, so the old key
+ * could be freed along with the old value.
+ *
+ * @return The value previously mapped to the key, NULL if there was none.
+ */
+static inline void *nyra_flat_hashtable_set_by_key(nyra_flat_hashtable_t *self,
+                                                  const void *key,
+                                                  uint32_t keylen,
+                                                  void *value) {
+  NYRA_ASSERT(self && self->key_type == NYRA_FLAT_HASHTABLE_KEY_TYPE_BYTES &&
+                 (key || !keylen),
+             "Invalid argument.");
+  return nyra_flat_hashtable_set_(
+      self, nyra_flat_hashtable_hash_bytes_(self, key, keylen), key, keylen, 0,
+      value);
+}
+
+static inline void *nyra_flat_hashtable_get_by_key(nyra_flat_hashtable_t *self,
+                                                  const void *key,
+                                                  uint32_t keylen) {
+  NYRA_ASSERT(self && self->key_type == NYRA_FLAT_HASHTABLE_KEY_TYPE_BYTES &&
+                 (key || !keylen),
+             "Invalid argument.");
+  nyra_flat_hashtable_entry_t *entry = nyra_flat_hashtable_find_(
+      self, nyra_flat_hashtable_hash_bytes_(self, key, keylen), key, keylen, 0);
+  return entry ? entry->value : NULL;
+}
+
+/**
+ * @brief Remove the entry of the key.
+ *
+ * @return The value of the removed entry, which is not destroyed, NULL if
+ * there was none.
+ */
+static inline void *nyra_flat_hashtable_del_by_key(nyra_flat_hashtable_t *self,
+                                                  const void *key,
+                                                  uint32_t keylen) {
+  NYRA_ASSERT(self && self->key_type == NYRA_FLAT_HASHTABLE_KEY_TYPE_BYTES &&
+                 (key || !keylen),
+             "Invalid argument.");
+  return nyra_flat_hashtable_del_(
+      self, nyra_flat_hashtable_hash_bytes_(self, key, keylen), key, keylen, 0);
+}
+
+static inline void *nyra_flat_hashtable_set_string(nyra_flat_hashtable_t *self,
+                                                  const char *str,
+                                                  void *value) {
+  NYRA_ASSERT(str, "Invalid argument.");
+  return nyra_flat_hashtable_set_by_key(self, str, (uint32_t)strlen(str),
+                                        value);
+}
+
+static inline void *nyra_flat_hashtable_get_string(nyra_flat_hashtable_t *self,
+                                                  const char *str) {
+  NYRA_ASSERT(str, "Invalid argument.");
+  return nyra_flat_hashtable_get_by_key(self, str, (uint32_t)strlen(str));
+}
+
+static inline void *nyra_flat_hashtable_del_string(nyra_flat_hashtable_t *self,
+                                                  const char *str) {
+  NYRA_ASSERT(str, "Invalid argument.");
+  return nyra_flat_hashtable_del_by_key(self, str, (uint32_t)strlen(str));
+}
+
+static inline void *nyra_flat_hashtable_set_int(nyra_flat_hashtable_t *self,
+                                               int64_t key, void *value) {
+  NYRA_ASSERT(self && self->key_type == NYRA_FLAT_HASHTABLE_KEY_TYPE_U64,
+             "Invalid argument.");
+  return nyra_flat_hashtable_set_(
+      self, nyra_flat_hashtable_hash_u64_(self, (uint64_t)key), NULL, 0,
+      (uint64_t)key, value);
+}
+
+static inline void *nyra_flat_hashtable_get_int(nyra_flat_hashtable_t *self,
+                                               int64_t key) {
+  NYRA_ASSERT(self && self->key_type == NYRA_FLAT_HASHTABLE_KEY_TYPE_U64,
+             "Invalid argument.");
+  nyra_flat_hashtable_entry_t *entry = nyra_flat_hashtable_find_(
+      self, nyra_flat_hashtable_hash_u64_(self, (uint64_t)key), NULL, 0,
+      (uint64_t)key);
+  return entry ? entry->value : NULL;
+}
+
+static inline void *nyra_flat_hashtable_del_int(nyra_flat_hashtable_t *self,
+                                               int64_t key) {
+  NYRA_ASSERT(self && self->key_type == NYRA_FLAT_HASHTABLE_KEY_TYPE_U64,
+             "Invalid argument.");
+  return nyra_flat_hashtable_del_(
+      self, nyra_flat_hashtable_hash_u64_(self, (uint64_t)key), NULL, 0,
+      (uint64_t)key);
+}
+
+static inline void *nyra_flat_hashtable_set_ptr(nyra_flat_hashtable_t *self,
+                                               const void *key, void *value) {
+  return nyra_flat_hashtable_set_int(self, (int64_t)(uintptr_t)key, value);
+}
+
+static inline void *nyra_flat_hashtable_get_ptr(nyra_flat_hashtable_t *self,
+                                               const void *key) {
+  return nyra_flat_hashtable_get_int(self, (int64_t)(uintptr_t)key);
+}
+
+static inline void *nyra_flat_hashtable_del_ptr(nyra_flat_hashtable_t *self,
+                                               const void *key) {
+  return nyra_flat_hashtable_del_int(self, (int64_t)(uintptr_t)key);
+}
@@ -16,6 +16,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "nyra_utils/container/hash_bucket.h"
 #include "nyra_utils/macro/field.h"
 
 #define nyra_hashtable_foreach(table, iter)                                     \
@@ -73,6 +74,27 @@ struct nyra_hashtable_t {
   bool noexpand;
 };
 
+// The longest chains are counted together in the last slot.
+#define NYRA_HASHTABLE_STATS_CHAIN_LEN_CNT 8
+
+typedef struct nyra_hashtable_stats_t {
+  uint32_t bkts_cnt;
+  uint32_t items_cnt;
+
+  uint32_t empty_bkts_cnt;
+  uint32_t max_chain_len;
+
+  // The number of the buckets whose chain has 'i' items, for the 'i' under
+  // 'NYRA_HASHTABLE_STATS_CHAIN_LEN_CNT - 1', and at least that many for the
+  // last one.
+  uint32_t chain_len_histogram[NYRA_HASHTABLE_STATS_CHAIN_LEN_CNT];
+
+  uint32_t ideal_chain_maxlen;
+  uint32_t non_ideal_items_cnt;
+  uint32_t ineff_expands_times;
+  bool noexpand;
+} nyra_hashtable_stats_t;
+
 typedef struct nyra_hashtable_iterator_t {
   nyra_hashhandle_t *prev;
   nyra_hashhandle_t *node;
@@ -206,3 +228,37 @@ static inline nyra_hashhandle_t *nyra_hashtable_find_ptr(nyra_hashtable_t *self,
   assert(self);
   return nyra_hashtable_find_by_key(self, &ptr, sizeof(void *));
 }
+
+/**
+ * @brief Collect the distribution of the items over the buckets, to diagnose a
+ * table whose expansion has been inhibited by 'ineff_expands_times', which
+ * means that its keys are not spread by 'nyra_hash_function()'.
+ */
+static inline void nyra_hashtable_get_stats(nyra_hashtable_t *self,
+                                           nyra_hashtable_stats_t *stats) {
+  assert(self && stats);
+
+  memset(stats, 0, sizeof(nyra_hashtable_stats_t));
+
+  stats->bkts_cnt = self->bkts_cnt;
+  stats->items_cnt = self->items_cnt;
+  stats->ideal_chain_maxlen = self->ideal_chain_maxlen;
+  stats->non_ideal_items_cnt = self->non_ideal_items_cnt;
+  stats->ineff_expands_times = self->ineff_expands_times;
+  stats->noexpand = self->noexpand;
+
+  for (uint32_t i = 0; self->bkts && i < self->bkts_cnt; ++i) {
+    uint32_t len = self->bkts[i].items_cnt;
+
+    if (!len) {
+      stats->empty_bkts_cnt++;
+    }
+    if (len > stats->max_chain_len) {
+      stats->max_chain_len = len;
+    }
+
+    stats->chain_len_histogram[len < NYRA_HASHTABLE_STATS_CHAIN_LEN_CNT - 1
+                                   ? len
+                                   : NYRA_HASHTABLE_STATS_CHAIN_LEN_CNT - 1]++;
+  }
+}
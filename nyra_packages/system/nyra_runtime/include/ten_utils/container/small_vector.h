@@ -0,0 +1,204 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nyra_utils/container/vector.h"
+#include "nyra_utils/macro/check.h"
+
+// A contiguous array of items of the same size, whose first items are stored
+// inside the struct itself. Most of the collections built on the hot paths hold
+// a few items, ex: the destinations of a message or the pending writes of a
+// stream, so they cost no allocation at all, rather than one 'nyra_listnode_t'
+// per item. Once the items do not fit inline anymore, they are moved to a
+// 'nyra_vector_t'.
+//
+// The items move when the vector grows, so it is not a replacement of
+// 'nyra_list_t' where the address of a node must be stable. The struct itself
+// could be moved with 'memcpy()' though, ex: by 'nyra_small_vector_swap()', as
+// it does not point into itself.
+
+// 8 pointers.
+#define NYRA_SMALL_VECTOR_INLINE_SIZE 64
+
+typedef struct nyra_small_vector_t {
+  size_t item_size;
+  size_t size;
+
+  // The items are here as long as 'heap.data' is NULL.
+  union {
+    uint8_t bytes[NYRA_SMALL_VECTOR_INLINE_SIZE];
+    void *ptr;
+    uint64_t u64;
+    double d;
+  } inline_buf;
+
+  nyra_vector_t heap;
+} nyra_small_vector_t;
+
+typedef struct nyra_small_vector_iterator_t {
+  void *item;
+  size_t index;
+} nyra_small_vector_iterator_t;
+
+#define nyra_small_vector_foreach(self, iter)                           \
+  for (nyra_small_vector_iterator_t iter = {NULL, 0};                   \
+       (iter).index < (self)->size &&                                   \
+       ((iter).item = nyra_small_vector_at((self), (iter).index), true); \
+       ++((iter).index))
+
+static inline void nyra_small_vector_init(nyra_small_vector_t *self,
+                                         size_t item_size) {
+  NYRA_ASSERT(self && item_size, "Invalid argument.");
+
+  self->item_size = item_size;
+  self->size = 0;
+  self->heap.data = NULL;
+  self->heap.size = 0;
+  self->heap.capacity = 0;
+}
+
+static inline void nyra_small_vector_deinit(nyra_small_vector_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  if (self->heap.data) {
+    nyra_vector_deinit(&self->heap);
+    self->heap.data = NULL;
+  }
+  self->size = 0;
+}
+
+static inline size_t nyra_small_vector_size(nyra_small_vector_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  return self->size;
+}
+
+static inline bool nyra_small_vector_is_empty(nyra_small_vector_t *self) {
+  return nyra_small_vector_size(self) == 0;
+}
+
+/**
+ * @brief Whether the items have been moved out of the inline storage.
+ */
+static inline bool nyra_small_vector_is_spilled(nyra_small_vector_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  return self->heap.data != NULL;
+}
+
+static inline void *nyra_small_vector_data(nyra_small_vector_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  return self->heap.data ? self->heap.data : self->inline_buf.bytes;
+}
+
+static inline void *nyra_small_vector_at(nyra_small_vector_t *self,
+                                        size_t index) {
+  NYRA_ASSERT(self && index < self->size, "Invalid argument.");
+  return (uint8_t *)nyra_small_vector_data(self) + index * self->item_size;
+}
+
+static inline void *nyra_small_vector_back(nyra_small_vector_t *self) {
+  NYRA_ASSERT(self && self->size, "Invalid argument.");
+  return nyra_small_vector_at(self, self->size - 1);
+}
+
+/**
+ * @brief Append an item, which is a copy of the @a item_size bytes at @a item
+ * if it is not NULL.
+ *
+ * @return The address of the new item, which is valid until the next
+ * insertion.
+ */
+static inline void *nyra_small_vector_push_back(nyra_small_vector_t *self,
+                                               const void *item) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  void *slot = NULL;
+  size_t used = self->size * self->item_size;
+
+  if (self->heap.data) {
+    slot = nyra_vector_grow(&self->heap, self->item_size);
+  } else if (used + self->item_size <= NYRA_SMALL_VECTOR_INLINE_SIZE) {
+    slot = self->inline_buf.bytes + used;
+  } else {
+    // Move the inline items out, with room for as many more.
+    nyra_vector_init(&self->heap, used * 2 + self->item_size);
+    memcpy(nyra_vector_grow(&self->heap, used), self->inline_buf.bytes, used);
+    slot = nyra_vector_grow(&self->heap, self->item_size);
+  }
+
+  NYRA_ASSERT(slot, "Failed to allocate memory.");
+
+  if (item) {
+    memcpy(slot, item, self->item_size);
+  }
+  self->size++;
+
+  return slot;
+}
+
+static inline void nyra_small_vector_pop_back(nyra_small_vector_t *self) {
+  NYRA_ASSERT(self && self->size, "Invalid argument.");
+
+  self->size--;
+  if (self->heap.data) {
+    self->heap.size -= self->item_size;
+  }
+}
+
+/**
+ * @brief Remove the item at @a index, and keep the order of the others.
+ */
+static inline void nyra_small_vector_erase(nyra_small_vector_t *self,
+                                          size_t index) {
+  NYRA_ASSERT(self && index < self->size, "Invalid argument.");
+
+  uint8_t *item = (uint8_t *)nyra_small_vector_at(self, index);
+  memmove(item, item + self->item_size,
+          (self->size - index - 1) * self->item_size);
+
+  nyra_small_vector_pop_back(self);
+}
+
+/**
+ * @brief Remove all the items, and keep the memory for the coming ones.
+ */
+static inline void nyra_small_vector_clear(nyra_small_vector_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  self->size = 0;
+  if (self->heap.data) {
+    self->heap.size = 0;
+  }
+}
+
+static inline void nyra_small_vector_swap(nyra_small_vector_t *self,
+                                         nyra_small_vector_t *other) {
+  NYRA_ASSERT(self && other && self->item_size == other->item_size,
+             "Invalid argument.");
+
+  nyra_small_vector_t tmp = *self;
+  *self = *other;
+  *other = tmp;
+}
+
+static inline void nyra_small_vector_push_ptr_back(nyra_small_vector_t *self,
+                                                  void *ptr) {
+  NYRA_ASSERT(self && self->item_size == sizeof(void *), "Invalid argument.");
+  nyra_small_vector_push_back(self, &ptr);
+}
+
+static inline void *nyra_small_vector_get_ptr(nyra_small_vector_t *self,
+                                             size_t index) {
+  NYRA_ASSERT(self && self->item_size == sizeof(void *), "Invalid argument.");
+  return *(void **)nyra_small_vector_at(self, index);
+}
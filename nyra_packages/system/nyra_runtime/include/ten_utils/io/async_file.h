@@ -0,0 +1,588 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+#include "nyra_utils/io/runloop.h"
+#include "nyra_utils/lib/alloc.h"
+#include "nyra_utils/lib/cond.h"
+#include "nyra_utils/lib/mutex.h"
+#include "nyra_utils/lib/signature.h"
+#include "nyra_utils/lib/thread.h"
+#include "nyra_utils/lib/time.h"
+#include "nyra_utils/macro/check.h"
+
+#define NYRA_ASYNC_FILE_SIGNATURE 0x6B1E0F93D24A7C58U
+
+#define NYRA_ASYNC_FILE_DEFAULT_BUFFER_SIZE (256 * 1024)
+#define NYRA_ASYNC_FILE_DEFAULT_FLUSH_INTERVAL_MS 200
+
+// A file writer which never touches the disk on the calling thread. The
+// callers (an extension thread, an engine thread, the logger) only copy the
+// bytes into the front buffer, and a dedicated I/O thread writes the back
+// buffer into the file. The buffers are swapped when the back one has been
+// written, so a slow disk only delays the I/O thread, and never shows up as
+// audio jitter on the threads which produce the data.
+//
+// The memory is bounded by two buffers of 'buffer_size' bytes. When both of
+// them are full, the appended bytes are either dropped (and counted), or the
+// caller is blocked until the I/O thread catches up, according to
+// 'overflow'.
+//
+// The writer could be closed asynchronously, and the completion is reported
+// on a 'nyra_runloop_t', so an extension or an engine could close a recording
+// without waiting for the disk.
+
+typedef enum NYRA_ASYNC_FILE_SYNC {
+  // Leave it to the OS.
+  NYRA_ASYNC_FILE_SYNC_NONE,
+
+  // fsync() at most once per 'sync_interval_ms'.
+  NYRA_ASYNC_FILE_SYNC_INTERVAL,
+
+  // fsync() after every write of the back buffer.
+  NYRA_ASYNC_FILE_SYNC_ALWAYS,
+} NYRA_ASYNC_FILE_SYNC;
+
+typedef enum NYRA_ASYNC_FILE_OVERFLOW {
+  // Drop the appended bytes, it is the choice of the real-time threads.
+  NYRA_ASYNC_FILE_OVERFLOW_DROP,
+
+  // Block the caller until there is enough space.
+  NYRA_ASYNC_FILE_OVERFLOW_BLOCK,
+} NYRA_ASYNC_FILE_OVERFLOW;
+
+typedef struct nyra_async_file_config_t {
+  // Truncate the file rather than appending to it.
+  bool truncate;
+
+  // The size of each of the two buffers.
+  size_t buffer_size;
+
+  // The I/O thread writes whatever is in the front buffer at least this often,
+  // even if nobody calls 'nyra_async_file_flush()'.
+  int64_t flush_interval_ms;
+
+  NYRA_ASYNC_FILE_SYNC sync;
+  int64_t sync_interval_ms;
+
+  NYRA_ASYNC_FILE_OVERFLOW overflow;
+} nyra_async_file_config_t;
+
+typedef struct nyra_async_file_stats_t {
+  uint64_t appended_bytes;
+  uint64_t written_bytes;
+  uint64_t dropped_bytes;
+  uint64_t write_errors;
+
+  // The errno of the last failed write, 0 if no write has failed.
+  int last_errno;
+} nyra_async_file_stats_t;
+
+typedef struct nyra_async_file_t nyra_async_file_t;
+
+/**
+ * @brief Called on the I/O thread after all the buffered bytes have been
+ * written, and before the file is closed. It is the place to patch a header
+ * whose content depends on the total size, ex: a WAV header.
+ */
+typedef void (*nyra_async_file_finalize_func_t)(int fd, uint64_t written_bytes,
+                                               void *data);
+
+/**
+ * @brief Called on the runloop passed to 'nyra_async_file_close_async()' after
+ * the file has been closed. @a self is still valid in the callback, and will be
+ * destroyed right after it returns.
+ */
+typedef void (*nyra_async_file_on_closed_func_t)(nyra_async_file_t *self,
+                                                void *data);
+
+struct nyra_async_file_t {
+  nyra_signature_t signature;
+
+  int fd;
+  nyra_async_file_config_t config;
+
+  nyra_thread_t *thread;
+  nyra_mutex_t *lock;
+
+  // Signaled when there are bytes to write, or when the writer is closing.
+  nyra_cond_t *has_data;
+
+  // Signaled when the I/O thread has taken the front buffer, or has written
+  // the back buffer.
+  nyra_cond_t *has_space;
+
+  // Both buffers have the capacity of 'config.buffer_size'. 'front' is only
+  // touched with 'lock' held, 'back' is owned by the I/O thread while
+  // 'writing' is true.
+  uint8_t *front;
+  size_t front_len;
+  uint8_t *back;
+  size_t back_len;
+  bool writing;
+
+  bool flush_requested;
+  bool closing;
+
+  int64_t last_sync_time_ms;
+
+  nyra_async_file_finalize_func_t finalize;
+  void *finalize_data;
+
+  nyra_runloop_t *close_loop;
+  nyra_async_file_on_closed_func_t on_closed;
+  void *on_closed_data;
+
+  nyra_async_file_stats_t stats;
+};
+
+static inline void nyra_async_file_config_init(nyra_async_file_config_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  memset(self, 0, sizeof(nyra_async_file_config_t));
+  self->buffer_size = NYRA_ASYNC_FILE_DEFAULT_BUFFER_SIZE;
+  self->flush_interval_ms = NYRA_ASYNC_FILE_DEFAULT_FLUSH_INTERVAL_MS;
+  self->sync = NYRA_ASYNC_FILE_SYNC_NONE;
+  self->overflow = NYRA_ASYNC_FILE_OVERFLOW_DROP;
+}
+
+static inline bool nyra_async_file_check_integrity(nyra_async_file_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  return nyra_signature_get(&self->signature) == NYRA_ASYNC_FILE_SIGNATURE;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_async_file_write_all_(nyra_async_file_t *self,
+                                             const uint8_t *data,
+                                             size_t len) {
+#if !defined(_WIN32)
+  while (len > 0) {
+    ssize_t n = write(self->fd, data, len);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      // The bytes are lost, but the writer keeps going, a full disk might be
+      // cleaned up later.
+      nyra_mutex_lock(self->lock);
+      self->stats.write_errors++;
+      self->stats.last_errno = errno;
+      nyra_mutex_unlock(self->lock);
+      return;
+    }
+
+    data += n;
+    len -= (size_t)n;
+
+    nyra_mutex_lock(self->lock);
+    self->stats.written_bytes += (uint64_t)n;
+    nyra_mutex_unlock(self->lock);
+  }
+#else
+  (void)self;
+  (void)data;
+  (void)len;
+#endif
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_async_file_sync_(nyra_async_file_t *self, bool force) {
+#if !defined(_WIN32)
+  int64_t now = nyra_current_time();
+
+  switch (self->config.sync) {
+    case NYRA_ASYNC_FILE_SYNC_ALWAYS:
+      force = true;
+      break;
+    case NYRA_ASYNC_FILE_SYNC_INTERVAL:
+      if (now - self->last_sync_time_ms >= self->config.sync_interval_ms) {
+        force = true;
+      }
+      break;
+    default:
+      break;
+  }
+
+  if (force) {
+    fsync(self->fd);
+    self->last_sync_time_ms = now;
+  }
+#else
+  (void)self;
+  (void)force;
+#endif
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline int nyra_async_file_has_nothing_to_do_(void *arg) {
+  nyra_async_file_t *self = (nyra_async_file_t *)arg;
+  return self->front_len == 0 && !self->flush_requested && !self->closing;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_async_file_destroy_(nyra_async_file_t *self) {
+  nyra_cond_destroy(self->has_space);
+  nyra_cond_destroy(self->has_data);
+  nyra_mutex_destroy(self->lock);
+  NYRA_FREE_(self->front);
+  NYRA_FREE_(self->back);
+
+  nyra_signature_set(&self->signature, 0);
+  NYRA_FREE_(self);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_async_file_on_closed_in_loop_(void *from, void *arg) {
+  (void)arg;
+
+  nyra_async_file_t *self = (nyra_async_file_t *)from;
+  NYRA_ASSERT(self && nyra_async_file_check_integrity(self),
+             "Invalid argument.");
+
+  nyra_thread_join(self->thread, -1);
+
+  if (self->on_closed) {
+    self->on_closed(self, self->on_closed_data);
+  }
+
+  nyra_async_file_destroy_(self);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void *nyra_async_file_thread_main_(void *arg) {
+  nyra_async_file_t *self = (nyra_async_file_t *)arg;
+  NYRA_ASSERT(self && nyra_async_file_check_integrity(self),
+             "Invalid argument.");
+
+  nyra_mutex_lock(self->lock);
+
+  for (;;) {
+    if (nyra_async_file_has_nothing_to_do_(self)) {
+      nyra_cond_wait_while(self->has_data, self->lock,
+                          nyra_async_file_has_nothing_to_do_, self,
+                          self->config.flush_interval_ms);
+    }
+
+    bool closing = self->closing;
+    bool force_sync = self->flush_requested;
+    self->flush_requested = false;
+
+    if (self->front_len > 0) {
+      // Swap the buffers, so the callers could keep appending while the back
+      // buffer is being written.
+      uint8_t *tmp = self->back;
+      self->back = self->front;
+      self->back_len = self->front_len;
+      self->front = tmp;
+      self->front_len = 0;
+      self->writing = true;
+      nyra_cond_broadcast(self->has_space);
+
+      nyra_mutex_unlock(self->lock);
+
+      nyra_async_file_write_all_(self, self->back, self->back_len);
+      nyra_async_file_sync_(self, force_sync);
+
+      nyra_mutex_lock(self->lock);
+
+      self->back_len = 0;
+      self->writing = false;
+      nyra_cond_broadcast(self->has_space);
+
+      // Drain everything before closing.
+      continue;
+    }
+
+    if (force_sync) {
+      nyra_mutex_unlock(self->lock);
+      nyra_async_file_sync_(self, true);
+      nyra_mutex_lock(self->lock);
+    }
+
+    if (closing) {
+      break;
+    }
+  }
+
+  nyra_mutex_unlock(self->lock);
+
+#if !defined(_WIN32)
+  if (self->finalize) {
+    self->finalize(self->fd, self->stats.written_bytes, self->finalize_data);
+  }
+
+  if (self->config.sync != NYRA_ASYNC_FILE_SYNC_NONE) {
+    fsync(self->fd);
+  }
+
+  close(self->fd);
+  self->fd = -1;
+#endif
+
+  if (self->close_loop) {
+    // The thread could not join itself, so the rest of the cleanup happens in
+    // the runloop.
+    int rc = nyra_runloop_post_task_tail(
+        self->close_loop, nyra_async_file_on_closed_in_loop_, self, NULL);
+    NYRA_ASSERT(!rc, "Should not happen.");
+    (void)rc;
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Open @a path for writing, and start the I/O thread.
+ *
+ * @param config NULL for the default configuration.
+ *
+ * @return NULL if the file could not be opened.
+ */
+static inline nyra_async_file_t *nyra_async_file_open(
+    const char *path, const nyra_async_file_config_t *config) {
+  NYRA_ASSERT(path, "Invalid argument.");
+
+#if !defined(_WIN32)
+  nyra_async_file_config_t default_config;
+  if (!config) {
+    nyra_async_file_config_init(&default_config);
+    config = &default_config;
+  }
+
+  NYRA_ASSERT(config->buffer_size > 0, "Invalid argument.");
+
+  // O_APPEND is not used for the truncated files, so that 'finalize' could
+  // pwrite() a header at the beginning of the file.
+  int flags = O_WRONLY | O_CREAT | (config->truncate ? O_TRUNC : O_APPEND);
+  int fd = open(path, flags, 0644);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  nyra_async_file_t *self =
+      (nyra_async_file_t *)NYRA_MALLOC(sizeof(nyra_async_file_t));
+  NYRA_ASSERT(self, "Failed to allocate memory.");
+  memset(self, 0, sizeof(nyra_async_file_t));
+
+  nyra_signature_set(&self->signature, NYRA_ASYNC_FILE_SIGNATURE);
+  self->fd = fd;
+  self->config = *config;
+
+  self->lock = nyra_mutex_create();
+  self->has_data = nyra_cond_create();
+  self->has_space = nyra_cond_create();
+
+  self->front = (uint8_t *)NYRA_MALLOC(config->buffer_size);
+  self->back = (uint8_t *)NYRA_MALLOC(config->buffer_size);
+  NYRA_ASSERT(self->front && self->back, "Failed to allocate memory.");
+
+  self->last_sync_time_ms = nyra_current_time();
+
+  self->thread =
+      nyra_thread_create("nyra_async_file", nyra_async_file_thread_main_, self);
+  if (!self->thread) {
+    close(fd);
+    nyra_async_file_destroy_(self);
+    return NULL;
+  }
+
+  return self;
+#else
+  (void)config;
+  return NULL;
+#endif
+}
+
+/**
+ * @brief Register a function to be called on the I/O thread right before the
+ * file is closed. It must be called before closing the writer.
+ */
+static inline void nyra_async_file_set_finalize(
+    nyra_async_file_t *self, nyra_async_file_finalize_func_t finalize,
+    void *data) {
+  NYRA_ASSERT(self && nyra_async_file_check_integrity(self),
+             "Invalid argument.");
+
+  nyra_mutex_lock(self->lock);
+  self->finalize = finalize;
+  self->finalize_data = data;
+  nyra_mutex_unlock(self->lock);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_async_file_copy_locked_(nyra_async_file_t *self,
+                                               const uint8_t *p, size_t len) {
+  while (len > 0) {
+    size_t room = self->config.buffer_size - self->front_len;
+    if (room == 0) {
+      // Only reachable in the blocking mode, wake up the I/O thread, and wait
+      // for it to take the front buffer.
+      nyra_cond_signal(self->has_data);
+      nyra_cond_wait(self->has_space, self->lock, -1);
+      continue;
+    }
+
+    size_t n = len < room ? len : room;
+    memcpy(self->front + self->front_len, p, n);
+    self->front_len += n;
+    p += n;
+    len -= n;
+  }
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_async_file_append_parts_(nyra_async_file_t *self,
+                                                const uint8_t *data,
+                                                size_t len,
+                                                const uint8_t *suffix,
+                                                size_t suffix_len) {
+  NYRA_ASSERT(self && nyra_async_file_check_integrity(self) && (data || !len),
+             "Invalid argument.");
+
+  size_t total = len + suffix_len;
+  bool block = self->config.overflow == NYRA_ASYNC_FILE_OVERFLOW_BLOCK;
+
+  nyra_mutex_lock(self->lock);
+
+  if (self->closing ||
+      (!block && total > self->config.buffer_size - self->front_len)) {
+    self->stats.dropped_bytes += total;
+    nyra_mutex_unlock(self->lock);
+    return false;
+  }
+
+  if (block && total <= self->config.buffer_size) {
+    // Wait for the room of the whole entry before copying any of it, so the
+    // lock is never dropped in the middle of the entry, and the bytes of other
+    // threads could not get in between.
+    while (self->config.buffer_size - self->front_len < total) {
+      nyra_cond_signal(self->has_data);
+      nyra_cond_wait(self->has_space, self->lock, -1);
+    }
+  }
+
+  self->stats.appended_bytes += total;
+
+  nyra_async_file_copy_locked_(self, data, len);
+  nyra_async_file_copy_locked_(self, suffix, suffix_len);
+
+  // Wake up the I/O thread early if the front buffer is getting full, rather
+  // than waiting for the flush interval.
+  if (self->front_len >= self->config.buffer_size / 2 && !self->writing) {
+    nyra_cond_signal(self->has_data);
+  }
+
+  nyra_mutex_unlock(self->lock);
+
+  return true;
+}
+
+/**
+ * @brief Copy @a data into the front buffer. It could be called from any
+ * thread. The bytes are not interleaved with the bytes appended by other
+ * threads, as long as @a len is not larger than 'buffer_size'. A larger chunk
+ * is dropped in the dropping mode, and might be split in the blocking mode.
+ *
+ * @return false if the bytes have been dropped.
+ */
+static inline bool nyra_async_file_append(nyra_async_file_t *self,
+                                         const void *data, size_t len) {
+  return nyra_async_file_append_parts_(self, (const uint8_t *)data, len, NULL,
+                                       0);
+}
+
+/**
+ * @brief Same as 'nyra_async_file_append()', followed by a newline. The line
+ * and its newline are kept together, with the same limit of 'buffer_size'.
+ */
+static inline bool nyra_async_file_append_line(nyra_async_file_t *self,
+                                              const char *line, size_t len) {
+  return nyra_async_file_append_parts_(self, (const uint8_t *)line, len,
+                                       (const uint8_t *)"\n", 1);
+}
+
+/**
+ * @brief Ask the I/O thread to write the buffered bytes and fsync() the file
+ * now. It does not wait for the completion.
+ */
+static inline void nyra_async_file_flush(nyra_async_file_t *self) {
+  NYRA_ASSERT(self && nyra_async_file_check_integrity(self),
+             "Invalid argument.");
+
+  nyra_mutex_lock(self->lock);
+  self->flush_requested = true;
+  nyra_cond_signal(self->has_data);
+  nyra_mutex_unlock(self->lock);
+}
+
+static inline nyra_async_file_stats_t nyra_async_file_get_stats(
+    nyra_async_file_t *self) {
+  NYRA_ASSERT(self && nyra_async_file_check_integrity(self),
+             "Invalid argument.");
+
+  nyra_mutex_lock(self->lock);
+  nyra_async_file_stats_t stats = self->stats;
+  nyra_mutex_unlock(self->lock);
+
+  return stats;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_async_file_request_close_(nyra_async_file_t *self) {
+  nyra_mutex_lock(self->lock);
+  NYRA_ASSERT(!self->closing, "The writer has been closed.");
+  self->closing = true;
+  nyra_cond_signal(self->has_data);
+  nyra_mutex_unlock(self->lock);
+}
+
+/**
+ * @brief Write all the buffered bytes, close the file and destroy @a self. It
+ * blocks until the I/O thread has finished, so it is meant to be used on the
+ * shutdown path, ex: the logger.
+ */
+static inline void nyra_async_file_close(nyra_async_file_t *self) {
+  NYRA_ASSERT(self && nyra_async_file_check_integrity(self),
+             "Invalid argument.");
+
+  nyra_async_file_request_close_(self);
+  nyra_thread_join(self->thread, -1);
+  nyra_async_file_destroy_(self);
+}
+
+/**
+ * @brief Same as 'nyra_async_file_close()', but it returns immediately, and
+ * @a on_closed is called on @a loop after the file has been closed.
+ */
+static inline void nyra_async_file_close_async(
+    nyra_async_file_t *self, nyra_runloop_t *loop,
+    nyra_async_file_on_closed_func_t on_closed, void *data) {
+  NYRA_ASSERT(self && nyra_async_file_check_integrity(self) && loop,
+             "Invalid argument.");
+
+  nyra_mutex_lock(self->lock);
+  self->close_loop = loop;
+  self->on_closed = on_closed;
+  self->on_closed_data = data;
+  nyra_mutex_unlock(self->lock);
+
+  nyra_async_file_request_close_(self);
+}
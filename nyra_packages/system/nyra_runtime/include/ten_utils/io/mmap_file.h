@@ -0,0 +1,210 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if !defined(_WIN32)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include "nyra_utils/lib/alloc.h"
+#include "nyra_utils/lib/buf.h"
+#include "nyra_utils/lib/ref.h"
+#include "nyra_utils/lib/signature.h"
+#include "nyra_utils/macro/check.h"
+
+#define NYRA_MMAP_FILE_SIGNATURE 0x3C8A2D5E90F1B746U
+
+// A read-only, reference-counted view of a whole file. Unlike 'nyra_mmap_t',
+// which is an implementation detail of the NYRA runtime, this is meant to be
+// used by extensions to read large documents, audio prompts and model assets
+// without copying them into the heap. The view stays valid until the last
+// reference is released, even if the file is closed or removed.
+//
+// It could be handed to a data message without copying through
+// 'nyra_data_set_buf_with_mmap_file()'.
+
+typedef enum NYRA_MMAP_ADVICE {
+  NYRA_MMAP_ADVICE_NORMAL,
+
+  // The pages will be accessed in order, the kernel could read ahead more
+  // aggressively and drop the pages which have been read.
+  NYRA_MMAP_ADVICE_SEQUENTIAL,
+
+  NYRA_MMAP_ADVICE_RANDOM,
+
+  // The pages will be needed soon, start reading them in now.
+  NYRA_MMAP_ADVICE_WILLNEED,
+} NYRA_MMAP_ADVICE;
+
+typedef struct nyra_mmap_file_t {
+  nyra_signature_t signature;
+  nyra_ref_t ref;
+
+  void *data;
+  size_t size;
+} nyra_mmap_file_t;
+
+static inline bool nyra_mmap_file_check_integrity(nyra_mmap_file_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  return nyra_signature_get(&self->signature) == NYRA_MMAP_FILE_SIGNATURE;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_mmap_file_on_end_of_life_(nyra_ref_t *ref,
+                                                 void *supervisee) {
+  nyra_mmap_file_t *self = (nyra_mmap_file_t *)supervisee;
+  NYRA_ASSERT(self && nyra_mmap_file_check_integrity(self),
+             "Invalid argument.");
+
+#if !defined(_WIN32)
+  if (self->data) {
+    munmap(self->data, self->size);
+  }
+#endif
+
+  nyra_ref_deinit(ref);
+  nyra_signature_set(&self->signature, 0);
+  NYRA_FREE_(self);
+}
+
+/**
+ * @brief Give the kernel a hint about how the view will be accessed.
+ */
+static inline bool nyra_mmap_file_advise(nyra_mmap_file_t *self,
+                                        NYRA_MMAP_ADVICE advice) {
+  NYRA_ASSERT(self && nyra_mmap_file_check_integrity(self),
+             "Invalid argument.");
+
+#if !defined(_WIN32)
+  if (!self->data) {
+    // Nothing is mapped for an empty file.
+    return true;
+  }
+
+  int posix_advice = POSIX_MADV_NORMAL;
+  switch (advice) {
+    case NYRA_MMAP_ADVICE_SEQUENTIAL:
+      posix_advice = POSIX_MADV_SEQUENTIAL;
+      break;
+    case NYRA_MMAP_ADVICE_RANDOM:
+      posix_advice = POSIX_MADV_RANDOM;
+      break;
+    case NYRA_MMAP_ADVICE_WILLNEED:
+      posix_advice = POSIX_MADV_WILLNEED;
+      break;
+    default:
+      break;
+  }
+
+  return posix_madvise(self->data, self->size, posix_advice) == 0;
+#else
+  (void)advice;
+  return false;
+#endif
+}
+
+/**
+ * @brief Map the whole file @a path into memory. The returned view holds one
+ * reference, call 'nyra_mmap_file_release()' when it is no longer needed.
+ *
+ * @return NULL if the file could not be mapped.
+ */
+static inline nyra_mmap_file_t *nyra_mmap_file_open(const char *path,
+                                                  NYRA_MMAP_ADVICE advice) {
+  NYRA_ASSERT(path, "Invalid argument.");
+
+#if !defined(_WIN32)
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return NULL;
+  }
+
+  void *data = NULL;
+  if (st.st_size > 0) {
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      return NULL;
+    }
+  }
+
+  // The mapping does not depend on the file descriptor anymore.
+  close(fd);
+
+  nyra_mmap_file_t *self =
+      (nyra_mmap_file_t *)NYRA_MALLOC(sizeof(nyra_mmap_file_t));
+  NYRA_ASSERT(self, "Failed to allocate memory.");
+
+  nyra_signature_set(&self->signature, NYRA_MMAP_FILE_SIGNATURE);
+  nyra_ref_init(&self->ref, self, nyra_mmap_file_on_end_of_life_);
+  self->data = data;
+  self->size = (size_t)st.st_size;
+
+  if (advice != NYRA_MMAP_ADVICE_NORMAL) {
+    nyra_mmap_file_advise(self, advice);
+  }
+
+  return self;
+#else
+  (void)advice;
+  return NULL;
+#endif
+}
+
+static inline void nyra_mmap_file_retain(nyra_mmap_file_t *self) {
+  NYRA_ASSERT(self && nyra_mmap_file_check_integrity(self),
+             "Invalid argument.");
+  nyra_ref_inc_ref(&self->ref);
+}
+
+/**
+ * @brief Drop one reference, the file will be unmapped when the last one is
+ * dropped.
+ */
+static inline void nyra_mmap_file_release(nyra_mmap_file_t *self) {
+  NYRA_ASSERT(self && nyra_mmap_file_check_integrity(self),
+             "Invalid argument.");
+  nyra_ref_dec_ref(&self->ref);
+}
+
+static inline const uint8_t *nyra_mmap_file_get_data(nyra_mmap_file_t *self) {
+  NYRA_ASSERT(self && nyra_mmap_file_check_integrity(self),
+             "Invalid argument.");
+  return (const uint8_t *)self->data;
+}
+
+static inline size_t nyra_mmap_file_get_size(nyra_mmap_file_t *self) {
+  NYRA_ASSERT(self && nyra_mmap_file_check_integrity(self),
+             "Invalid argument.");
+  return self->size;
+}
+
+/**
+ * @brief A 'nyra_buf_t' which points to the view but does not own it, so the
+ * caller needs to keep a reference until the buf is no longer used.
+ */
+static inline nyra_buf_t nyra_mmap_file_to_buf(nyra_mmap_file_t *self) {
+  NYRA_ASSERT(self && nyra_mmap_file_check_integrity(self),
+             "Invalid argument.");
+  return NYRA_BUF_STATIC_INIT_WITH_DATA_UNOWNED((uint8_t *)self->data,
+                                               self->size);
+}
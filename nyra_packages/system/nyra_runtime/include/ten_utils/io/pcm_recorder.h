@@ -0,0 +1,202 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+  #include <unistd.h>
+#endif
+
+#include "nyra_utils/io/async_file.h"
+#include "nyra_utils/lib/alloc.h"
+#include "nyra_utils/macro/check.h"
+
+// Record interleaved PCM samples into a raw or WAV file without blocking the
+// audio thread. The samples are written by 'nyra_async_file_t', and the sizes
+// in the WAV header are patched on the I/O thread when the recording is
+// closed.
+
+#define NYRA_PCM_RECORDER_WAV_HEADER_SIZE 44
+
+typedef enum NYRA_PCM_RECORDER_FORMAT {
+  NYRA_PCM_RECORDER_FORMAT_RAW,
+  NYRA_PCM_RECORDER_FORMAT_WAV,
+} NYRA_PCM_RECORDER_FORMAT;
+
+typedef struct nyra_pcm_recorder_t {
+  NYRA_PCM_RECORDER_FORMAT format;
+
+  int32_t sample_rate;
+  int32_t channels;
+  int32_t bytes_per_sample;
+
+  nyra_async_file_t *file;
+} nyra_pcm_recorder_t;
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_pcm_recorder_put_u16_(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)(v & 0xFF);
+  p[1] = (uint8_t)((v >> 8) & 0xFF);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_pcm_recorder_put_u32_(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)(v & 0xFF);
+  p[1] = (uint8_t)((v >> 8) & 0xFF);
+  p[2] = (uint8_t)((v >> 16) & 0xFF);
+  p[3] = (uint8_t)((v >> 24) & 0xFF);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_pcm_recorder_fill_wav_header_(
+    nyra_pcm_recorder_t *self, uint8_t *header, uint32_t data_size) {
+  uint32_t block_align = (uint32_t)(self->channels * self->bytes_per_sample);
+
+  memcpy(header, "RIFF", 4);
+  nyra_pcm_recorder_put_u32_(header + 4, 36 + data_size);
+  memcpy(header + 8, "WAVE", 4);
+
+  memcpy(header + 12, "fmt ", 4);
+  nyra_pcm_recorder_put_u32_(header + 16, 16);
+  nyra_pcm_recorder_put_u16_(header + 20, 1);  // PCM
+  nyra_pcm_recorder_put_u16_(header + 22, (uint32_t)self->channels);
+  nyra_pcm_recorder_put_u32_(header + 24, (uint32_t)self->sample_rate);
+  nyra_pcm_recorder_put_u32_(header + 28,
+                             (uint32_t)self->sample_rate * block_align);
+  nyra_pcm_recorder_put_u16_(header + 32, block_align);
+  nyra_pcm_recorder_put_u16_(header + 34,
+                             (uint32_t)self->bytes_per_sample * 8);
+
+  memcpy(header + 36, "data", 4);
+  nyra_pcm_recorder_put_u32_(header + 40, data_size);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_pcm_recorder_finalize_(int fd, uint64_t written_bytes,
+                                              void *data) {
+  nyra_pcm_recorder_t *self = (nyra_pcm_recorder_t *)data;
+
+  uint64_t data_size = written_bytes > NYRA_PCM_RECORDER_WAV_HEADER_SIZE
+                           ? written_bytes - NYRA_PCM_RECORDER_WAV_HEADER_SIZE
+                           : 0;
+  if (data_size > UINT32_MAX - 36) {
+    // A WAV file could not describe more than 4GB, leave the placeholder
+    // sizes, most players handle it as 'until the end of the file'.
+    return;
+  }
+
+  uint8_t header[NYRA_PCM_RECORDER_WAV_HEADER_SIZE];
+  nyra_pcm_recorder_fill_wav_header_(self, header, (uint32_t)data_size);
+
+#if !defined(_WIN32)
+  ssize_t rc = pwrite(fd, header, sizeof(header), 0);
+  (void)rc;
+#else
+  (void)fd;
+#endif
+}
+
+/**
+ * @brief Start recording into @a path, the file will be truncated.
+ *
+ * @param bytes_per_sample The size of one sample of one channel, ex: 2 for the
+ * 16-bit PCM.
+ * @param config NULL for the default configuration, which drops the samples
+ * rather than blocking the audio thread when the disk could not keep up.
+ *
+ * @return NULL if the file could not be opened.
+ */
+static inline nyra_pcm_recorder_t *nyra_pcm_recorder_create(
+    const char *path, NYRA_PCM_RECORDER_FORMAT format, int32_t sample_rate,
+    int32_t channels, int32_t bytes_per_sample,
+    const nyra_async_file_config_t *config) {
+  NYRA_ASSERT(path && sample_rate > 0 && channels > 0 && bytes_per_sample > 0,
+             "Invalid argument.");
+
+  nyra_async_file_config_t file_config;
+  if (config) {
+    file_config = *config;
+  } else {
+    nyra_async_file_config_init(&file_config);
+  }
+  file_config.truncate = true;
+
+  nyra_async_file_t *file = nyra_async_file_open(path, &file_config);
+  if (!file) {
+    return NULL;
+  }
+
+  nyra_pcm_recorder_t *self =
+      (nyra_pcm_recorder_t *)NYRA_MALLOC(sizeof(nyra_pcm_recorder_t));
+  NYRA_ASSERT(self, "Failed to allocate memory.");
+
+  self->format = format;
+  self->sample_rate = sample_rate;
+  self->channels = channels;
+  self->bytes_per_sample = bytes_per_sample;
+  self->file = file;
+
+  if (format == NYRA_PCM_RECORDER_FORMAT_WAV) {
+    // The sizes are unknown yet, they are patched when the recording is
+    // closed.
+    uint8_t header[NYRA_PCM_RECORDER_WAV_HEADER_SIZE];
+    nyra_pcm_recorder_fill_wav_header_(self, header, 0);
+    nyra_async_file_append(file, header, sizeof(header));
+
+    nyra_async_file_set_finalize(file, nyra_pcm_recorder_finalize_, self);
+  }
+
+  return self;
+}
+
+/**
+ * @brief Append interleaved samples. It only copies @a data, so it is safe to
+ * be called on the audio thread.
+ *
+ * @return false if the samples have been dropped.
+ */
+static inline bool nyra_pcm_recorder_write(nyra_pcm_recorder_t *self,
+                                          const void *data, size_t size) {
+  NYRA_ASSERT(self && self->file, "Invalid argument.");
+  return nyra_async_file_append(self->file, data, size);
+}
+
+/**
+ * @brief Finish the recording and destroy @a self. It waits until the samples
+ * have been written.
+ */
+static inline void nyra_pcm_recorder_destroy(nyra_pcm_recorder_t *self) {
+  NYRA_ASSERT(self && self->file, "Invalid argument.");
+
+  nyra_async_file_close(self->file);
+  NYRA_FREE_(self);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_pcm_recorder_on_closed_(nyra_async_file_t *file,
+                                               void *data) {
+  (void)file;
+  NYRA_FREE_(data);
+}
+
+/**
+ * @brief Same as 'nyra_pcm_recorder_destroy()', but it returns immediately,
+ * and @a self is destroyed on @a loop after the file has been closed.
+ */
+static inline void nyra_pcm_recorder_destroy_async(nyra_pcm_recorder_t *self,
+                                                  nyra_runloop_t *loop) {
+  NYRA_ASSERT(self && self->file && loop, "Invalid argument.");
+
+  nyra_async_file_close_async(self->file, loop, nyra_pcm_recorder_on_closed_,
+                              self);
+}
@@ -94,6 +94,8 @@ NYRA_UTILS_API void nyra_stream_set_on_closed(nyra_stream_t *self, void *on_clos
  *          (e.g.event2, uv, etc.)
  *       3. |self| will be removed from |from| loop and no more data
  *          will be read from it
+ *       4. Use |nyra_stream_migrate_with_handoff| to keep the reads and writes
+ *          during the migration, refer to "nyra_utils/io/stream_handoff.h"
  */
 NYRA_UTILS_API int nyra_stream_migrate(nyra_stream_t *self, nyra_runloop_t *from,
                                      nyra_runloop_t *to, void **user_data,
@@ -0,0 +1,335 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nyra_utils/container/small_vector.h"
+#include "nyra_utils/io/runloop.h"
+#include "nyra_utils/io/stream.h"
+#include "nyra_utils/lib/alloc.h"
+#include "nyra_utils/lib/mutex.h"
+#include "nyra_utils/macro/check.h"
+
+// Let a stream keep serving reads and writes while it is being migrated by
+// 'nyra_stream_migrate()', rather than waiting for the source runloop to
+// settle before the destination takes over.
+//
+// While the handoff is in progress:
+// - 'nyra_stream_handoff_send()' queues the message instead of sending it to
+//   the stream which is being detached from the source runloop.
+// - 'nyra_stream_handoff_on_read()' queues the bytes which are still read on
+//   the source runloop, instead of dispatching them to a protocol which is
+//   moving to another thread.
+//
+// When the new stream is ready on the destination runloop, the queued bytes are
+// taken in one step under the lock. The writes are sent to the new stream
+// before the migration callback of the caller, and the reads are delivered to
+// the 'on_message_read' of the new stream right after it, both in their
+// original order. So nothing which is in flight during the handoff is lost or
+// reordered, and the clients do not see a stall while 'start_graph' moves many
+// connections.
+//
+// If the migration fails, there is no stream left to replay the queue on, so
+// each queued item is reported to the 'on_dropped' callback, if any, in its
+// original order. Without one, a queued write is released by the
+// 'on_message_free' of the original stream with a status of -1, as a write
+// which failed, and a queued read is discarded.
+
+typedef enum NYRA_STREAM_HANDOFF_STATE {
+  NYRA_STREAM_HANDOFF_STATE_IDLE,
+  NYRA_STREAM_HANDOFF_STATE_MIGRATING,
+} NYRA_STREAM_HANDOFF_STATE;
+
+typedef enum NYRA_STREAM_HANDOFF_ITEM_TYPE {
+  NYRA_STREAM_HANDOFF_ITEM_TYPE_READ,
+  NYRA_STREAM_HANDOFF_ITEM_TYPE_WRITE,
+} NYRA_STREAM_HANDOFF_ITEM_TYPE;
+
+typedef struct nyra_stream_handoff_item_t {
+  NYRA_STREAM_HANDOFF_ITEM_TYPE type;
+
+  // For the writes, the message is owned by the caller as usual, and is
+  // released in 'on_message_free' after it has been sent, or after it has been
+  // dropped by a failed migration. For the reads, the bytes are copied right
+  // after this struct, as the buffer of the backend is only valid in the read
+  // callback.
+  const char *msg;
+  uint32_t size;
+  void *user_data;
+} nyra_stream_handoff_item_t;
+
+typedef void (*nyra_stream_handoff_on_dropped_func_t)(
+    nyra_stream_t *stream, const nyra_stream_handoff_item_t *item, void *data);
+
+typedef struct nyra_stream_handoff_t {
+  nyra_mutex_t *lock;
+  NYRA_STREAM_HANDOFF_STATE state;
+
+  // nyra_stream_handoff_item_t*, a handoff rarely queues more than a few.
+  nyra_small_vector_t pending;
+
+  // The stream being migrated.
+  nyra_stream_t *stream;
+
+  void **user_data;
+  void (*on_migrated)(nyra_stream_t *new_stream, void **user_data);
+
+  nyra_stream_handoff_on_dropped_func_t on_dropped;
+  void *on_dropped_data;
+} nyra_stream_handoff_t;
+
+static inline void nyra_stream_handoff_init(nyra_stream_handoff_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  memset(self, 0, sizeof(nyra_stream_handoff_t));
+  self->lock = nyra_mutex_create();
+  self->state = NYRA_STREAM_HANDOFF_STATE_IDLE;
+  nyra_small_vector_init(&self->pending, sizeof(nyra_stream_handoff_item_t *));
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_stream_handoff_free_items_(nyra_small_vector_t *items) {
+  nyra_small_vector_foreach(items, iter) {
+    NYRA_FREE_(*(nyra_stream_handoff_item_t **)iter.item);
+  }
+  nyra_small_vector_deinit(items);
+}
+
+/**
+ * @brief Set the callback which is given each item queued during a migration
+ * which has failed, so that the caller could release the messages it has sent
+ * and see the bytes which have been read. It is called in the thread which
+ * reports the failure, ex: the @a to loop thread, so it must be set before the
+ * migration is started.
+ */
+static inline void nyra_stream_handoff_set_on_dropped(
+    nyra_stream_handoff_t *self, nyra_stream_handoff_on_dropped_func_t on_dropped,
+    void *data) {
+  NYRA_ASSERT(self && self->state == NYRA_STREAM_HANDOFF_STATE_IDLE,
+             "Invalid argument.");
+
+  self->on_dropped = on_dropped;
+  self->on_dropped_data = data;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_stream_handoff_drop_items_(nyra_stream_handoff_t *self,
+                                                   nyra_small_vector_t *items) {
+  nyra_small_vector_foreach(items, iter) {
+    nyra_stream_handoff_item_t *item =
+        *(nyra_stream_handoff_item_t **)iter.item;
+
+    if (self->on_dropped) {
+      self->on_dropped(self->stream, item, self->on_dropped_data);
+    } else if (item->type == NYRA_STREAM_HANDOFF_ITEM_TYPE_WRITE &&
+               self->stream->on_message_free) {
+      self->stream->on_message_free(self->stream, -1, item->user_data);
+    }
+  }
+}
+
+static inline void nyra_stream_handoff_deinit(nyra_stream_handoff_t *self) {
+  NYRA_ASSERT(self && self->state == NYRA_STREAM_HANDOFF_STATE_IDLE,
+             "Invalid argument.");
+
+  nyra_stream_handoff_free_items_(&self->pending);
+  nyra_mutex_destroy(self->lock);
+  self->lock = NULL;
+}
+
+static inline bool nyra_stream_handoff_is_migrating(
+    nyra_stream_handoff_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  nyra_mutex_lock(self->lock);
+  bool migrating = self->state == NYRA_STREAM_HANDOFF_STATE_MIGRATING;
+  nyra_mutex_unlock(self->lock);
+
+  return migrating;
+}
+
+/**
+ * @brief Send @a msg to @a stream, or queue it if the stream is being migrated.
+ * It has the same semantics as 'nyra_stream_send()'.
+ */
+static inline int nyra_stream_handoff_send(nyra_stream_handoff_t *self,
+                                          nyra_stream_t *stream,
+                                          const char *msg, uint32_t size,
+                                          void *user_data) {
+  NYRA_ASSERT(self && msg, "Invalid argument.");
+
+  nyra_mutex_lock(self->lock);
+
+  if (self->state == NYRA_STREAM_HANDOFF_STATE_MIGRATING) {
+    nyra_stream_handoff_item_t *item =
+        (nyra_stream_handoff_item_t *)NYRA_MALLOC(
+            sizeof(nyra_stream_handoff_item_t));
+    NYRA_ASSERT(item, "Failed to allocate memory.");
+
+    item->type = NYRA_STREAM_HANDOFF_ITEM_TYPE_WRITE;
+    item->msg = msg;
+    item->size = size;
+    item->user_data = user_data;
+
+    nyra_small_vector_push_ptr_back(&self->pending, item);
+    nyra_mutex_unlock(self->lock);
+
+    return 0;
+  }
+
+  nyra_mutex_unlock(self->lock);
+
+  NYRA_ASSERT(stream, "Invalid argument.");
+  return nyra_stream_send(stream, msg, size, user_data);
+}
+
+/**
+ * @brief Called in 'on_message_read' of the stream. If the stream is being
+ * migrated, the bytes are queued for the new stream.
+ *
+ * @return true if the bytes have been queued, and should not be dispatched by
+ * the caller.
+ */
+static inline bool nyra_stream_handoff_on_read(nyra_stream_handoff_t *self,
+                                              const void *msg, int size) {
+  NYRA_ASSERT(self && (msg || size <= 0), "Invalid argument.");
+
+  if (size <= 0) {
+    return false;
+  }
+
+  nyra_mutex_lock(self->lock);
+
+  if (self->state != NYRA_STREAM_HANDOFF_STATE_MIGRATING) {
+    nyra_mutex_unlock(self->lock);
+    return false;
+  }
+
+  nyra_stream_handoff_item_t *item = (nyra_stream_handoff_item_t *)NYRA_MALLOC(
+      sizeof(nyra_stream_handoff_item_t) + (size_t)size);
+  NYRA_ASSERT(item, "Failed to allocate memory.");
+
+  char *copy = (char *)(item + 1);
+  memcpy(copy, msg, (size_t)size);
+
+  item->type = NYRA_STREAM_HANDOFF_ITEM_TYPE_READ;
+  item->msg = copy;
+  item->size = (uint32_t)size;
+  item->user_data = NULL;
+
+  nyra_small_vector_push_ptr_back(&self->pending, item);
+  nyra_mutex_unlock(self->lock);
+
+  return true;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_stream_handoff_on_migrated_(nyra_stream_t *new_stream,
+                                                   void **user_data) {
+  nyra_stream_handoff_t *self = (nyra_stream_handoff_t *)user_data;
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  // Take everything queued so far in one step, and leave the migrating state
+  // at the same time, so that no byte is queued after the replay.
+  nyra_small_vector_t pending;
+  nyra_small_vector_init(&pending, sizeof(nyra_stream_handoff_item_t *));
+
+  nyra_mutex_lock(self->lock);
+  nyra_small_vector_swap(&pending, &self->pending);
+  self->state = NYRA_STREAM_HANDOFF_STATE_IDLE;
+  nyra_mutex_unlock(self->lock);
+
+  if (new_stream) {
+    nyra_small_vector_foreach(&pending, iter) {
+      nyra_stream_handoff_item_t *item =
+          *(nyra_stream_handoff_item_t **)iter.item;
+      if (item->type == NYRA_STREAM_HANDOFF_ITEM_TYPE_WRITE) {
+        nyra_stream_send(new_stream, item->msg, item->size, item->user_data);
+      }
+    }
+  } else {
+    // Before 'on_migrated', which is likely to close the original stream.
+    nyra_stream_handoff_drop_items_(self, &pending);
+  }
+
+  // The callbacks of the new stream are usually set up in 'on_migrated', so
+  // the reads are delivered after it, but still before anything read by the
+  // new stream itself, as that could only happen in a later loop iteration.
+  if (self->on_migrated) {
+    self->on_migrated(new_stream, self->user_data);
+  }
+
+  if (new_stream) {
+    nyra_small_vector_foreach(&pending, iter) {
+      nyra_stream_handoff_item_t *item =
+          *(nyra_stream_handoff_item_t **)iter.item;
+      if (item->type == NYRA_STREAM_HANDOFF_ITEM_TYPE_READ &&
+          new_stream->on_message_read) {
+        new_stream->on_message_read(new_stream, (void *)item->msg,
+                                    (int)item->size);
+      }
+    }
+  }
+
+  nyra_stream_handoff_free_items_(&pending);
+}
+
+/**
+ * @brief Same as 'nyra_stream_migrate()', but the reads and writes of @a
+ * stream which happen during the migration are handed over to the new stream
+ * in the @a to loop thread, around the call of @a cb.
+ *
+ * @note @a self must outlive the migration.
+ */
+static inline int nyra_stream_migrate_with_handoff(
+    nyra_stream_handoff_t *self, nyra_stream_t *stream, nyra_runloop_t *from,
+    nyra_runloop_t *to, void **user_data,
+    void (*cb)(nyra_stream_t *new_stream, void **user_data)) {
+  NYRA_ASSERT(self && stream && from && to, "Invalid argument.");
+
+  nyra_mutex_lock(self->lock);
+  NYRA_ASSERT(self->state == NYRA_STREAM_HANDOFF_STATE_IDLE,
+             "The stream is being migrated.");
+  self->state = NYRA_STREAM_HANDOFF_STATE_MIGRATING;
+  self->stream = stream;
+  self->user_data = user_data;
+  self->on_migrated = cb;
+  nyra_mutex_unlock(self->lock);
+
+  int rc = nyra_stream_migrate(stream, from, to, (void **)self,
+                               nyra_stream_handoff_on_migrated_);
+  if (rc) {
+    // The migration has not been started, send the queued messages to the
+    // original stream.
+    nyra_small_vector_t pending;
+    nyra_small_vector_init(&pending, sizeof(nyra_stream_handoff_item_t *));
+
+    nyra_mutex_lock(self->lock);
+    nyra_small_vector_swap(&pending, &self->pending);
+    self->state = NYRA_STREAM_HANDOFF_STATE_IDLE;
+    nyra_mutex_unlock(self->lock);
+
+    nyra_small_vector_foreach(&pending, iter) {
+      nyra_stream_handoff_item_t *item =
+          *(nyra_stream_handoff_item_t **)iter.item;
+      if (item->type == NYRA_STREAM_HANDOFF_ITEM_TYPE_WRITE) {
+        nyra_stream_send(stream, item->msg, item->size, item->user_data);
+      } else if (stream->on_message_read) {
+        stream->on_message_read(stream, (void *)item->msg, (int)item->size);
+      }
+    }
+
+    nyra_stream_handoff_free_items_(&pending);
+  }
+
+  return rc;
+}
@@ -0,0 +1,193 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#if !defined(_WIN32)
+
+  #include <stdbool.h>
+  #include <stddef.h>
+  #include <string.h>
+  #include <sys/socket.h>
+  #include <sys/stat.h>
+  #include <sys/types.h>
+  #include <sys/un.h>
+  #include <unistd.h>
+
+  #include "nyra_utils/lib/uri.h"
+
+// Unix domain socket URIs, used when two apps live on the same host. They skip
+// the TCP/IP stack entirely, which gives a lower latency and fewer syscalls
+// than the loopback TCP. 'nyra_socket_t' only handles TCP and UDP, so these
+// helpers work on plain file descriptors, from 'socket(AF_UNIX, ...)'.
+//
+// - unix:///tmp/app.sock  A socket file in the file system.
+// - unix://@app           A socket in the Linux abstract namespace, it does not
+//                         live in the file system, and disappears as soon as
+//                         the listening socket is closed.
+  #define NYRA_UNIX_SOCKET_URI_PREFIX NYRA_PROTOCOL_UNIX "://"
+  #define NYRA_UNIX_SOCKET_ABSTRACT_PREFIX '@'
+
+/**
+ * @brief Check if @a uri is a unix domain socket URI.
+ */
+static inline bool nyra_uri_is_unix_socket(const char *uri) {
+  return uri && strncmp(uri, NYRA_UNIX_SOCKET_URI_PREFIX,
+                        strlen(NYRA_UNIX_SOCKET_URI_PREFIX)) == 0;
+}
+
+/**
+ * @brief Check if @a uri refers to a socket in the abstract namespace.
+ */
+static inline bool nyra_uri_is_abstract_unix_socket(const char *uri) {
+  return nyra_uri_is_unix_socket(uri) &&
+         uri[strlen(NYRA_UNIX_SOCKET_URI_PREFIX)] ==
+             NYRA_UNIX_SOCKET_ABSTRACT_PREFIX;
+}
+
+/**
+ * @brief Convert a unix domain socket URI to the address used by 'bind()' and
+ * 'connect()'.
+ *
+ * @param addr_len The length which should be passed to 'bind()' and
+ * 'connect()'. The abstract names are not null terminated, so the length is
+ * significant.
+ *
+ * @return false if @a uri is not a valid unix domain socket URI, or the path is
+ * too long.
+ */
+static inline bool nyra_unix_socket_addr_from_uri(const char *uri,
+                                                 struct sockaddr_un *addr,
+                                                 socklen_t *addr_len) {
+  if (!nyra_uri_is_unix_socket(uri) || !addr || !addr_len) {
+    return false;
+  }
+
+  const char *path = uri + strlen(NYRA_UNIX_SOCKET_URI_PREFIX);
+  size_t path_len = strlen(path);
+
+  // A socket file needs room for the null terminator, while the '@' of an
+  // abstract name is replaced by the leading null byte, so the name could fill
+  // the rest of 'sun_path'.
+  size_t max_path_len = path[0] == NYRA_UNIX_SOCKET_ABSTRACT_PREFIX
+                            ? sizeof(addr->sun_path)
+                            : sizeof(addr->sun_path) - 1;
+  if (path_len == 0 || path_len > max_path_len) {
+    return false;
+  }
+
+  memset(addr, 0, sizeof(struct sockaddr_un));
+  addr->sun_family = AF_UNIX;
+
+  if (path[0] == NYRA_UNIX_SOCKET_ABSTRACT_PREFIX) {
+  #if defined(__linux__)
+    // The abstract namespace is identified by a leading null byte.
+    if (path_len == 1) {
+      return false;
+    }
+    addr->sun_path[0] = '\0';
+    memcpy(addr->sun_path + 1, path + 1, path_len - 1);
+    *addr_len = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + path_len);
+    return true;
+  #else
+    // The abstract namespace is a Linux-only feature.
+    return false;
+  #endif
+  }
+
+  memcpy(addr->sun_path, path, path_len);
+  *addr_len =
+      (socklen_t)(offsetof(struct sockaddr_un, sun_path) + path_len + 1);
+  return true;
+}
+
+/**
+ * @brief Remove the stale socket file left by a previous listener, otherwise
+ * 'bind()' fails with EADDRINUSE. It is a no-op for the abstract namespace.
+ *
+ * @note Only a socket file is removed. Anything else at the path, ex: a regular
+ * file named by a mistyped URI, is left as it is, and 'bind()' reports the
+ * error instead.
+ */
+static inline void nyra_unix_socket_unlink(const char *uri) {
+  if (!nyra_uri_is_unix_socket(uri) || nyra_uri_is_abstract_unix_socket(uri)) {
+    return;
+  }
+
+  const char *path = uri + strlen(NYRA_UNIX_SOCKET_URI_PREFIX);
+
+  struct stat st;
+  if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+    unlink(path);
+  }
+}
+
+/**
+ * @brief Get the credentials of the process on the other side of the connected
+ * unix domain socket @a fd.
+ */
+static inline bool nyra_unix_socket_get_peer_cred(int fd, uid_t *uid,
+                                                 gid_t *gid) {
+  #if defined(__linux__) && defined(SO_PEERCRED)
+  // The layout of 'struct ucred', which is only declared by glibc when
+  // _GNU_SOURCE is defined.
+  struct {
+    pid_t pid;
+    uid_t uid;
+    gid_t gid;
+  } cred;
+  socklen_t len = sizeof(cred);
+  if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0 ||
+      len != sizeof(cred)) {
+    return false;
+  }
+  if (uid) {
+    *uid = cred.uid;
+  }
+  if (gid) {
+    *gid = cred.gid;
+  }
+  return true;
+  #elif defined(__APPLE__)
+  uid_t peer_uid = 0;
+  gid_t peer_gid = 0;
+  if (getpeereid(fd, &peer_uid, &peer_gid) != 0) {
+    return false;
+  }
+  if (uid) {
+    *uid = peer_uid;
+  }
+  if (gid) {
+    *gid = peer_gid;
+  }
+  return true;
+  #else
+  (void)fd;
+  (void)uid;
+  (void)gid;
+  return false;
+  #endif
+}
+
+/**
+ * @brief Check that the peer of the accepted unix domain socket @a fd runs as
+ * the same user as the current process, or as root. A socket file is protected
+ * by the file system permissions, but a socket in the abstract namespace could
+ * be connected by anyone on the host, so the listener should call this for
+ * every accepted client.
+ */
+static inline bool nyra_unix_socket_check_peer_is_trusted(int fd) {
+  uid_t uid = 0;
+  if (!nyra_unix_socket_get_peer_cred(fd, &uid, NULL)) {
+    return false;
+  }
+
+  return uid == 0 || uid == geteuid();
+}
+
+#endif
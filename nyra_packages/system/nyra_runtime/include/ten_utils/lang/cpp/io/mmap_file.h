@@ -0,0 +1,80 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "nyra_utils/io/mmap_file.h"
+
+namespace ten {
+
+class data_t;
+
+// A read-only view of a whole file, refer to 'nyra_mmap_file_t'. Copying a
+// 'mmap_file_t' only takes another reference of the same view.
+class mmap_file_t {
+ public:
+  mmap_file_t() = default;
+
+  explicit mmap_file_t(const std::string &path,
+                       NYRA_MMAP_ADVICE advice = NYRA_MMAP_ADVICE_NORMAL)
+      : c_file(nyra_mmap_file_open(path.c_str(), advice)) {}
+
+  mmap_file_t(const mmap_file_t &other) : c_file(other.c_file) {
+    if (c_file != nullptr) {
+      nyra_mmap_file_retain(c_file);
+    }
+  }
+
+  mmap_file_t(mmap_file_t &&other) noexcept : c_file(other.c_file) {
+    other.c_file = nullptr;
+  }
+
+  mmap_file_t &operator=(const mmap_file_t &other) {
+    if (this != &other) {
+      mmap_file_t tmp(other);
+      std::swap(c_file, tmp.c_file);
+    }
+    return *this;
+  }
+
+  mmap_file_t &operator=(mmap_file_t &&other) noexcept {
+    std::swap(c_file, other.c_file);
+    return *this;
+  }
+
+  ~mmap_file_t() {
+    if (c_file != nullptr) {
+      nyra_mmap_file_release(c_file);
+      c_file = nullptr;
+    }
+  }
+
+  bool is_valid() const { return c_file != nullptr; }
+
+  const uint8_t *data() const {
+    return c_file != nullptr ? nyra_mmap_file_get_data(c_file) : nullptr;
+  }
+
+  size_t size() const {
+    return c_file != nullptr ? nyra_mmap_file_get_size(c_file) : 0;
+  }
+
+  bool advise(NYRA_MMAP_ADVICE advice) {
+    return c_file != nullptr && nyra_mmap_file_advise(c_file, advice);
+  }
+
+ private:
+  friend class data_t;
+
+  ::nyra_mmap_file_t *c_file = nullptr;
+};
+
+}  // namespace ten
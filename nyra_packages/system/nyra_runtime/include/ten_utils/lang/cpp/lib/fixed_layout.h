@@ -0,0 +1,260 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+#include "nyra_runtime/common/errno.h"
+#include "nyra_utils/lang/cpp/lib/struct_binding.h"
+#include "nyra_utils/lib/buf.h"
+#include "nyra_utils/lib/error.h"
+#include "nyra_utils/lib/hash.h"
+#include "nyra_utils/macro/check.h"
+#include "nyra_utils/value/value.h"
+#include "nyra_utils/value/value_get.h"
+#include "nyra_utils/value/value_is.h"
+
+// Fixed layout properties, for the messages sent at a high rate with always
+// the same few members, ex: the partial transcripts, the VAD events or the
+// tokens of a stream.
+//
+// The layout is a trivially copyable struct bound by NYRA_STRUCT_BINDING. It
+// is carried as a single 'buf' property holding the bytes of the struct behind
+// a small header, so that setting or getting it is one allocation and a copy,
+// rather than a tree of values with a node, a key and a value per member:
+//
+//   struct vad_event_t {
+//     int64_t start_ms;
+//     int64_t end_ms;
+//     float energy;
+//     bool speech;
+//   };
+//
+//   NYRA_STRUCT_BINDING(vad_event_t, ...)
+//
+//   data->set_property_fixed("vad", event);
+//   ...
+//   vad_event_t event;
+//   data->get_property_fixed("vad", event);
+//
+// Only the bound members are copied into the bytes, the padding and the other
+// members are zeros, so that no uninitialized memory goes on the wire.
+//
+// The header holds a fingerprint of the layout, made of the names, offsets,
+// sizes and kinds of the members, so a receiver built with another layout, or
+// for another ABI, fails to read the property instead of reinterpreting the
+// bytes. A property which is an object, ex: set by an extension in another
+// language, is read as the members of the struct instead.
+
+namespace ten {
+
+// In front of the bytes of the struct in the 'buf' property.
+struct fixed_layout_header_t {
+  uint64_t fingerprint;
+  uint64_t size;
+};
+
+template <typename S>
+struct fixed_layout_t;
+
+namespace detail {
+
+// A fingerprint must be the same in all the processes, so it is not seeded
+// with the randomized seed of the process.
+inline uint64_t fixed_layout_mix(uint64_t hash, uint64_t value) {
+  return nyra_hash_u64_with_seed(value, hash);
+}
+
+template <typename T, typename Enable = void>
+struct fixed_layout_kind_t {
+  static uint64_t get() {
+    return (std::is_floating_point<T>::value ? 1U : 0U) |
+           (std::is_signed<T>::value ? 2U : 0U) |
+           (std::is_same<T, bool>::value ? 4U : 0U) |
+           (std::is_array<T>::value ? 8U : 0U);
+  }
+};
+
+template <typename S>
+struct fixed_layout_kind_t<
+    S, typename std::enable_if<struct_binding_t<S>::bound>::type> {
+  static uint64_t get() { return fixed_layout_t<S>::fingerprint(); }
+};
+
+template <typename S, typename T>
+uint64_t mix_fixed_layout_field(uint64_t hash,
+                                const struct_field_t<S, T> &field,
+                                const S &probe) {
+  auto offset = static_cast<uint64_t>(
+      reinterpret_cast<const char *>(&(probe.*field.member)) -
+      reinterpret_cast<const char *>(&probe));
+
+  hash = fixed_layout_mix(
+      hash, nyra_hash_bytes_with_seed(field.name, strlen(field.name), 0));
+  hash = fixed_layout_mix(hash, offset);
+  hash = fixed_layout_mix(hash, sizeof(T));
+  return fixed_layout_mix(hash, fixed_layout_kind_t<T>::get());
+}
+
+template <typename T, typename Enable = void>
+struct fixed_layout_copier_t {
+  static void copy(const T &in, char *out) { memcpy(out, &in, sizeof(T)); }
+};
+
+template <typename S>
+struct fixed_layout_copier_t<
+    S, typename std::enable_if<struct_binding_t<S>::bound>::type> {
+  static void copy(const S &in, char *out);
+};
+
+template <typename S, typename T>
+void copy_fixed_layout_field(const struct_field_t<S, T> &field, const S &in,
+                             char *out) {
+  auto offset = reinterpret_cast<const char *>(&(in.*field.member)) -
+                reinterpret_cast<const char *>(&in);
+
+  fixed_layout_copier_t<T>::copy(in.*field.member, out + offset);
+}
+
+template <size_t I, size_t N>
+struct fixed_layout_walker_t {
+  template <typename S, typename Fields>
+  static uint64_t mix(const Fields &fields, const S &probe, uint64_t hash) {
+    hash = mix_fixed_layout_field(hash, std::get<I>(fields), probe);
+    return fixed_layout_walker_t<I + 1, N>::mix(fields, probe, hash);
+  }
+
+  template <typename S, typename Fields>
+  static void copy(const Fields &fields, const S &in, char *out) {
+    copy_fixed_layout_field(std::get<I>(fields), in, out);
+    fixed_layout_walker_t<I + 1, N>::copy(fields, in, out);
+  }
+};
+
+template <size_t N>
+struct fixed_layout_walker_t<N, N> {
+  template <typename S, typename Fields>
+  static uint64_t mix(const Fields & /*fields*/, const S & /*probe*/,
+                      uint64_t hash) {
+    return hash;
+  }
+
+  template <typename S, typename Fields>
+  static void copy(const Fields & /*fields*/, const S & /*in*/,
+                   char * /*out*/) {}
+};
+
+// The members of a nested struct are copied one by one too, as it might have
+// padding of its own.
+template <typename S>
+void fixed_layout_copier_t<
+    S, typename std::enable_if<struct_binding_t<S>::bound>::type>::
+    copy(const S &in, char *out) {
+  using fields_t = decltype(struct_binding_t<S>::fields());
+
+  fixed_layout_walker_t<0, std::tuple_size<fields_t>::value>::copy(
+      struct_binding_t<S>::fields(), in, out);
+}
+
+}  // namespace detail
+
+template <typename S>
+struct fixed_layout_t {
+  static_assert(struct_binding_t<S>::bound,
+                "The struct should be bound by NYRA_STRUCT_BINDING.");
+  static_assert(std::is_trivially_copyable<S>::value,
+                "A fixed layout should be trivially copyable.");
+
+  /**
+   * @brief The fingerprint of the layout of @a S, computed once.
+   */
+  static uint64_t fingerprint() {
+    static const uint64_t fingerprint = compute_fingerprint();
+    return fingerprint;
+  }
+
+ private:
+  static uint64_t compute_fingerprint() {
+    using fields_t = decltype(struct_binding_t<S>::fields());
+
+    // The byte order is part of the ABI.
+    const uint16_t byte_order = 0x0102;
+
+    uint64_t hash = 0;
+    hash = detail::fixed_layout_mix(
+        hash, nyra_hash_bytes_with_seed(&byte_order, sizeof(byte_order), 0));
+    hash = detail::fixed_layout_mix(hash, sizeof(S));
+
+    S probe{};
+    return detail::fixed_layout_walker_t<0, std::tuple_size<fields_t>::value>::
+        mix(struct_binding_t<S>::fields(), probe, hash);
+  }
+};
+
+/**
+ * @brief Create a 'buf' value holding @a in with the fingerprint of its
+ * layout, which is owned by the caller.
+ */
+template <typename S>
+::nyra_value_t *fixed_layout_to_value(const S &in) {
+  fixed_layout_header_t header{fixed_layout_t<S>::fingerprint(), sizeof(S)};
+
+  nyra_buf_t buf;
+  nyra_buf_init_with_owned_data(&buf, sizeof(header) + sizeof(S));
+  memset(buf.data, 0, sizeof(header) + sizeof(S));
+  memcpy(buf.data, &header, sizeof(header));
+  detail::fixed_layout_copier_t<S>::copy(
+      in, reinterpret_cast<char *>(buf.data + sizeof(header)));
+  buf.content_size = sizeof(header) + sizeof(S);
+
+  return nyra_value_create_buf_with_move(buf);
+}
+
+/**
+ * @brief Fill @a out from @a value, which is either a 'buf' value created by
+ * 'fixed_layout_to_value()' with the same layout, or an object of the members
+ * of @a S.
+ *
+ * @return false if @a value is a 'buf' of another layout, then @a out is left
+ * as it was.
+ */
+template <typename S>
+bool fixed_layout_from_value(::nyra_value_t *value, S &out,
+                             nyra_error_t *err = nullptr) {
+  NYRA_ASSERT(value, "Invalid argument.");
+
+  if (nyra_value_is_buf(value)) {
+    nyra_buf_t *buf = nyra_value_peek_buf(value);
+
+    fixed_layout_header_t header{};
+    if (buf->content_size == sizeof(header) + sizeof(S)) {
+      memcpy(&header, buf->data, sizeof(header));
+    }
+
+    if (header.fingerprint != fixed_layout_t<S>::fingerprint() ||
+        header.size != sizeof(S)) {
+      if (err != nullptr) {
+        nyra_error_set(err, NYRA_ERRNO_INVALID_TYPE,
+                      "The buf does not hold this fixed layout.");
+      }
+      return false;
+    }
+
+    memcpy(&out, buf->data + sizeof(header), sizeof(S));
+    return true;
+  }
+
+  return struct_from_value(value, out, err);
+}
+
+}  // namespace ten
@@ -0,0 +1,158 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <cstddef>
+#include <iterator>
+
+#include "nyra_utils/container/list.h"
+#include "nyra_utils/container/list_node.h"
+#include "nyra_utils/container/list_node_ptr.h"
+#include "nyra_utils/container/list_ptr.h"
+#include "nyra_utils/macro/check.h"
+
+namespace ten {
+
+// A range over a 'nyra_list_t' whose nodes are ptr nodes holding 'T *', so
+// that it could be walked by a range-based for or passed to the algorithms of
+// the standard library, without copying the list into a 'std::vector' first.
+//
+//   for (auto *kv : ptr_list_view_t<nyra_value_kv_t>(list)) { ... }
+//
+// The view does not own the list, and the list must not be modified while it
+// is being walked.
+template <typename T>
+class ptr_list_view_t {
+ public:
+  class iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T *;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T **;
+    using reference = T *;
+
+    iterator() = default;
+
+    explicit iterator(nyra_listnode_t *node) : node_(node) {}
+
+    T *operator*() const {
+      NYRA_ASSERT(node_, "Invalid argument.");
+      return static_cast<T *>(nyra_ptr_listnode_get(node_));
+    }
+
+    iterator &operator++() {
+      NYRA_ASSERT(node_, "Invalid argument.");
+      node_ = node_->next;
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    bool operator==(const iterator &other) const {
+      return node_ == other.node_;
+    }
+
+    bool operator!=(const iterator &other) const {
+      return node_ != other.node_;
+    }
+
+    nyra_listnode_t *get_c_node() const { return node_; }
+
+   private:
+    nyra_listnode_t *node_ = nullptr;
+  };
+
+  explicit ptr_list_view_t(nyra_list_t *list) : list_(list) {
+    NYRA_ASSERT(list, "Invalid argument.");
+  }
+
+  iterator begin() const { return iterator(nyra_list_front(list_)); }
+
+  iterator end() const { return iterator(); }
+
+  size_t size() const { return nyra_list_size(list_); }
+
+  bool empty() const { return nyra_list_is_empty(list_); }
+
+ private:
+  nyra_list_t *list_;
+};
+
+// Owns a 'nyra_list_t', and destroys its nodes when it goes out of scope. It
+// is move-only, and moving it, or handing its nodes over to another list, only
+// relinks the ends of the lists, so a list built in C++ could be given to the C
+// API without copying any of its items.
+class list_t {
+ public:
+  list_t() { nyra_list_init(&list_); }
+
+  ~list_t() { nyra_list_clear(&list_); }
+
+  list_t(list_t &&other) noexcept {
+    nyra_list_init(&list_);
+    nyra_list_swap(&list_, &other.list_);
+  }
+
+  list_t &operator=(list_t &&other) noexcept {
+    if (this != &other) {
+      nyra_list_clear(&list_);
+      nyra_list_swap(&list_, &other.list_);
+    }
+    return *this;
+  }
+
+  list_t(const list_t &other) = delete;
+  list_t &operator=(const list_t &other) = delete;
+
+  /**
+   * @brief Append @a ptr, which is destroyed by @a destroy with the list
+   * unless it is handed over.
+   */
+  template <typename T>
+  void push_ptr_back(T *ptr, void (*destroy)(T *)) {
+    nyra_list_push_ptr_back(
+        &list_, ptr,
+        reinterpret_cast<nyra_ptr_listnode_destroy_func_t>(destroy));
+  }
+
+  size_t size() const {
+    return nyra_list_size(const_cast<nyra_list_t *>(&list_));
+  }
+
+  bool empty() const {
+    return nyra_list_is_empty(const_cast<nyra_list_t *>(&list_));
+  }
+
+  template <typename T>
+  ptr_list_view_t<T> ptrs() {
+    return ptr_list_view_t<T>(&list_);
+  }
+
+  /**
+   * @brief Move all the nodes to the end of @a dest, this list is empty
+   * afterwards.
+   */
+  void splice_into(nyra_list_t *dest) {
+    NYRA_ASSERT(dest, "Invalid argument.");
+    nyra_list_concat(dest, &list_);
+  }
+
+  // The C API functions taking a list 'with_move' take the nodes of this one.
+  nyra_list_t *get_c_list() { return &list_; }
+
+ private:
+  nyra_list_t list_;
+};
+
+}  // namespace ten
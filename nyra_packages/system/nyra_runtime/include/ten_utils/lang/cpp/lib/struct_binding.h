@@ -0,0 +1,470 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "list.h"
+#include "nyra_runtime/common/errno.h"
+#include "nyra_utils/lib/error.h"
+#include "nyra_utils/lib/string.h"
+#include "nyra_utils/macro/check.h"
+#include "nyra_utils/value/value.h"
+#include "nyra_utils/value/value_get.h"
+#include "nyra_utils/value/value_is.h"
+#include "nyra_utils/value/value_kv.h"
+
+// Binds a plain struct to an object of properties, so that a configuration is
+// read into it, or a message is filled from it, at once:
+//
+//   struct asr_config_t {
+//     std::string api_key;
+//     int64_t sample_rate = 16000;
+//     std::vector<std::string> languages;
+//   };
+//
+//   NYRA_STRUCT_BINDING(asr_config_t,
+//                       NYRA_STRUCT_FIELD(asr_config_t, api_key),
+//                       NYRA_STRUCT_FIELD(asr_config_t, sample_rate),
+//                       NYRA_STRUCT_FIELD_NAMED(asr_config_t, languages,
+//                                               "langs"))
+//
+//   asr_config_t config;
+//   nyra_env.get_property_struct("asr", config);
+//
+// The object is walked once, each of its keys being dispatched to the member
+// of the same name, instead of looking up and copying a path per member. The
+// keys without a member are ignored, and the members without a key keep the
+// value they had. A member of the wrong type fails the whole read, with the
+// name of the member in the error message. An integer member takes an integer
+// of any width in its range, and a floating point member any number.
+//
+// A member could be a bool, an integer or floating point type, a std::string,
+// a char array, a std::vector of any of these, or another bound struct.
+// NYRA_STRUCT_BINDING must be used at global scope.
+
+namespace ten {
+
+template <typename S, typename T>
+struct struct_field_t {
+  const char *name;
+  T S::*member;
+};
+
+template <typename S, typename T>
+constexpr struct_field_t<S, T> struct_field(const char *name, T S::*member) {
+  return struct_field_t<S, T>{name, member};
+}
+
+// Specialized for each struct by NYRA_STRUCT_BINDING.
+template <typename S>
+struct struct_binding_t {
+  static constexpr bool bound = false;
+};
+
+template <typename T, typename Enable = void>
+struct struct_field_codec_t {
+  static_assert(sizeof(T) == 0,
+                "This type could not be a member of a bound struct.");
+};
+
+namespace detail {
+
+// The integer in @a value, whichever its width, as a signed or an unsigned 64
+// bit one. The integers parsed from JSON are uint64 when they are not
+// negative, and int64 otherwise, so the type of a value does not tell the type
+// of its member.
+inline bool peek_integer(::nyra_value_t *value, int64_t &signed_value,
+                         uint64_t &unsigned_value, bool &is_unsigned) {
+  is_unsigned = false;
+
+  switch (nyra_value_get_type(value)) {
+    case NYRA_TYPE_INT8:
+      signed_value = value->content.int8;
+      return true;
+    case NYRA_TYPE_INT16:
+      signed_value = value->content.int16;
+      return true;
+    case NYRA_TYPE_INT32:
+      signed_value = value->content.int32;
+      return true;
+    case NYRA_TYPE_INT64:
+      signed_value = value->content.int64;
+      return true;
+    case NYRA_TYPE_UINT8:
+      unsigned_value = value->content.uint8;
+      break;
+    case NYRA_TYPE_UINT16:
+      unsigned_value = value->content.uint16;
+      break;
+    case NYRA_TYPE_UINT32:
+      unsigned_value = value->content.uint32;
+      break;
+    case NYRA_TYPE_UINT64:
+      unsigned_value = value->content.uint64;
+      break;
+    default:
+      return false;
+  }
+
+  is_unsigned = true;
+  return true;
+}
+
+template <typename T>
+bool read_integer(::nyra_value_t *value, T &out, nyra_error_t *err) {
+  int64_t signed_value = 0;
+  uint64_t unsigned_value = 0;
+  bool is_unsigned = false;
+  if (!peek_integer(value, signed_value, unsigned_value, is_unsigned)) {
+    nyra_error_set(err, NYRA_ERRNO_INVALID_TYPE, "Not an integer.");
+    return false;
+  }
+
+  bool fits = false;
+  if (is_unsigned) {
+    fits = unsigned_value <= static_cast<uint64_t>(std::numeric_limits<T>::max());
+  } else if (signed_value < 0) {
+    fits = std::is_signed<T>::value &&
+           signed_value >= static_cast<int64_t>(std::numeric_limits<T>::min());
+  } else {
+    fits = static_cast<uint64_t>(signed_value) <=
+           static_cast<uint64_t>(std::numeric_limits<T>::max());
+  }
+  if (!fits) {
+    nyra_error_set(err, NYRA_ERRNO_INVALID_ARGUMENT,
+                  "The integer is out of the range of the member.");
+    return false;
+  }
+
+  out = is_unsigned ? static_cast<T>(unsigned_value)
+                    : static_cast<T>(signed_value);
+  return true;
+}
+
+// A floating point member also takes the integers, ex: a 2 in a JSON text.
+template <typename T>
+bool read_real(::nyra_value_t *value, T &out, nyra_error_t *err) {
+  double result = 0;
+
+  int64_t signed_value = 0;
+  uint64_t unsigned_value = 0;
+  bool is_unsigned = false;
+  if (nyra_value_is_float32(value)) {
+    result = value->content.float32;
+  } else if (nyra_value_is_float64(value)) {
+    result = value->content.float64;
+  } else if (peek_integer(value, signed_value, unsigned_value, is_unsigned)) {
+    result = is_unsigned ? static_cast<double>(unsigned_value)
+                         : static_cast<double>(signed_value);
+  } else {
+    nyra_error_set(err, NYRA_ERRNO_INVALID_TYPE, "Not a number.");
+    return false;
+  }
+
+  if (std::isfinite(result) &&
+      std::fabs(result) > static_cast<double>(std::numeric_limits<T>::max())) {
+    nyra_error_set(err, NYRA_ERRNO_INVALID_ARGUMENT,
+                  "The number is out of the range of the member.");
+    return false;
+  }
+
+  out = static_cast<T>(result);
+  return true;
+}
+
+}  // namespace detail
+
+template <>
+struct struct_field_codec_t<bool> {
+  static bool read(::nyra_value_t *value, bool &out, nyra_error_t *err) {
+    if (!nyra_value_is_bool(value)) {
+      nyra_error_set(err, NYRA_ERRNO_INVALID_TYPE, "Not a bool.");
+      return false;
+    }
+
+    out = value->content.boolean;
+    return true;
+  }
+
+  static ::nyra_value_t *write(const bool &in) {
+    return nyra_value_create_bool(in);
+  }
+};
+
+#define NYRA_STRUCT_BINDING_NUMBER_CODEC(type, name, reader)                \
+  template <>                                                              \
+  struct struct_field_codec_t<type> {                                      \
+    static bool read(::nyra_value_t *value, type &out, nyra_error_t *err) { \
+      return detail::reader(value, out, err);                              \
+    }                                                                      \
+                                                                           \
+    static ::nyra_value_t *write(const type &in) {                          \
+      return nyra_value_create_##name(in);                                  \
+    }                                                                      \
+  };
+
+NYRA_STRUCT_BINDING_NUMBER_CODEC(int8_t, int8, read_integer)
+NYRA_STRUCT_BINDING_NUMBER_CODEC(int16_t, int16, read_integer)
+NYRA_STRUCT_BINDING_NUMBER_CODEC(int32_t, int32, read_integer)
+NYRA_STRUCT_BINDING_NUMBER_CODEC(int64_t, int64, read_integer)
+NYRA_STRUCT_BINDING_NUMBER_CODEC(uint8_t, uint8, read_integer)
+NYRA_STRUCT_BINDING_NUMBER_CODEC(uint16_t, uint16, read_integer)
+NYRA_STRUCT_BINDING_NUMBER_CODEC(uint32_t, uint32, read_integer)
+NYRA_STRUCT_BINDING_NUMBER_CODEC(uint64_t, uint64, read_integer)
+NYRA_STRUCT_BINDING_NUMBER_CODEC(float, float32, read_real)
+NYRA_STRUCT_BINDING_NUMBER_CODEC(double, float64, read_real)
+
+#undef NYRA_STRUCT_BINDING_NUMBER_CODEC
+
+template <>
+struct struct_field_codec_t<std::string> {
+  static bool read(::nyra_value_t *value, std::string &out, nyra_error_t *err) {
+    if (!nyra_value_is_string(value)) {
+      nyra_error_set(err, NYRA_ERRNO_INVALID_TYPE, "Not a string.");
+      return false;
+    }
+
+    nyra_string_t *str = nyra_value_peek_string(value);
+    out.assign(nyra_string_get_raw_str(str), nyra_string_len(str));
+    return true;
+  }
+
+  static ::nyra_value_t *write(const std::string &in) {
+    return nyra_value_create_string_with_size(in.data(), in.size());
+  }
+};
+
+// A bounded text, which keeps a struct trivially copyable, ex: for the fixed
+// layouts. It is always '\0' terminated, a longer string fails the read.
+template <size_t N>
+struct struct_field_codec_t<char[N]> {
+  static bool read(::nyra_value_t *value, char (&out)[N], nyra_error_t *err) {
+    if (!nyra_value_is_string(value)) {
+      nyra_error_set(err, NYRA_ERRNO_INVALID_TYPE, "Not a string.");
+      return false;
+    }
+
+    nyra_string_t *str = nyra_value_peek_string(value);
+    size_t len = nyra_string_len(str);
+    if (len >= N) {
+      nyra_error_set(err, NYRA_ERRNO_INVALID_ARGUMENT,
+                    "The string is longer than %zu bytes.", N - 1);
+      return false;
+    }
+
+    memcpy(out, nyra_string_get_raw_str(str), len);
+    out[len] = '\0';
+    return true;
+  }
+
+  static ::nyra_value_t *write(const char (&in)[N]) {
+    return nyra_value_create_string_with_size(in, strnlen(in, N));
+  }
+};
+
+template <typename T>
+struct struct_field_codec_t<std::vector<T>> {
+  static bool read(::nyra_value_t *value, std::vector<T> &out,
+                   nyra_error_t *err) {
+    if (!nyra_value_is_array(value)) {
+      nyra_error_set(err, NYRA_ERRNO_INVALID_TYPE, "Not an array.");
+      return false;
+    }
+
+    ptr_list_view_t<::nyra_value_t> items(nyra_value_peek_array(value));
+
+    std::vector<T> result;
+    result.reserve(items.size());
+
+    size_t index = 0;
+    for (auto *item : items) {
+      T result_item{};
+      if (!struct_field_codec_t<T>::read(item, result_item, err)) {
+        nyra_error_prepend_errmsg(err, "[%zu]: ", index);
+        return false;
+      }
+      result.push_back(std::move(result_item));
+      ++index;
+    }
+
+    out = std::move(result);
+    return true;
+  }
+
+  static ::nyra_value_t *write(const std::vector<T> &in) {
+    list_t items;
+    for (const auto &item : in) {
+      items.push_ptr_back(struct_field_codec_t<T>::write(item),
+                          nyra_value_destroy);
+    }
+    return nyra_value_create_array_with_move(items.get_c_list());
+  }
+};
+
+namespace detail {
+
+template <typename S, typename T>
+bool read_struct_field(const struct_field_t<S, T> &field,
+                       ::nyra_value_t *value, S &out, nyra_error_t *err) {
+  if (!struct_field_codec_t<T>::read(value, out.*field.member, err)) {
+    nyra_error_prepend_errmsg(err, "%s: ", field.name);
+    return false;
+  }
+  return true;
+}
+
+template <typename S, typename T>
+void write_struct_field(const struct_field_t<S, T> &field, const S &in,
+                        list_t &kvs) {
+  // 'nyra_value_kv_create()' takes the name as a format, which a name given to
+  // NYRA_STRUCT_FIELD_NAMED could be mistaken for.
+  nyra_value_kv_t *kv = nyra_value_kv_create_empty("");
+  size_t name_len = strlen(field.name);
+  if (name_len) {
+    nyra_string_set_from_c_str(&kv->key, field.name, name_len);
+  }
+  kv->value = struct_field_codec_t<T>::write(in.*field.member);
+
+  kvs.push_ptr_back(kv, nyra_value_kv_destroy);
+}
+
+// Walks the tuple of the fields of a struct, which could not be iterated at
+// runtime as its elements have different types.
+template <size_t I, size_t N>
+struct struct_fields_walker_t {
+  template <typename S, typename Fields>
+  static bool read(const Fields &fields, const char *key,
+                   ::nyra_value_t *value, S &out, nyra_error_t *err) {
+    if (strcmp(std::get<I>(fields).name, key) == 0) {
+      return read_struct_field(std::get<I>(fields), value, out, err);
+    }
+    return struct_fields_walker_t<I + 1, N>::read(fields, key, value, out,
+                                                  err);
+  }
+
+  template <typename S, typename Fields>
+  static void write(const Fields &fields, const S &in, list_t &kvs) {
+    write_struct_field(std::get<I>(fields), in, kvs);
+    struct_fields_walker_t<I + 1, N>::write(fields, in, kvs);
+  }
+};
+
+template <size_t N>
+struct struct_fields_walker_t<N, N> {
+  template <typename S, typename Fields>
+  static bool read(const Fields & /*fields*/, const char * /*key*/,
+                   ::nyra_value_t * /*value*/, S & /*out*/,
+                   nyra_error_t * /*err*/) {
+    // Not a member of the struct.
+    return true;
+  }
+
+  template <typename S, typename Fields>
+  static void write(const Fields & /*fields*/, const S & /*in*/,
+                    list_t & /*kvs*/) {}
+};
+
+}  // namespace detail
+
+template <typename S>
+struct struct_field_codec_t<
+    S, typename std::enable_if<struct_binding_t<S>::bound>::type> {
+  using fields_t = decltype(struct_binding_t<S>::fields());
+  using walker_t =
+      detail::struct_fields_walker_t<0, std::tuple_size<fields_t>::value>;
+
+  static bool read(::nyra_value_t *value, S &out, nyra_error_t *err) {
+    if (!nyra_value_is_object(value)) {
+      nyra_error_set(err, NYRA_ERRNO_INVALID_TYPE, "Not an object.");
+      return false;
+    }
+
+    const fields_t fields = struct_binding_t<S>::fields();
+    for (auto *kv : ptr_list_view_t<nyra_value_kv_t>(
+             nyra_value_peek_object(value))) {
+      if (!walker_t::read(fields, nyra_string_get_raw_str(&kv->key),
+                          kv->value, out, err)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static ::nyra_value_t *write(const S &in) {
+    list_t kvs;
+    walker_t::write(struct_binding_t<S>::fields(), in, kvs);
+    return nyra_value_create_object_with_move(kvs.get_c_list());
+  }
+};
+
+/**
+ * @brief Fill the members of @a out from the object @a value.
+ *
+ * @return false if @a value is not an object or one of its keys does not have
+ * the type of its member, then @a out might have been partially filled.
+ */
+template <typename S>
+bool struct_from_value(::nyra_value_t *value, S &out,
+                       nyra_error_t *err = nullptr) {
+  static_assert(struct_binding_t<S>::bound,
+                "The struct should be bound by NYRA_STRUCT_BINDING.");
+  NYRA_ASSERT(value, "Invalid argument.");
+
+  // The names of the members are prepended to the error, which is needed to
+  // tell the failure anyway.
+  if (err == nullptr) {
+    nyra_error_t local_err;
+    nyra_error_init(&local_err);
+    bool rc = struct_field_codec_t<S>::read(value, out, &local_err);
+    nyra_error_deinit(&local_err);
+    return rc;
+  }
+
+  return struct_field_codec_t<S>::read(value, out, err);
+}
+
+/**
+ * @brief Create an object holding the members of @a in, which is owned by the
+ * caller.
+ */
+template <typename S>
+::nyra_value_t *struct_to_value(const S &in) {
+  static_assert(struct_binding_t<S>::bound,
+                "The struct should be bound by NYRA_STRUCT_BINDING.");
+  return struct_field_codec_t<S>::write(in);
+}
+
+}  // namespace ten
+
+#define NYRA_STRUCT_FIELD(S, member) ::ten::struct_field(#member, &S::member)
+
+#define NYRA_STRUCT_FIELD_NAMED(S, member, name) \
+  ::ten::struct_field(name, &S::member)
+
+#define NYRA_STRUCT_BINDING(S, ...)                          \
+  namespace ten {                                            \
+  template <>                                                \
+  struct struct_binding_t<S> {                               \
+    static constexpr bool bound = true;                      \
+                                                             \
+    static decltype(std::make_tuple(__VA_ARGS__)) fields() { \
+      return std::make_tuple(__VA_ARGS__);                   \
+    }                                                        \
+  };                                                         \
+  }
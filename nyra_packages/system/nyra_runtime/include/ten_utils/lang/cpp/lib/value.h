@@ -6,6 +6,7 @@
 //
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <map>
@@ -16,6 +17,7 @@
 #include <vector>
 
 #include "buf.h"
+#include "list.h"
 #include "nyra_runtime/common/errno.h"
 #include "nyra_utils/lib/alloc.h"
 #include "nyra_utils/lib/buf.h"
@@ -26,6 +28,7 @@
 #include "nyra_utils/value/value.h"
 #include "nyra_utils/value/value_get.h"
 #include "nyra_utils/value/value_is.h"
+#include "nyra_utils/value/value_json_writer.h"
 
 using nyra_value_t = struct ::nyra_value_t;
 
@@ -97,8 +100,8 @@ class value_t {
   template <typename T>
   struct is_map : public std::false_type {};
 
-  template <typename T, typename A>
-  struct is_map<std::map<T, A>> : public std::true_type {};
+  template <typename K, typename V, typename C, typename A>
+  struct is_map<std::map<K, V, C, A>> : public std::true_type {};
 
   /**
    * @brief This is the fallback constructor to handle all other types of C++
@@ -165,50 +168,75 @@ class value_t {
   // Create a NYRA value of 'object' type.
   template <typename V>
   explicit value_t(const std::map<std::string, V> &map) {
-    nyra_list_t m = NYRA_LIST_INIT_VAL;
+    list_t m;
 
     for (const auto &pair : map) {
-      nyra_value_kv_t *nyra_pair = nyra_value_kv_create_empty(pair.first.c_str());
-      NYRA_ASSERT(nyra_pair, "Invalid argument.");
+      nyra_value_kv_t *nyra_pair = create_c_kv(pair.first);
 
       nyra_pair->value = create_c_value_from_cpp_concept(pair.second);
-      nyra_list_push_ptr_back(&m, nyra_pair,
-                             reinterpret_cast<nyra_ptr_listnode_destroy_func_t>(
-                                 nyra_value_kv_destroy));
+      m.push_ptr_back(nyra_pair, nyra_value_kv_destroy);
+    }
+
+    c_value_ = nyra_value_create_object_with_move(m.get_c_list());
+  }
+
+  // Create a NYRA value of 'object' type. The values are moved rather than
+  // cloned, so a 'std::map<std::string, value_t>' is handed over without
+  // copying any nested value.
+  template <typename V>
+  explicit value_t(std::map<std::string, V> &&map) {
+    list_t m;
+
+    for (auto &pair : map) {
+      nyra_value_kv_t *nyra_pair = create_c_kv(pair.first);
+
+      nyra_pair->value = take_c_value_from_cpp_concept(std::move(pair.second));
+      m.push_ptr_back(nyra_pair, nyra_value_kv_destroy);
     }
+    map.clear();
 
-    c_value_ = nyra_value_create_object_with_move(&m);
-    nyra_list_clear(&m);
+    c_value_ = nyra_value_create_object_with_move(m.get_c_list());
   }
 
   // Create a NYRA value of 'array' type.
   template <typename V>
   explicit value_t(const std::vector<V> &list) {
-    nyra_list_t m = NYRA_LIST_INIT_VAL;
+    list_t m;
 
     for (const auto &v : list) {
-      nyra_list_push_ptr_back(
-          &m, create_c_value_from_cpp_concept(v),
-          reinterpret_cast<nyra_ptr_listnode_destroy_func_t>(nyra_value_destroy));
+      m.push_ptr_back(create_c_value_from_cpp_concept(v), nyra_value_destroy);
     }
 
-    c_value_ = nyra_value_create_array_with_move(&m);
-    nyra_list_clear(&m);
+    c_value_ = nyra_value_create_array_with_move(m.get_c_list());
+  }
+
+  // Create a NYRA value of 'array' type. The items are moved rather than
+  // cloned.
+  template <typename V>
+  explicit value_t(std::vector<V> &&list) {
+    list_t m;
+
+    // 'auto &&' and the cast to 'V &&' turn the proxies of 'std::vector<bool>'
+    // into plain bools, and are a 'std::move()' for the other types.
+    for (auto &&v : list) {
+      m.push_ptr_back(take_c_value_from_cpp_concept(static_cast<V &&>(v)),
+                      nyra_value_destroy);
+    }
+    list.clear();
+
+    c_value_ = nyra_value_create_array_with_move(m.get_c_list());
   }
 
   // Create a NYRA value of 'array' type.
   template <typename V>
   explicit value_t(const std::unordered_set<V> &list) {
-    nyra_list_t m = NYRA_LIST_INIT_VAL;
+    list_t m;
 
     for (const auto &v : list) {
-      nyra_list_push_ptr_back(
-          &m, create_c_value_from_cpp_concept(v),
-          reinterpret_cast<nyra_ptr_listnode_destroy_func_t>(nyra_value_destroy));
+      m.push_ptr_back(create_c_value_from_cpp_concept(v), nyra_value_destroy);
     }
 
-    c_value_ = nyra_value_create_array_with_move(&m);
-    nyra_list_clear(&m);
+    c_value_ = nyra_value_create_array_with_move(m.get_c_list());
   }
 
   // Copy semantics.
@@ -429,24 +457,11 @@ class value_t {
     return buf;
   }
 
+  // The memory of @a result is reused, so a string which is kept across the
+  // calls stops allocating once it is big enough.
   int to_json(std::string &result) const {
-    nyra_json_t *c_json = nyra_value_to_json(c_value_);
-    if (c_json == nullptr) {
-      return -1;
-    }
-
-    bool must_free = false;
-    const char *json_str = nyra_json_to_string(c_json, nullptr, &must_free);
-    NYRA_ASSERT(json_str, "Failed to convert a JSON to a string");
-
-    result = json_str;
-
-    nyra_json_destroy(c_json);
-    if (must_free) {
-      NYRA_FREE(json_str);
-    }
-
-    return 0;
+    result.clear();
+    return write_json(c_value_, result) ? 0 : -1;
   }
 
   friend class nyra_env_t;
@@ -476,6 +491,72 @@ class value_t {
     return ret;
   }
 
+  template <typename T>
+  ::nyra_value_t *take_c_value_from_cpp_concept(T &&v) {
+    value_t tmp(std::forward<T>(v));
+    ::nyra_value_t *ret = tmp.c_value_;
+    tmp.c_value_ = nullptr;
+    return ret;
+  }
+
+  // 'nyra_value_kv_create_empty()' takes its name as a format, so a key with a
+  // '%' is set afterwards rather than passed to it.
+  static nyra_value_kv_t *create_c_kv(const std::string &key) {
+    nyra_value_kv_t *kv = nyra_value_kv_create_empty("");
+    NYRA_ASSERT(kv, "Failed to allocate memory.");
+
+    if (!key.empty()) {
+      nyra_string_set_from_c_str(&kv->key, key.c_str(), key.size());
+    }
+    return kv;
+  }
+
+  static char *grow_json_string(void *ctx, size_t size, size_t need,
+                                 size_t *capacity) {
+    auto *str = static_cast<std::string *>(ctx);
+    (void)size;
+
+    str->resize(std::max(need, str->size() * 2));
+
+    *capacity = str->size();
+    return &(*str)[0];
+  }
+
+  // Append the JSON text of @a c_value to @a result, through the same writer
+  // as 'nyra_value_to_json_string()', so that there is neither a 'nyra_json_t'
+  // tree nor a copy of the text. @a result is left as it was on failure.
+  static bool write_json(::nyra_value_t *c_value, std::string &result) {
+    NYRA_ASSERT(c_value, "Invalid argument.");
+
+    // The spare capacity of @a result is written too, it is cut off below.
+    size_t size = result.size();
+    result.resize(result.capacity());
+
+    nyra_value_json_writer_t writer;
+    writer.data = &result[0];
+    writer.size = size;
+    writer.capacity = result.size();
+    writer.grow = grow_json_string;
+    writer.ctx = &result;
+
+    bool rc = nyra_value_json_writer_write(&writer, c_value);
+    result.resize(rc ? writer.size : size);
+
+    return rc;
+  }
+
+  // A 'value_t' which owns its C value gives it away, the others are cloned
+  // as they do not own what they point to.
+  ::nyra_value_t *take_c_value_from_cpp_concept(value_t &&v) {
+    if (!v.own_) {
+      return v.c_value_ != nullptr ? nyra_value_clone(v.c_value_) : nullptr;
+    }
+
+    ::nyra_value_t *ret = v.c_value_;
+    v.c_value_ = nullptr;
+    return ret;
+  }
+
   // @{
   // These functions are used internally in NYRA runtime.
 
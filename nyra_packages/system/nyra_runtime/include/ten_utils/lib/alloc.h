@@ -58,3 +58,13 @@ NYRA_UTILS_API void *nyra_calloc_without_backtrace(size_t cnt, size_t size);
 NYRA_UTILS_API void *nyra_realloc_without_backtrace(void *p, size_t size);
 
 NYRA_UTILS_API char *nyra_strdup_without_backtrace(const char *str);
+
+#if defined(NYRA_ENABLE_CUSTOM_ALLOCATOR)
+  // It depends on the functions above.
+  #include "nyra_utils/lib/allocator.h"  // IWYU pragma: export
+#endif
+
+#if defined(NYRA_ENABLE_MEMORY_SAMPLING)
+  // It depends on the functions above.
+  #include "nyra_utils/sanitizer/memory_sampler.h"  // IWYU pragma: export
+#endif
@@ -0,0 +1,394 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(NYRA_ENABLE_JEMALLOC)
+  #include <jemalloc/jemalloc.h>
+#elif defined(NYRA_ENABLE_MIMALLOC)
+  #include <mimalloc.h>
+#endif
+
+#include "nyra_utils/lib/alloc.h"
+#include "nyra_utils/lib/atomic.h"
+#include "nyra_utils/macro/check.h"
+#include "nyra_utils/macro/mark.h"
+
+// The backend behind 'NYRA_MALLOC' and friends when the runtime is built with
+// 'NYRA_ENABLE_CUSTOM_ALLOCATOR' (the 'nyra_allocator' build arg). It is
+// 'nyra_malloc' by default, jemalloc or mimalloc when the build enables them,
+// or any allocator registered by 'nyra_allocator_register()'.
+//
+// On top of the backend, it could keep a small per-thread cache of the freed
+// blocks of the small size classes, which is where the message-heavy graphs
+// spend most of the allocations, and it could count the allocations by size
+// class to find out where the allocator overhead comes from.
+//
+// The allocator must be registered before anything is allocated through it,
+// and a block must be freed by the same allocator which allocated it, so do not
+// give a block allocated by 'NYRA_MALLOC' to a function of the prebuilt runtime
+// which calls 'nyra_free()' on it.
+//
+// Note: only the code compiled against these headers goes through it, ex: the
+// containers, arenas, parsers and I/O helpers of the headers, and the
+// extensions. The prebuilt runtime calls 'nyra_malloc()' directly, so its own
+// allocations (messages, values, strings) stay on the default heap.
+//
+// Note: the state is a weak symbol of the headers, so each module which does
+// not share the symbols of the others, ex: an extension loaded with
+// RTLD_LOCAL, gets an allocator of its own. An allocator registered by the app
+// is not seen by such an extension, which has to register it as well, and a
+// block allocated by 'NYRA_MALLOC' in one module must be freed by the same
+// module, since the other one might free it through a different allocator or
+// keep it in a thread cache of its own.
+
+// 16, 32, 64, ..., 4096, and the large ones.
+#define NYRA_ALLOCATOR_SIZE_CLASS_MIN_SHIFT 4
+#define NYRA_ALLOCATOR_SIZE_CLASS_CNT 10
+#define NYRA_ALLOCATOR_SIZE_CLASS_LARGE (NYRA_ALLOCATOR_SIZE_CLASS_CNT - 1)
+
+// Only the blocks up to 256 bytes are cached, and at most
+// 'NYRA_ALLOCATOR_THREAD_CACHE_DEPTH' blocks for each size class.
+#define NYRA_ALLOCATOR_THREAD_CACHE_CLASS_CNT 5
+#define NYRA_ALLOCATOR_THREAD_CACHE_DEPTH 64
+
+typedef struct nyra_allocator_t {
+  const char *name;
+
+  void *(*malloc_cb)(size_t size);
+  void *(*calloc_cb)(size_t cnt, size_t size);
+  void *(*realloc_cb)(void *p, size_t size);
+  void (*free_cb)(void *p);
+
+  // Could be NULL. Without it, the thread cache is disabled, and the frees
+  // could not be counted by size class.
+  size_t (*usable_size_cb)(void *p);
+} nyra_allocator_t;
+
+typedef struct nyra_allocator_size_class_stats_t {
+  nyra_atomic_t alloc_cnt;
+  nyra_atomic_t alloc_bytes;
+  nyra_atomic_t free_cnt;
+  nyra_atomic_t thread_cache_hit_cnt;
+} nyra_allocator_size_class_stats_t;
+
+typedef struct nyra_allocator_state_t {
+  const nyra_allocator_t *allocator;
+
+  bool thread_cache_enabled;
+  bool stats_enabled;
+
+  nyra_allocator_size_class_stats_t stats[NYRA_ALLOCATOR_SIZE_CLASS_CNT];
+} nyra_allocator_state_t;
+
+typedef struct nyra_allocator_thread_cache_t {
+  // The freed blocks are chained through their first word.
+  void *heads[NYRA_ALLOCATOR_THREAD_CACHE_CLASS_CNT];
+  uint32_t cnt[NYRA_ALLOCATOR_THREAD_CACHE_CLASS_CNT];
+} nyra_allocator_thread_cache_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+NYRA_SELECTANY nyra_allocator_state_t nyra_allocator_state;
+
+NYRA_SELECTANY NYRA_THREAD_LOCAL nyra_allocator_thread_cache_t
+    nyra_allocator_thread_cache;
+
+#ifdef __cplusplus
+}
+#endif
+
+static const nyra_allocator_t nyra_allocator_default = {
+    "default", nyra_malloc, nyra_calloc, nyra_realloc, nyra_free, NULL,
+};
+
+#if defined(NYRA_ENABLE_JEMALLOC)
+// The names are mapped to the prefixed ones by jemalloc.h if jemalloc is built
+// with a prefix.
+static const nyra_allocator_t nyra_allocator_jemalloc = {
+    "jemalloc", malloc, calloc, realloc, free,
+    (size_t (*)(void *))malloc_usable_size,
+};
+#endif
+
+#if defined(NYRA_ENABLE_MIMALLOC)
+static const nyra_allocator_t nyra_allocator_mimalloc = {
+    "mimalloc", mi_malloc, mi_calloc, mi_realloc, mi_free, mi_usable_size,
+};
+#endif
+
+/**
+ * @brief The allocator built into the runtime by the build options.
+ */
+static inline const nyra_allocator_t *nyra_allocator_get_builtin(void) {
+#if defined(NYRA_ENABLE_JEMALLOC)
+  return &nyra_allocator_jemalloc;
+#elif defined(NYRA_ENABLE_MIMALLOC)
+  return &nyra_allocator_mimalloc;
+#else
+  return &nyra_allocator_default;
+#endif
+}
+
+static inline const nyra_allocator_t *nyra_allocator_get(void) {
+  const nyra_allocator_t *allocator = nyra_allocator_state.allocator;
+  return allocator ? allocator : nyra_allocator_get_builtin();
+}
+
+/**
+ * @brief Replace the allocator. It must be called before anything is allocated
+ * through it, ex: at the very beginning of 'main()'.
+ *
+ * @param allocator NULL to restore the built-in one. It is not copied, and
+ * must outlive the program.
+ *
+ * @note It only replaces the allocator of the calling module, see the note at
+ * the top of this file.
+ */
+static inline void nyra_allocator_register(const nyra_allocator_t *allocator) {
+  if (allocator) {
+    NYRA_ASSERT(allocator->malloc_cb && allocator->calloc_cb &&
+                   allocator->realloc_cb && allocator->free_cb,
+               "Invalid argument.");
+  }
+
+  nyra_allocator_state.allocator = allocator;
+}
+
+/**
+ * @brief Enable the per-thread cache of the small blocks. It only takes effect
+ * if the allocator could tell the usable size of a block.
+ *
+ * @note The blocks cached by a thread are only reused by that thread, call
+ * 'nyra_allocator_thread_cache_flush()' before a thread exits to give them
+ * back.
+ */
+static inline void nyra_allocator_enable_thread_cache(bool enable) {
+  nyra_allocator_state.thread_cache_enabled = enable;
+}
+
+static inline void nyra_allocator_enable_stats(bool enable) {
+  nyra_allocator_state.stats_enabled = enable;
+}
+
+/**
+ * @brief The index of the smallest size class which could hold @a size bytes.
+ */
+static inline size_t nyra_allocator_size_class_of(size_t size) {
+  size_t idx = 0;
+  size_t class_size = (size_t)1 << NYRA_ALLOCATOR_SIZE_CLASS_MIN_SHIFT;
+
+  while (size > class_size && idx < NYRA_ALLOCATOR_SIZE_CLASS_LARGE) {
+    class_size <<= 1;
+    idx++;
+  }
+
+  return idx;
+}
+
+/**
+ * @brief The size of the size class @a idx, 0 for the large one.
+ */
+static inline size_t nyra_allocator_size_class_size(size_t idx) {
+  if (idx >= NYRA_ALLOCATOR_SIZE_CLASS_LARGE) {
+    return 0;
+  }
+
+  return (size_t)1 << (idx + NYRA_ALLOCATOR_SIZE_CLASS_MIN_SHIFT);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_allocator_thread_cache_is_usable_(
+    const nyra_allocator_t *allocator) {
+  return nyra_allocator_state.thread_cache_enabled &&
+         allocator->usable_size_cb;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_allocator_count_alloc_(size_t idx, size_t size) {
+  nyra_allocator_size_class_stats_t *stats = &nyra_allocator_state.stats[idx];
+
+  nyra_atomic_add_fetch(&stats->alloc_cnt, 1);
+  nyra_atomic_add_fetch(&stats->alloc_bytes, (int64_t)size);
+}
+
+static inline void *nyra_allocator_malloc(size_t size) {
+  const nyra_allocator_t *allocator = nyra_allocator_get();
+  size_t idx = nyra_allocator_size_class_of(size);
+
+  if (nyra_allocator_state.stats_enabled) {
+    nyra_allocator_count_alloc_(idx, size);
+  }
+
+  if (idx < NYRA_ALLOCATOR_THREAD_CACHE_CLASS_CNT &&
+      nyra_allocator_thread_cache_is_usable_(allocator)) {
+    nyra_allocator_thread_cache_t *cache = &nyra_allocator_thread_cache;
+
+    void *p = cache->heads[idx];
+    if (p) {
+      memcpy(&cache->heads[idx], p, sizeof(void *));
+      cache->cnt[idx]--;
+
+      if (nyra_allocator_state.stats_enabled) {
+        nyra_atomic_add_fetch(
+            &nyra_allocator_state.stats[idx].thread_cache_hit_cnt, 1);
+      }
+
+      return p;
+    }
+
+    // Allocate the whole size class, so the block could be reused for any
+    // size of the class.
+    size = nyra_allocator_size_class_size(idx);
+  }
+
+  return allocator->malloc_cb(size);
+}
+
+static inline void *nyra_allocator_calloc(size_t cnt, size_t size) {
+  const nyra_allocator_t *allocator = nyra_allocator_get();
+
+  if (nyra_allocator_thread_cache_is_usable_(allocator) && cnt &&
+      size <= SIZE_MAX / cnt) {
+    void *p = nyra_allocator_malloc(cnt * size);
+    if (p) {
+      memset(p, 0, cnt * size);
+    }
+    return p;
+  }
+
+  if (nyra_allocator_state.stats_enabled) {
+    nyra_allocator_count_alloc_(nyra_allocator_size_class_of(cnt * size),
+                                cnt * size);
+  }
+
+  return allocator->calloc_cb(cnt, size);
+}
+
+static inline void nyra_allocator_free(void *p) {
+  if (!p) {
+    return;
+  }
+
+  const nyra_allocator_t *allocator = nyra_allocator_get();
+
+  // The frees are only counted when the size of the block is known.
+  size_t usable_size = 0;
+  if (allocator->usable_size_cb) {
+    usable_size = allocator->usable_size_cb(p);
+
+    if (nyra_allocator_state.stats_enabled) {
+      size_t idx = nyra_allocator_size_class_of(usable_size);
+      nyra_atomic_add_fetch(&nyra_allocator_state.stats[idx].free_cnt, 1);
+    }
+  }
+
+  if (nyra_allocator_thread_cache_is_usable_(allocator) &&
+      usable_size >= nyra_allocator_size_class_size(0)) {
+    // The largest size class which fits in the block, so that any size of
+    // that class could be served by it.
+    size_t idx = nyra_allocator_size_class_of(usable_size);
+    if (nyra_allocator_size_class_size(idx) != usable_size) {
+      idx--;
+    }
+
+    nyra_allocator_thread_cache_t *cache = &nyra_allocator_thread_cache;
+    if (idx < NYRA_ALLOCATOR_THREAD_CACHE_CLASS_CNT &&
+        cache->cnt[idx] < NYRA_ALLOCATOR_THREAD_CACHE_DEPTH) {
+      memcpy(p, &cache->heads[idx], sizeof(void *));
+      cache->heads[idx] = p;
+      cache->cnt[idx]++;
+      return;
+    }
+  }
+
+  allocator->free_cb(p);
+}
+
+static inline void *nyra_allocator_realloc(void *p, size_t size) {
+  if (!p) {
+    return nyra_allocator_malloc(size);
+  }
+
+  const nyra_allocator_t *allocator = nyra_allocator_get();
+
+  if (nyra_allocator_state.stats_enabled) {
+    nyra_allocator_count_alloc_(nyra_allocator_size_class_of(size), size);
+  }
+
+  return allocator->realloc_cb(p, size);
+}
+
+static inline char *nyra_allocator_strdup(const char *str) {
+  if (!str) {
+    return NULL;
+  }
+
+  size_t len = strlen(str) + 1;
+  char *copy = (char *)nyra_allocator_malloc(len);
+  if (copy) {
+    memcpy(copy, str, len);
+  }
+
+  return copy;
+}
+
+/**
+ * @brief Give the blocks cached by the current thread back to the allocator.
+ */
+static inline void nyra_allocator_thread_cache_flush(void) {
+  const nyra_allocator_t *allocator = nyra_allocator_get();
+  nyra_allocator_thread_cache_t *cache = &nyra_allocator_thread_cache;
+
+  for (size_t idx = 0; idx < NYRA_ALLOCATOR_THREAD_CACHE_CLASS_CNT; ++idx) {
+    void *p = cache->heads[idx];
+    while (p) {
+      void *next = NULL;
+      memcpy(&next, p, sizeof(void *));
+      allocator->free_cb(p);
+      p = next;
+    }
+
+    cache->heads[idx] = NULL;
+    cache->cnt[idx] = 0;
+  }
+}
+
+/**
+ * @brief Get a snapshot of the statistics of the size class @a idx.
+ */
+static inline void nyra_allocator_get_stats(
+    size_t idx, nyra_allocator_size_class_stats_t *stats) {
+  NYRA_ASSERT(idx < NYRA_ALLOCATOR_SIZE_CLASS_CNT && stats,
+             "Invalid argument.");
+
+  nyra_allocator_size_class_stats_t *src = &nyra_allocator_state.stats[idx];
+
+  stats->alloc_cnt = nyra_atomic_load(&src->alloc_cnt);
+  stats->alloc_bytes = nyra_atomic_load(&src->alloc_bytes);
+  stats->free_cnt = nyra_atomic_load(&src->free_cnt);
+  stats->thread_cache_hit_cnt = nyra_atomic_load(&src->thread_cache_hit_cnt);
+}
+
+static inline void nyra_allocator_reset_stats(void) {
+  for (size_t idx = 0; idx < NYRA_ALLOCATOR_SIZE_CLASS_CNT; ++idx) {
+    nyra_allocator_size_class_stats_t *stats = &nyra_allocator_state.stats[idx];
+
+    nyra_atomic_store(&stats->alloc_cnt, 0);
+    nyra_atomic_store(&stats->alloc_bytes, 0);
+    nyra_atomic_store(&stats->free_cnt, 0);
+    nyra_atomic_store(&stats->thread_cache_hit_cnt, 0);
+  }
+}
@@ -0,0 +1,196 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nyra_utils/lib/alloc.h"
+#include "nyra_utils/lib/rc.h"
+#include "nyra_utils/lib/signature.h"
+#include "nyra_utils/macro/check.h"
+
+#define NYRA_ARENA_SIGNATURE 0x2E7D5B19A0C4F863U
+
+#define NYRA_ARENA_DEFAULT_CHUNK_SIZE 1024
+#define NYRA_ARENA_ALIGNMENT 16
+
+// A bump allocator. The memory is carved from big chunks one after another,
+// and is never freed one by one, all the chunks are freed at once when the
+// last reference of the arena is released. It turns the many small
+// allocations made while building an object, which all die together, into a
+// few big ones.
+//
+// It is not thread safe, an arena is meant to be filled by one thread at a
+// time, ex: the thread which builds a message.
+
+typedef struct nyra_arena_chunk_t {
+  struct nyra_arena_chunk_t *next;
+  size_t size;
+} nyra_arena_chunk_t;
+
+typedef struct nyra_arena_t {
+  nyra_signature_t signature;
+  nyra_rc_t ref;
+
+  // The most recent chunk is at the head.
+  nyra_arena_chunk_t *chunks;
+  uint8_t *pos;
+  uint8_t *end;
+
+  size_t chunk_size;
+
+  // The bytes which have been handed out, and the bytes allocated from the
+  // heap.
+  size_t used_size;
+  size_t reserved_size;
+} nyra_arena_t;
+
+static inline bool nyra_arena_check_integrity(nyra_arena_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  return nyra_signature_get(&self->signature) == NYRA_ARENA_SIGNATURE;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline size_t nyra_arena_chunk_header_size_(void) {
+  return (sizeof(nyra_arena_chunk_t) + NYRA_ARENA_ALIGNMENT - 1) &
+         ~(size_t)(NYRA_ARENA_ALIGNMENT - 1);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_arena_destroy_(nyra_arena_t *self) {
+  NYRA_ASSERT(self && nyra_arena_check_integrity(self), "Invalid argument.");
+
+  nyra_arena_chunk_t *chunk = self->chunks;
+  while (chunk) {
+    nyra_arena_chunk_t *next = chunk->next;
+    NYRA_FREE_(chunk);
+    chunk = next;
+  }
+
+  nyra_signature_set(&self->signature, 0);
+  NYRA_FREE_(self);
+}
+
+/**
+ * @brief Create an arena holding one reference.
+ *
+ * @param chunk_size The size of each chunk, 0 for the default one. A request
+ * bigger than a chunk gets a chunk of its own.
+ */
+static inline nyra_arena_t *nyra_arena_create(size_t chunk_size) {
+  nyra_arena_t *self = (nyra_arena_t *)NYRA_MALLOC(sizeof(nyra_arena_t));
+  NYRA_ASSERT(self, "Failed to allocate memory.");
+
+  nyra_signature_set(&self->signature, NYRA_ARENA_SIGNATURE);
+  nyra_rc_init(&self->ref, 1);
+
+  self->chunks = NULL;
+  self->pos = NULL;
+  self->end = NULL;
+  self->chunk_size = chunk_size ? chunk_size : NYRA_ARENA_DEFAULT_CHUNK_SIZE;
+  self->used_size = 0;
+  self->reserved_size = 0;
+
+  return self;
+}
+
+static inline void nyra_arena_retain(nyra_arena_t *self) {
+  NYRA_ASSERT(self && nyra_arena_check_integrity(self), "Invalid argument.");
+  nyra_rc_inc(&self->ref);
+}
+
+/**
+ * @brief Drop one reference, all the memory of the arena is freed when the
+ * last one is dropped.
+ */
+static inline void nyra_arena_release(nyra_arena_t *self) {
+  NYRA_ASSERT(self && nyra_arena_check_integrity(self), "Invalid argument.");
+  if (nyra_rc_dec(&self->ref)) {
+    nyra_arena_destroy_(self);
+  }
+}
+
+/**
+ * @brief Carve @a size bytes, aligned to 'NYRA_ARENA_ALIGNMENT', from the
+ * arena. The memory must not be freed by the caller.
+ */
+static inline void *nyra_arena_alloc(nyra_arena_t *self, size_t size) {
+  NYRA_ASSERT(self && nyra_arena_check_integrity(self), "Invalid argument.");
+
+  size_t aligned =
+      (size + NYRA_ARENA_ALIGNMENT - 1) & ~(size_t)(NYRA_ARENA_ALIGNMENT - 1);
+  if (aligned < size) {
+    return NULL;
+  }
+
+  if ((size_t)(self->end - self->pos) < aligned) {
+    size_t payload = aligned > self->chunk_size ? aligned : self->chunk_size;
+    size_t header = nyra_arena_chunk_header_size_();
+
+    nyra_arena_chunk_t *chunk =
+        (nyra_arena_chunk_t *)NYRA_MALLOC(header + payload);
+    if (!chunk) {
+      return NULL;
+    }
+
+    chunk->size = header + payload;
+    self->reserved_size += chunk->size;
+
+    if (aligned > self->chunk_size && self->chunks) {
+      // An oversized request, keep bumping in the current chunk afterwards.
+      chunk->next = self->chunks->next;
+      self->chunks->next = chunk;
+
+      self->used_size += size;
+      return (uint8_t *)chunk + header;
+    }
+
+    chunk->next = self->chunks;
+    self->chunks = chunk;
+    self->pos = (uint8_t *)chunk + header;
+    self->end = self->pos + payload;
+  }
+
+  void *p = self->pos;
+  self->pos += aligned;
+  self->used_size += size;
+
+  return p;
+}
+
+static inline char *nyra_arena_strndup(nyra_arena_t *self, const char *str,
+                                      size_t len) {
+  NYRA_ASSERT(str, "Invalid argument.");
+
+  char *copy = (char *)nyra_arena_alloc(self, len + 1);
+  if (copy) {
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+  }
+
+  return copy;
+}
+
+static inline char *nyra_arena_strdup(nyra_arena_t *self, const char *str) {
+  NYRA_ASSERT(str, "Invalid argument.");
+  return nyra_arena_strndup(self, str, strlen(str));
+}
+
+static inline size_t nyra_arena_get_used_size(nyra_arena_t *self) {
+  NYRA_ASSERT(self && nyra_arena_check_integrity(self), "Invalid argument.");
+  return self->used_size;
+}
+
+static inline size_t nyra_arena_get_reserved_size(nyra_arena_t *self) {
+  NYRA_ASSERT(self && nyra_arena_check_integrity(self), "Invalid argument.");
+  return self->reserved_size;
+}
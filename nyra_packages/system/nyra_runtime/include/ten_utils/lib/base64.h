@@ -8,9 +8,748 @@
 
 #include "nyra_utils/nyra_config.h"
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// The x86 kernels are compiled for their instruction sets with the 'target'
+// attribute and selected at runtime, so they are only built with GCC or Clang.
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+  #include <immintrin.h>
+  #define NYRA_BASE64_USE_X86
+#elif defined(__aarch64__) && defined(__ARM_NEON) && \
+    (defined(__GNUC__) || defined(__clang__))
+  #include <arm_neon.h>
+  #define NYRA_BASE64_USE_NEON
+#endif
+
+#include "nyra_utils/lib/alloc.h"
 #include "nyra_utils/lib/buf.h"
 #include "nyra_utils/lib/string.h"
+#include "nyra_utils/macro/check.h"
 
 NYRA_UTILS_API bool nyra_base64_to_string(nyra_string_t *result, nyra_buf_t *buf);
 
 NYRA_UTILS_API bool nyra_base64_from_string(nyra_string_t *str, nyra_buf_t *result);
+
+// The codec below is the standard alphabet with padding, the same as above,
+// for the large payloads which go through JSON as base64, ex: the audio of the
+// realtime extensions and the images of the vision tools. It uses SSSE3 or
+// AVX2 when the CPU has them, and NEON on ARM64, and it could work chunk by
+// chunk into a 'nyra_buf_t' with the encoder and the decoder.
+//
+// The decoding is strict: no whitespace, and the padding is required.
+
+#define NYRA_BASE64_INVALID 0xFF
+
+/**
+ * @brief The number of characters @a size bytes are encoded into.
+ */
+static inline size_t nyra_base64_encoded_size(size_t size) {
+  return (size + 2) / 3 * 4;
+}
+
+/**
+ * @brief The number of bytes @a size characters could be decoded into, at
+ * most. The padding makes it up to 2 bytes less.
+ */
+static inline size_t nyra_base64_decoded_max_size(size_t size) {
+  return (size + 3) / 4 * 3;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline const char *nyra_base64_alphabet_(void) {
+  static const char alphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  return alphabet;
+}
+
+// The 6 bits of each ASCII character, or 'NYRA_BASE64_INVALID'.
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline const uint8_t *nyra_base64_decoding_table_(void) {
+  static const uint8_t table[128] = {
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+      0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+      0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12,
+      0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24,
+      0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30,
+      0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+  };
+  return table;
+}
+
+// The 6 bits of @a c, with the 0x80 bit set if it is invalid.
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint32_t nyra_base64_decode_char_(char c) {
+  uint8_t u = (uint8_t)c;
+  return (uint32_t)(nyra_base64_decoding_table_()[u & 0x7F] | (u & 0x80));
+}
+
+#if defined(NYRA_BASE64_USE_X86)
+
+// The kernels below are the ones of Wojciech Muła's "Base64 encoding and
+// decoding with SIMD instructions": the 3 bytes of each 32-bit lane are split
+// into 4 indices with multiplications, and the characters are mapped with
+// 'pshufb' on their nibbles.
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+__attribute__((target("ssse3"))) static inline size_t
+nyra_base64_encode_ssse3_(char *dst, const uint8_t *src, size_t size) {
+  const __m128i shuffle =
+      _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+  const __m128i offsets =
+      _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+  size_t i = 0;
+
+  // 12 bytes are encoded, but 16 are loaded.
+  while (size - i >= 16) {
+    __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+    in = _mm_shuffle_epi8(in, shuffle);
+
+    __m128i ac = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)),
+                                 _mm_set1_epi32(0x04000040));
+    __m128i bd = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)),
+                                 _mm_set1_epi32(0x01000010));
+    __m128i indices = _mm_or_si128(ac, bd);
+
+    // 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12.
+    __m128i reduced = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    reduced = _mm_or_si128(reduced, _mm_and_si128(upper, _mm_set1_epi8(13)));
+
+    __m128i out =
+        _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, reduced));
+    _mm_storeu_si128((__m128i *)dst, out);
+
+    i += 12;
+    dst += 16;
+  }
+
+  return i;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+__attribute__((target("avx2"))) static inline size_t nyra_base64_encode_avx2_(
+    char *dst, const uint8_t *src, size_t size) {
+  const __m256i shuffle = _mm256_setr_epi8(
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5,
+      4, 7, 6, 8, 7, 10, 9, 11, 10);
+  const __m256i offsets = _mm256_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+  size_t i = 0;
+
+  // 24 bytes are encoded, 12 in each lane, but 28 are loaded.
+  while (size - i >= 28) {
+    __m256i in = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(src + i))),
+        _mm_loadu_si128((const __m128i *)(src + i + 12)), 1);
+    in = _mm256_shuffle_epi8(in, shuffle);
+
+    __m256i ac =
+        _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00)),
+                           _mm256_set1_epi32(0x04000040));
+    __m256i bd =
+        _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0)),
+                           _mm256_set1_epi32(0x01000010));
+    __m256i indices = _mm256_or_si256(ac, bd);
+
+    __m256i reduced = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    reduced =
+        _mm256_or_si256(reduced, _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+
+    __m256i out =
+        _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, reduced));
+    _mm256_storeu_si256((__m256i *)dst, out);
+
+    i += 24;
+    dst += 32;
+  }
+
+  return i;
+}
+
+// The invalid characters, including '=', stop the kernels, the scalar code
+// takes over from the block which has them.
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+__attribute__((target("ssse3"))) static inline size_t
+nyra_base64_decode_ssse3_(uint8_t *dst, const char *src, size_t size) {
+  const __m128i lut_lo =
+      _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                    0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  const __m128i lut_hi =
+      _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10,
+                    0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m128i lut_roll =
+      _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i mask_2f = _mm_set1_epi8(0x2F);
+  const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                     -1, -1, -1, -1);
+
+  size_t i = 0;
+
+  // 16 characters are decoded into 12 bytes, but 16 are stored, so there are
+  // at least 4 more characters to go.
+  while (size - i >= 20) {
+    __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+
+    __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask_2f);
+    __m128i lo_nibbles = _mm_and_si128(in, mask_2f);
+    __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+    __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+    if (_mm_movemask_epi8(
+            _mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128()))) {
+      break;
+    }
+
+    __m128i eq_2f = _mm_cmpeq_epi8(in, mask_2f);
+    __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+    __m128i values = _mm_add_epi8(in, roll);
+
+    __m128i merged =
+        _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+    _mm_storeu_si128((__m128i *)dst, _mm_shuffle_epi8(merged, pack));
+
+    i += 16;
+    dst += 12;
+  }
+
+  return i;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+__attribute__((target("avx2"))) static inline size_t nyra_base64_decode_avx2_(
+    uint8_t *dst, const char *src, size_t size) {
+  const __m256i lut_lo = _mm256_setr_epi8(
+      0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A,
+      0x1B, 0x1B, 0x1B, 0x1A, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+      0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+  const __m256i lut_hi = _mm256_setr_epi8(
+      0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m256i lut_roll = _mm256_setr_epi8(
+      0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4,
+      -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i mask_2f = _mm256_set1_epi8(0x2F);
+  const __m256i pack = _mm256_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4,
+      10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+  size_t i = 0;
+
+  // 32 characters are decoded into 24 bytes, but 32 are stored, so there are
+  // at least 12 more characters to go.
+  while (size - i >= 44) {
+    __m256i in = _mm256_loadu_si256((const __m256i *)(src + i));
+
+    __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask_2f);
+    __m256i lo_nibbles = _mm256_and_si256(in, mask_2f);
+    __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+    __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+    if (!_mm256_testz_si256(lo, hi)) {
+      break;
+    }
+
+    __m256i eq_2f = _mm256_cmpeq_epi8(in, mask_2f);
+    __m256i roll =
+        _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+    __m256i values = _mm256_add_epi8(in, roll);
+
+    __m256i merged =
+        _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    merged = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+    merged = _mm256_shuffle_epi8(merged, pack);
+    merged = _mm256_permutevar8x32_epi32(
+        merged, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+    _mm256_storeu_si256((__m256i *)dst, merged);
+
+    i += 32;
+    dst += 24;
+  }
+
+  return i;
+}
+
+#elif defined(NYRA_BASE64_USE_NEON)
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline size_t nyra_base64_encode_neon_(char *dst, const uint8_t *src,
+                                              size_t size) {
+  const uint8_t *alphabet = (const uint8_t *)nyra_base64_alphabet_();
+  uint8x16x4_t table;
+  table.val[0] = vld1q_u8(alphabet);
+  table.val[1] = vld1q_u8(alphabet + 16);
+  table.val[2] = vld1q_u8(alphabet + 32);
+  table.val[3] = vld1q_u8(alphabet + 48);
+
+  const uint8x16_t mask_3f = vdupq_n_u8(0x3F);
+
+  size_t i = 0;
+
+  while (size - i >= 48) {
+    uint8x16x3_t in = vld3q_u8(src + i);
+
+    uint8x16x4_t out;
+    out.val[0] = vshrq_n_u8(in.val[0], 2);
+    out.val[1] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), mask_3f);
+    out.val[2] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), mask_3f);
+    out.val[3] = vandq_u8(in.val[2], mask_3f);
+
+    out.val[0] = vqtbl4q_u8(table, out.val[0]);
+    out.val[1] = vqtbl4q_u8(table, out.val[1]);
+    out.val[2] = vqtbl4q_u8(table, out.val[2]);
+    out.val[3] = vqtbl4q_u8(table, out.val[3]);
+    vst4q_u8((uint8_t *)dst, out);
+
+    i += 48;
+    dst += 64;
+  }
+
+  return i;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint8x16_t nyra_base64_decode_neon_lookup_(uint8x16x4_t lo,
+                                                         uint8x16x4_t hi,
+                                                         uint8x16_t in) {
+  // The indices out of range are looked up as 0, so each character is only
+  // found in one of the halves, and in none if it is not ASCII.
+  return vorrq_u8(vqtbl4q_u8(lo, in),
+                  vqtbl4q_u8(hi, veorq_u8(in, vdupq_n_u8(0x40))));
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline size_t nyra_base64_decode_neon_(uint8_t *dst, const char *src,
+                                              size_t size) {
+  const uint8_t *decoding = nyra_base64_decoding_table_();
+  uint8x16x4_t lo;
+  uint8x16x4_t hi;
+  for (int k = 0; k < 4; k++) {
+    lo.val[k] = vld1q_u8(decoding + k * 16);
+    hi.val[k] = vld1q_u8(decoding + 64 + k * 16);
+  }
+
+  size_t i = 0;
+
+  while (size - i >= 64) {
+    uint8x16x4_t in = vld4q_u8((const uint8_t *)src + i);
+
+    uint8x16_t a = nyra_base64_decode_neon_lookup_(lo, hi, in.val[0]);
+    uint8x16_t b = nyra_base64_decode_neon_lookup_(lo, hi, in.val[1]);
+    uint8x16_t c = nyra_base64_decode_neon_lookup_(lo, hi, in.val[2]);
+    uint8x16_t d = nyra_base64_decode_neon_lookup_(lo, hi, in.val[3]);
+
+    uint8x16_t invalid =
+        vorrq_u8(vorrq_u8(vorrq_u8(a, b), vorrq_u8(c, d)),
+                 vorrq_u8(vorrq_u8(in.val[0], in.val[1]),
+                          vorrq_u8(in.val[2], in.val[3])));
+    if (vmaxvq_u8(invalid) & 0x80) {
+      break;
+    }
+
+    uint8x16x3_t out;
+    out.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+    out.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(c, 2));
+    out.val[2] = vorrq_u8(vshlq_n_u8(c, 6), d);
+    vst3q_u8(dst, out);
+
+    i += 64;
+    dst += 48;
+  }
+
+  return i;
+}
+
+#endif
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline size_t nyra_base64_encode_simd_(char *dst, const uint8_t *src,
+                                              size_t size) {
+#if defined(NYRA_BASE64_USE_X86)
+  if (size >= 32) {
+    if (__builtin_cpu_supports("avx2")) {
+      return nyra_base64_encode_avx2_(dst, src, size);
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+      return nyra_base64_encode_ssse3_(dst, src, size);
+    }
+  }
+#elif defined(NYRA_BASE64_USE_NEON)
+  return nyra_base64_encode_neon_(dst, src, size);
+#endif
+  (void)dst;
+  (void)src;
+  (void)size;
+  return 0;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline size_t nyra_base64_decode_simd_(uint8_t *dst, const char *src,
+                                              size_t size) {
+#if defined(NYRA_BASE64_USE_X86)
+  if (size >= 32) {
+    if (__builtin_cpu_supports("avx2")) {
+      return nyra_base64_decode_avx2_(dst, src, size);
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+      return nyra_base64_decode_ssse3_(dst, src, size);
+    }
+  }
+#elif defined(NYRA_BASE64_USE_NEON)
+  return nyra_base64_decode_neon_(dst, src, size);
+#endif
+  (void)dst;
+  (void)src;
+  (void)size;
+  return 0;
+}
+
+/**
+ * @brief Encode @a size bytes of @a src into @a dst, which must have room for
+ * 'nyra_base64_encoded_size(size)' characters. No null terminator is written.
+ *
+ * @return The number of characters written.
+ */
+static inline size_t nyra_base64_encode(char *dst, const uint8_t *src,
+                                        size_t size) {
+  NYRA_ASSERT(dst || !size, "Invalid argument.");
+  NYRA_ASSERT(src || !size, "Invalid argument.");
+
+  const char *alphabet = nyra_base64_alphabet_();
+
+  size_t i = nyra_base64_encode_simd_(dst, src, size);
+  char *out = dst + i / 3 * 4;
+
+  for (; size - i >= 3; i += 3) {
+    uint32_t v = ((uint32_t)src[i] << 16) | ((uint32_t)src[i + 1] << 8) |
+                 src[i + 2];
+    out[0] = alphabet[v >> 18];
+    out[1] = alphabet[(v >> 12) & 0x3F];
+    out[2] = alphabet[(v >> 6) & 0x3F];
+    out[3] = alphabet[v & 0x3F];
+    out += 4;
+  }
+
+  if (size - i == 1) {
+    uint32_t v = (uint32_t)src[i] << 16;
+    out[0] = alphabet[v >> 18];
+    out[1] = alphabet[(v >> 12) & 0x3F];
+    out[2] = '=';
+    out[3] = '=';
+    out += 4;
+  } else if (size - i == 2) {
+    uint32_t v = ((uint32_t)src[i] << 16) | ((uint32_t)src[i + 1] << 8);
+    out[0] = alphabet[v >> 18];
+    out[1] = alphabet[(v >> 12) & 0x3F];
+    out[2] = alphabet[(v >> 6) & 0x3F];
+    out[3] = '=';
+    out += 4;
+  }
+
+  return (size_t)(out - dst);
+}
+
+/**
+ * @brief Decode @a size characters of @a src into @a dst, which must have
+ * room for 'nyra_base64_decoded_max_size(size)' bytes.
+ *
+ * @return false if @a src is not base64, ex: its size is not a multiple of 4,
+ * or it has whitespace or any padding before the last 4 characters. The
+ * content of @a dst is undefined then.
+ */
+static inline bool nyra_base64_decode(uint8_t *dst, size_t *dst_size,
+                                      const char *src, size_t size) {
+  NYRA_ASSERT(dst_size, "Invalid argument.");
+  NYRA_ASSERT(dst || !size, "Invalid argument.");
+  NYRA_ASSERT(src || !size, "Invalid argument.");
+
+  *dst_size = 0;
+
+  if (size % 4) {
+    return false;
+  }
+  if (!size) {
+    return true;
+  }
+
+  // The last 4 characters could have the padding.
+  size_t body = size - 4;
+
+  size_t i = nyra_base64_decode_simd_(dst, src, body);
+  uint8_t *out = dst + i / 4 * 3;
+
+  for (; i < body; i += 4) {
+    uint32_t a = nyra_base64_decode_char_(src[i]);
+    uint32_t b = nyra_base64_decode_char_(src[i + 1]);
+    uint32_t c = nyra_base64_decode_char_(src[i + 2]);
+    uint32_t d = nyra_base64_decode_char_(src[i + 3]);
+    if ((a | b | c | d) & 0x80) {
+      return false;
+    }
+
+    uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+    out[0] = (uint8_t)(v >> 16);
+    out[1] = (uint8_t)(v >> 8);
+    out[2] = (uint8_t)v;
+    out += 3;
+  }
+
+  const char *last = src + body;
+  size_t padding = last[3] == '=' ? (last[2] == '=' ? 2 : 1) : 0;
+
+  uint32_t a = nyra_base64_decode_char_(last[0]);
+  uint32_t b = nyra_base64_decode_char_(last[1]);
+  uint32_t c = padding < 2 ? nyra_base64_decode_char_(last[2]) : 0;
+  uint32_t d = padding < 1 ? nyra_base64_decode_char_(last[3]) : 0;
+  if ((a | b | c | d) & 0x80) {
+    return false;
+  }
+
+  uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+
+  out[0] = (uint8_t)(v >> 16);
+  if (padding < 2) {
+    out[1] = (uint8_t)(v >> 8);
+  }
+  if (padding < 1) {
+    out[2] = (uint8_t)v;
+  }
+  out += 3 - padding;
+
+  *dst_size = (size_t)(out - dst);
+  return true;
+}
+
+// Make room for @a size more bytes after the content of @a buf.
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint8_t *nyra_base64_buf_reserve_(nyra_buf_t *buf, size_t size) {
+  if (buf->size - buf->content_size >= size) {
+    return buf->data + buf->content_size;
+  }
+  if (!buf->owns_memory || buf->is_fixed_size) {
+    return NULL;
+  }
+
+  size_t new_size = buf->size * 2;
+  if (new_size < buf->content_size + size) {
+    new_size = buf->content_size + size;
+  }
+
+  uint8_t *data = (uint8_t *)(buf->data ? nyra_realloc(buf->data, new_size)
+                                        : nyra_malloc(new_size));
+  if (!data) {
+    return NULL;
+  }
+
+  buf->data = data;
+  buf->size = new_size;
+  return buf->data + buf->content_size;
+}
+
+typedef struct nyra_base64_encoder_t {
+  // The bytes which do not fill a group of 3 yet.
+  uint8_t pending[3];
+  size_t pending_size;
+} nyra_base64_encoder_t;
+
+static inline void nyra_base64_encoder_init(nyra_base64_encoder_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  self->pending_size = 0;
+}
+
+/**
+ * @brief Append the encoding of the next @a size bytes of the stream to
+ * @a out, the bytes which do not fill a group of 3 are kept for the next call.
+ *
+ * @return false if @a out could not grow.
+ */
+static inline bool nyra_base64_encoder_update(nyra_base64_encoder_t *self,
+                                              nyra_buf_t *out,
+                                              const uint8_t *data,
+                                              size_t size) {
+  NYRA_ASSERT(self && out && nyra_buf_check_integrity(out),
+             "Invalid argument.");
+  NYRA_ASSERT(data || !size, "Invalid argument.");
+
+  size_t total = self->pending_size + size;
+  if (total < 3) {
+    memcpy(self->pending + self->pending_size, data, size);
+    self->pending_size = total;
+    return true;
+  }
+
+  uint8_t *dst = nyra_base64_buf_reserve_(out, total / 3 * 4);
+  if (!dst) {
+    return false;
+  }
+
+  if (self->pending_size && total >= 3) {
+    size_t taken = 3 - self->pending_size;
+    memcpy(self->pending + self->pending_size, data, taken);
+    dst += nyra_base64_encode((char *)dst, self->pending, 3);
+    data += taken;
+    size -= taken;
+    self->pending_size = 0;
+  }
+
+  if (!self->pending_size) {
+    size_t whole = size / 3 * 3;
+    dst += nyra_base64_encode((char *)dst, data, whole);
+    data += whole;
+    size -= whole;
+  }
+
+  memcpy(self->pending + self->pending_size, data, size);
+  self->pending_size += size;
+
+  out->content_size = (size_t)(dst - out->data);
+  return true;
+}
+
+/**
+ * @brief Append the encoding of the end of the stream, with the padding, to
+ * @a out. The encoder could be used for another stream then.
+ */
+static inline bool nyra_base64_encoder_finish(nyra_base64_encoder_t *self,
+                                              nyra_buf_t *out) {
+  NYRA_ASSERT(self && out && nyra_buf_check_integrity(out),
+             "Invalid argument.");
+
+  if (!self->pending_size) {
+    return true;
+  }
+
+  uint8_t *dst = nyra_base64_buf_reserve_(out, 4);
+  if (!dst) {
+    return false;
+  }
+
+  out->content_size +=
+      nyra_base64_encode((char *)dst, self->pending, self->pending_size);
+  self->pending_size = 0;
+  return true;
+}
+
+typedef struct nyra_base64_decoder_t {
+  // The characters which do not fill a group of 4 yet.
+  char pending[4];
+  size_t pending_size;
+
+  // Nothing could follow the padding.
+  bool padded;
+} nyra_base64_decoder_t;
+
+static inline void nyra_base64_decoder_init(nyra_base64_decoder_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  self->pending_size = 0;
+  self->padded = false;
+}
+
+/**
+ * @brief Append the decoding of the next @a size characters of the stream to
+ * @a out, the characters which do not fill a group of 4 are kept for the next
+ * call.
+ *
+ * @return false if the stream is not base64 or @a out could not grow.
+ */
+static inline bool nyra_base64_decoder_update(nyra_base64_decoder_t *self,
+                                              nyra_buf_t *out,
+                                              const char *data, size_t size) {
+  NYRA_ASSERT(self && out && nyra_buf_check_integrity(out),
+             "Invalid argument.");
+  NYRA_ASSERT(data || !size, "Invalid argument.");
+
+  if (!size) {
+    return true;
+  }
+  if (self->padded) {
+    return false;
+  }
+
+  size_t total = self->pending_size + size;
+  if (total < 4) {
+    memcpy(self->pending + self->pending_size, data, size);
+    self->pending_size = total;
+    return true;
+  }
+
+  uint8_t *dst = nyra_base64_buf_reserve_(out, total / 4 * 3);
+  if (!dst) {
+    return false;
+  }
+
+  size_t decoded = 0;
+
+  if (self->pending_size && total >= 4) {
+    size_t taken = 4 - self->pending_size;
+    memcpy(self->pending + self->pending_size, data, taken);
+    if (!nyra_base64_decode(dst, &decoded, self->pending, 4)) {
+      return false;
+    }
+    dst += decoded;
+    data += taken;
+    size -= taken;
+    self->pending_size = 0;
+    self->padded = decoded < 3;
+  }
+
+  if (!self->pending_size) {
+    size_t whole = size / 4 * 4;
+    if (whole && self->padded) {
+      return false;
+    }
+    if (!nyra_base64_decode(dst, &decoded, data, whole)) {
+      return false;
+    }
+    dst += decoded;
+    data += whole;
+    size -= whole;
+    if (whole && decoded < whole / 4 * 3) {
+      self->padded = true;
+    }
+  }
+
+  if (size && self->padded) {
+    return false;
+  }
+
+  memcpy(self->pending + self->pending_size, data, size);
+  self->pending_size += size;
+
+  out->content_size = (size_t)(dst - out->data);
+  return true;
+}
+
+/**
+ * @brief Check the end of the stream. The decoder could be used for another
+ * stream then.
+ *
+ * @return false if the stream is truncated, i.e. its size is not a multiple of
+ * 4.
+ */
+static inline bool nyra_base64_decoder_finish(nyra_base64_decoder_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  bool complete = self->pending_size == 0;
+  nyra_base64_decoder_init(self);
+  return complete;
+}
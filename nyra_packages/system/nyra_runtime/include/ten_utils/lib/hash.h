@@ -0,0 +1,219 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+  #include <intrin.h>
+#endif
+
+#include "nyra_utils/lib/random.h"
+#include "nyra_utils/lib/thread_once.h"
+#include "nyra_utils/macro/check.h"
+#include "nyra_utils/macro/mark.h"
+
+// A high throughput 64-bit hash of the wyhash family, for the hash tables which
+// could be fed with keys coming from the outside, ex: the property names or the
+// command names received by a protocol. 'nyra_hash_function()' of the prebuilt
+// runtime is a fixed function, so anyone knowing it could craft keys which all
+// fall into the same bucket. Here, every hash is keyed by a seed, and the
+// default seed is randomized once per process.
+//
+// Set 'NYRA_HASH_SEED' in the environment to fix the default seed, ex: to
+// reproduce a bucket distribution while debugging.
+
+#define NYRA_HASH_SECRET0 0x2D358DCCAA6C78A5ULL
+#define NYRA_HASH_SECRET1 0x8BB84B93962EACC9ULL
+#define NYRA_HASH_SECRET2 0x4B33A62ED433D4A3ULL
+#define NYRA_HASH_SECRET3 0x4D5A2DA51DE1AA47ULL
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+NYRA_SELECTANY uint64_t nyra_hash_default_seed;
+
+NYRA_SELECTANY nyra_thread_once_t nyra_hash_default_seed_once =
+    NYRA_THREAD_ONCE_INIT;
+
+#ifdef __cplusplus
+}
+#endif
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_hash_mum_(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t r = (__uint128_t)*a * *b;
+  *a = (uint64_t)r;
+  *b = (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+  *a = _umul128(*a, *b, b);
+#else
+  uint64_t ha = *a >> 32;
+  uint64_t hb = *b >> 32;
+  uint64_t la = (uint32_t)*a;
+  uint64_t lb = (uint32_t)*b;
+  uint64_t rh = ha * hb;
+  uint64_t rm0 = ha * lb;
+  uint64_t rm1 = hb * la;
+  uint64_t rl = la * lb;
+  uint64_t t = rl + (rm0 << 32);
+  uint64_t c = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  *a = lo;
+  *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint64_t nyra_hash_mix_(uint64_t a, uint64_t b) {
+  nyra_hash_mum_(&a, &b);
+  return a ^ b;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint64_t nyra_hash_read8_(const uint8_t *p) {
+  uint64_t v = 0;
+  memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap64(v);
+#endif
+  return v;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint64_t nyra_hash_read4_(const uint8_t *p) {
+  uint32_t v = 0;
+  memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap32(v);
+#endif
+  return v;
+}
+
+/**
+ * @brief Hash @a len bytes of @a key with @a seed.
+ */
+static inline uint64_t nyra_hash_bytes_with_seed(const void *key, size_t len,
+                                                uint64_t seed) {
+  NYRA_ASSERT(key || !len, "Invalid argument.");
+
+  const uint8_t *p = (const uint8_t *)key;
+  uint64_t a = 0;
+  uint64_t b = 0;
+
+  seed ^= nyra_hash_mix_(seed ^ NYRA_HASH_SECRET0, NYRA_HASH_SECRET1);
+
+  if (LIKELY(len <= 16)) {
+    if (LIKELY(len >= 4)) {
+      size_t mid = (len >> 3) << 2;
+      a = (nyra_hash_read4_(p) << 32) | nyra_hash_read4_(p + mid);
+      b = (nyra_hash_read4_(p + len - 4) << 32) |
+          nyra_hash_read4_(p + len - 4 - mid);
+    } else if (len > 0) {
+      a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+    }
+  } else {
+    size_t i = len;
+
+    if (UNLIKELY(i >= 48)) {
+      uint64_t see1 = seed;
+      uint64_t see2 = seed;
+      do {
+        seed = nyra_hash_mix_(nyra_hash_read8_(p) ^ NYRA_HASH_SECRET1,
+                              nyra_hash_read8_(p + 8) ^ seed);
+        see1 = nyra_hash_mix_(nyra_hash_read8_(p + 16) ^ NYRA_HASH_SECRET2,
+                              nyra_hash_read8_(p + 24) ^ see1);
+        see2 = nyra_hash_mix_(nyra_hash_read8_(p + 32) ^ NYRA_HASH_SECRET3,
+                              nyra_hash_read8_(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i >= 48);
+      seed ^= see1 ^ see2;
+    }
+
+    while (i > 16) {
+      seed = nyra_hash_mix_(nyra_hash_read8_(p) ^ NYRA_HASH_SECRET1,
+                            nyra_hash_read8_(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+
+    a = nyra_hash_read8_(p + i - 16);
+    b = nyra_hash_read8_(p + i - 8);
+  }
+
+  a ^= NYRA_HASH_SECRET1;
+  b ^= seed;
+  nyra_hash_mum_(&a, &b);
+
+  return nyra_hash_mix_(a ^ NYRA_HASH_SECRET0 ^ len, b ^ NYRA_HASH_SECRET1);
+}
+
+/**
+ * @brief The fast path for the integer and pointer keys, without the length
+ * dispatch and the loads of the byte path.
+ */
+static inline uint64_t nyra_hash_u64_with_seed(uint64_t key, uint64_t seed) {
+  uint64_t a = key ^ NYRA_HASH_SECRET0;
+  uint64_t b = seed ^ NYRA_HASH_SECRET1;
+  nyra_hash_mum_(&a, &b);
+  return nyra_hash_mix_(a ^ NYRA_HASH_SECRET0, b ^ NYRA_HASH_SECRET1);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_hash_default_seed_init_(void) {
+  const char *env = getenv("NYRA_HASH_SEED");
+  if (env && *env) {
+    nyra_hash_default_seed = strtoull(env, NULL, 0);
+    return;
+  }
+
+  uint64_t seed = 0;
+  if (nyra_random(&seed, sizeof(seed)) != 0 || !seed) {
+    // Better than a fixed seed, as the address is randomized by ASLR.
+    seed = nyra_hash_u64_with_seed(
+        (uint64_t)(uintptr_t)&seed,
+        (uint64_t)(uintptr_t)&nyra_hash_default_seed);
+  }
+
+  nyra_hash_default_seed = seed;
+}
+
+/**
+ * @brief The seed of this process. It is randomized on the first call, so a
+ * table should fetch it once, ex: when it is created, rather than on every
+ * hash.
+ */
+static inline uint64_t nyra_hash_get_default_seed(void) {
+  nyra_thread_once(&nyra_hash_default_seed_once, nyra_hash_default_seed_init_);
+  return nyra_hash_default_seed;
+}
+
+static inline uint64_t nyra_hash_bytes(const void *key, size_t len) {
+  return nyra_hash_bytes_with_seed(key, len, nyra_hash_get_default_seed());
+}
+
+static inline uint64_t nyra_hash_string(const char *str) {
+  NYRA_ASSERT(str, "Invalid argument.");
+  return nyra_hash_bytes(str, strlen(str));
+}
+
+static inline uint64_t nyra_hash_u64(uint64_t key) {
+  return nyra_hash_u64_with_seed(key, nyra_hash_get_default_seed());
+}
+
+static inline uint64_t nyra_hash_ptr(const void *ptr) {
+  return nyra_hash_u64((uint64_t)(uintptr_t)ptr);
+}
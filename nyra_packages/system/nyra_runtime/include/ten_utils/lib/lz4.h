@@ -0,0 +1,351 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nyra_utils/macro/check.h"
+
+// A small, header-only codec producing the LZ4 block format
+// (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md).
+//
+// Both sides may share a dictionary. The dictionary is treated as if it were
+// the data right before the block, so short messages which repeat the same
+// property keys and message names as the dictionary still get matches. Only the
+// last 64KB of the dictionary is reachable by an LZ4 offset, so any bytes
+// before that are ignored. A dictionary which is used for many blocks should be
+// prepared once with 'nyra_lz4_dict_init()', so it is not hashed again for each
+// of them.
+
+#define NYRA_LZ4_MIN_MATCH 4
+#define NYRA_LZ4_MAX_OFFSET 65535
+#define NYRA_LZ4_HASH_LOG 12
+
+// The last match must start at least 12 bytes before the end of the block, and
+// the last 5 bytes of the block are always literals.
+#define NYRA_LZ4_MF_LIMIT 12
+#define NYRA_LZ4_LAST_LITERALS 5
+
+typedef struct nyra_lz4_dict_t {
+  // The last 'NYRA_LZ4_MAX_OFFSET' bytes at most, not owned.
+  const uint8_t *data;
+  size_t len;
+
+  // The last position of each hash in the dictionary, or UINT32_MAX.
+  uint32_t table[1 << NYRA_LZ4_HASH_LOG];
+} nyra_lz4_dict_t;
+
+/**
+ * @brief The worst-case size of the compressed output of @a src_len bytes.
+ */
+static inline size_t nyra_lz4_compress_bound(size_t src_len) {
+  return src_len + (src_len / 255) + 16;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint8_t nyra_lz4_byte_at_(const uint8_t *dict, size_t dict_len,
+                                       const uint8_t *src, size_t pos) {
+  return pos < dict_len ? dict[pos] : src[pos - dict_len];
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint32_t nyra_lz4_read32_(const uint8_t *dict, size_t dict_len,
+                                       const uint8_t *src, size_t pos) {
+  uint32_t value = 0;
+
+  if (pos >= dict_len) {
+    memcpy(&value, src + (pos - dict_len), sizeof(value));
+  } else if (pos + sizeof(value) <= dict_len) {
+    memcpy(&value, dict + pos, sizeof(value));
+  } else {
+    // The 4 bytes straddle the boundary between the dictionary and the source.
+    uint8_t bytes[4];
+    for (size_t i = 0; i < sizeof(bytes); ++i) {
+      bytes[i] = nyra_lz4_byte_at_(dict, dict_len, src, pos + i);
+    }
+    memcpy(&value, bytes, sizeof(value));
+  }
+
+  return value;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint32_t nyra_lz4_hash_(uint32_t sequence) {
+  return (sequence * 2654435761U) >> (32 - NYRA_LZ4_HASH_LOG);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint8_t *nyra_lz4_write_length_(uint8_t *op, size_t len) {
+  while (len >= 255) {
+    *op++ = 255;
+    len -= 255;
+  }
+  *op++ = (uint8_t)len;
+  return op;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint8_t *nyra_lz4_write_sequence_(uint8_t *op, uint8_t *op_end,
+                                               const uint8_t *literals,
+                                               size_t literal_len,
+                                               size_t offset,
+                                               size_t match_len) {
+  // Worst case: token + literal length + literals + offset + match length.
+  size_t needed =
+      1 + (literal_len / 255 + 1) + literal_len + 2 + (match_len / 255 + 1);
+  if ((size_t)(op_end - op) < needed) {
+    return NULL;
+  }
+
+  uint8_t *token = op++;
+  *token = (uint8_t)((literal_len < 15 ? literal_len : 15) << 4);
+  if (literal_len >= 15) {
+    op = nyra_lz4_write_length_(op, literal_len - 15);
+  }
+
+  memcpy(op, literals, literal_len);
+  op += literal_len;
+
+  if (match_len == 0 && offset == 0) {
+    // The last sequence only contains literals.
+    return op;
+  }
+
+  *op++ = (uint8_t)(offset & 0xFF);
+  *op++ = (uint8_t)(offset >> 8);
+
+  size_t ml = match_len - NYRA_LZ4_MIN_MATCH;
+  *token |= (uint8_t)(ml < 15 ? ml : 15);
+  if (ml >= 15) {
+    op = nyra_lz4_write_length_(op, ml - 15);
+  }
+
+  return op;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_lz4_hash_dict_(const uint8_t *dict, size_t dict_len,
+                                      uint32_t *table) {
+  memset(table, 0xFF, sizeof(uint32_t) << NYRA_LZ4_HASH_LOG);
+
+  for (size_t pos = 0; pos + NYRA_LZ4_MIN_MATCH <= dict_len; ++pos) {
+    uint32_t sequence = 0;
+    memcpy(&sequence, dict + pos, sizeof(sequence));
+    table[nyra_lz4_hash_(sequence)] = (uint32_t)pos;
+  }
+}
+
+/**
+ * @brief Prepare @a dict to be shared by the blocks compressed with
+ * 'nyra_lz4_compress_with_dict()'. @a dict is not copied, so it must outlive
+ * @a self.
+ */
+static inline void nyra_lz4_dict_init(nyra_lz4_dict_t *self,
+                                     const uint8_t *dict, size_t dict_len) {
+  NYRA_ASSERT(self && (dict || !dict_len), "Invalid argument.");
+
+  if (dict_len > NYRA_LZ4_MAX_OFFSET) {
+    dict += dict_len - NYRA_LZ4_MAX_OFFSET;
+    dict_len = NYRA_LZ4_MAX_OFFSET;
+  }
+
+  self->data = dict;
+  self->len = dict_len;
+  nyra_lz4_hash_dict_(dict, dict_len, self->table);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline size_t nyra_lz4_compress_with_table_(const uint8_t *src,
+                                                  size_t src_len, uint8_t *dst,
+                                                  size_t dst_cap,
+                                                  const uint8_t *dict,
+                                                  size_t dict_len,
+                                                  uint32_t *table) {
+  // Positions are 'virtual' ones, the dictionary occupies [0, dict_len), and
+  // the source occupies [dict_len, dict_len + src_len). 'table' contains the
+  // positions in the dictionary when this is called.
+  size_t total = dict_len + src_len;
+  size_t anchor = dict_len;
+  size_t ip = dict_len;
+  size_t match_limit = src_len > NYRA_LZ4_MF_LIMIT ? total - NYRA_LZ4_MF_LIMIT
+                                                   : dict_len;
+  size_t match_end_limit = total - NYRA_LZ4_LAST_LITERALS;
+
+  uint8_t *op = dst;
+  uint8_t *op_end = dst + dst_cap;
+
+  while (ip < match_limit) {
+    uint32_t sequence = nyra_lz4_read32_(dict, dict_len, src, ip);
+    uint32_t hash = nyra_lz4_hash_(sequence);
+    uint32_t ref = table[hash];
+    table[hash] = (uint32_t)ip;
+
+    if (ref == UINT32_MAX || ip - ref > NYRA_LZ4_MAX_OFFSET ||
+        nyra_lz4_read32_(dict, dict_len, src, ref) != sequence) {
+      ++ip;
+      continue;
+    }
+
+    size_t match_len = NYRA_LZ4_MIN_MATCH;
+    while (ip + match_len < match_end_limit &&
+           nyra_lz4_byte_at_(dict, dict_len, src, ref + match_len) ==
+               src[ip + match_len - dict_len]) {
+      ++match_len;
+    }
+
+    op = nyra_lz4_write_sequence_(op, op_end, src + (anchor - dict_len),
+                                  ip - anchor, ip - ref, match_len);
+    if (!op) {
+      return 0;
+    }
+
+    ip += match_len;
+    anchor = ip;
+  }
+
+  op = nyra_lz4_write_sequence_(op, op_end, src + (anchor - dict_len),
+                                total - anchor, 0, 0);
+  if (!op) {
+    return 0;
+  }
+
+  return (size_t)(op - dst);
+}
+
+/**
+ * @brief Compress @a src into @a dst in the LZ4 block format.
+ *
+ * @param dict The shared dictionary, could be NULL.
+ *
+ * @return The size of the compressed data, or 0 if @a dst is too small.
+ */
+static inline size_t nyra_lz4_compress(const uint8_t *src, size_t src_len,
+                                      uint8_t *dst, size_t dst_cap,
+                                      const uint8_t *dict, size_t dict_len) {
+  NYRA_ASSERT((src || !src_len) && dst && (dict || !dict_len),
+             "Invalid argument.");
+
+  if (dict_len > NYRA_LZ4_MAX_OFFSET) {
+    dict += dict_len - NYRA_LZ4_MAX_OFFSET;
+    dict_len = NYRA_LZ4_MAX_OFFSET;
+  }
+
+  uint32_t table[1 << NYRA_LZ4_HASH_LOG];
+  nyra_lz4_hash_dict_(dict, dict_len, table);
+
+  return nyra_lz4_compress_with_table_(src, src_len, dst, dst_cap, dict,
+                                       dict_len, table);
+}
+
+/**
+ * @brief Same as 'nyra_lz4_compress()', with a dictionary prepared by
+ * 'nyra_lz4_dict_init()', only its table is copied for each block.
+ */
+static inline size_t nyra_lz4_compress_with_dict(const uint8_t *src,
+                                                size_t src_len, uint8_t *dst,
+                                                size_t dst_cap,
+                                                const nyra_lz4_dict_t *dict) {
+  NYRA_ASSERT((src || !src_len) && dst && dict, "Invalid argument.");
+
+  uint32_t table[1 << NYRA_LZ4_HASH_LOG];
+  memcpy(table, dict->table, sizeof(table));
+
+  return nyra_lz4_compress_with_table_(src, src_len, dst, dst_cap, dict->data,
+                                       dict->len, table);
+}
+
+/**
+ * @brief Decompress the LZ4 block @a src into @a dst. @a dict must be the same
+ * dictionary which was used to compress the block.
+ *
+ * @return false if the block is malformed or @a dst is too small.
+ */
+static inline bool nyra_lz4_decompress(const uint8_t *src, size_t src_len,
+                                      uint8_t *dst, size_t dst_cap,
+                                      const uint8_t *dict, size_t dict_len,
+                                      size_t *decompressed_len) {
+  NYRA_ASSERT(src && dst && (dict || !dict_len) && decompressed_len,
+             "Invalid argument.");
+
+  if (dict_len > NYRA_LZ4_MAX_OFFSET) {
+    dict += dict_len - NYRA_LZ4_MAX_OFFSET;
+    dict_len = NYRA_LZ4_MAX_OFFSET;
+  }
+
+  const uint8_t *ip = src;
+  const uint8_t *ip_end = src + src_len;
+  size_t op = 0;
+
+  while (ip < ip_end) {
+    uint8_t token = *ip++;
+
+    size_t literal_len = token >> 4;
+    if (literal_len == 15) {
+      uint8_t b = 0;
+      do {
+        if (ip >= ip_end) {
+          return false;
+        }
+        b = *ip++;
+        literal_len += b;
+      } while (b == 255);
+    }
+
+    if (literal_len > (size_t)(ip_end - ip) || literal_len > dst_cap - op) {
+      return false;
+    }
+    memcpy(dst + op, ip, literal_len);
+    ip += literal_len;
+    op += literal_len;
+
+    if (ip == ip_end) {
+      // The last sequence.
+      break;
+    }
+
+    if (ip_end - ip < 2) {
+      return false;
+    }
+    size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > op + dict_len) {
+      return false;
+    }
+
+    size_t match_len = token & 0x0F;
+    if (match_len == 15) {
+      uint8_t b = 0;
+      do {
+        if (ip >= ip_end) {
+          return false;
+        }
+        b = *ip++;
+        match_len += b;
+      } while (b == 255);
+    }
+    match_len += NYRA_LZ4_MIN_MATCH;
+
+    if (match_len > dst_cap - op) {
+      return false;
+    }
+
+    // The match might start in the dictionary and continue into the output,
+    // and might overlap with the bytes being written, so copy byte by byte.
+    for (size_t i = 0; i < match_len; ++i, ++op) {
+      dst[op] = op >= offset ? dst[op - offset]
+                             : dict[dict_len - (offset - op)];
+    }
+  }
+
+  *decompressed_len = op;
+  return true;
+}
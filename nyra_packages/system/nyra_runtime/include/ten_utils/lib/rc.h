@@ -0,0 +1,277 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+  #include <intrin.h>
+#endif
+
+#include "nyra_utils/lib/alloc.h"
+#include "nyra_utils/lib/atomic.h"
+#include "nyra_utils/macro/check.h"
+#include "nyra_utils/macro/mark.h"
+
+// Reference counting which is inlined into the callers.
+//
+// 'nyra_ref_t' and 'nyra_shared_ptr_t' are exported by the runtime, so each
+// retain or release of them is a call into another library, and a shared_ptr
+// adds an allocation for its control block, and another one for each copy of
+// it. Here:
+//
+// - 'nyra_rc_t' is an intrusive counter to embed in an object. Increments are
+//   relaxed, and only the decrement which reaches 0 pays for an acquire.
+//
+// - 'nyra_rc_obj_*' allocate the counters together with the object, in front
+//   of it, and hand out the object itself. Copying a reference is copying the
+//   pointer, and there is a weak count for the observers which must not keep
+//   the object alive.
+
+typedef struct nyra_rc_t {
+  nyra_atomic_t cnt;
+} nyra_rc_t;
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline int64_t nyra_rc_fetch_add_relaxed_(nyra_atomic_t *a, int64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __atomic_fetch_add(a, v, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+  return _InterlockedExchangeAdd64((volatile __int64 *)a, v);
+#else
+  return nyra_atomic_fetch_add(a, v);
+#endif
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline int64_t nyra_rc_fetch_sub_release_(nyra_atomic_t *a,
+                                                 int64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __atomic_fetch_sub(a, v, __ATOMIC_RELEASE);
+#elif defined(_MSC_VER)
+  return _InterlockedExchangeAdd64((volatile __int64 *)a, -v);
+#else
+  return nyra_atomic_fetch_sub(a, v);
+#endif
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline int64_t nyra_rc_load_acquire_(nyra_atomic_t *a) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __atomic_load_n(a, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+  int64_t v = *(volatile int64_t *)a;
+  _ReadWriteBarrier();
+  return v;
+#else
+  return nyra_atomic_load(a);
+#endif
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_rc_compare_swap_(nyra_atomic_t *a, int64_t *expected,
+                                         int64_t desired) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __atomic_compare_exchange_n(a, expected, desired, true,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER)
+  int64_t prev = _InterlockedCompareExchange64((volatile __int64 *)a, desired,
+                                               *expected);
+  if (prev == *expected) {
+    return true;
+  }
+  *expected = prev;
+  return false;
+#else
+  int64_t prev = nyra_atomic_val_compare_swap(a, *expected, desired);
+  if (prev == *expected) {
+    return true;
+  }
+  *expected = prev;
+  return false;
+#endif
+}
+
+static inline void nyra_rc_init(nyra_rc_t *self, int64_t cnt) {
+  NYRA_ASSERT(self && cnt >= 0, "Invalid argument.");
+  self->cnt = cnt;
+}
+
+/**
+ * @brief Add one reference. The caller must already hold one.
+ */
+static inline void nyra_rc_inc(nyra_rc_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  NYRA_UNUSED int64_t old = nyra_rc_fetch_add_relaxed_(&self->cnt, 1);
+  NYRA_ASSERT(old > 0, "Retain an object which is dead.");
+}
+
+/**
+ * @brief Add one reference, unless there is none left, which happens when an
+ * observer races with the release of the last reference.
+ *
+ * @return Whether a reference has been added.
+ */
+static inline bool nyra_rc_inc_if_non_zero(nyra_rc_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  int64_t cnt = nyra_rc_load_acquire_(&self->cnt);
+  while (cnt != 0) {
+    if (nyra_rc_compare_swap_(&self->cnt, &cnt, cnt + 1)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Drop one reference.
+ *
+ * @return Whether it was the last one, then everything written to the object
+ * by the other owners is visible, and the object could be destroyed.
+ */
+static inline bool nyra_rc_dec(nyra_rc_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  int64_t old = nyra_rc_fetch_sub_release_(&self->cnt, 1);
+  NYRA_ASSERT(old > 0, "Release an object which is dead.");
+
+  if (old == 1) {
+    // Synchronize with the decrements of the other owners. It is an acquire
+    // load rather than a fence, which the thread sanitizer does not model.
+    nyra_rc_load_acquire_(&self->cnt);
+    return true;
+  }
+
+  return false;
+}
+
+static inline int64_t nyra_rc_get(nyra_rc_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  return nyra_rc_load_acquire_(&self->cnt);
+}
+
+/**
+ * @brief Whether the caller holds the only reference, ex: to modify an object
+ * in place rather than cloning it first.
+ */
+static inline bool nyra_rc_is_unique(nyra_rc_t *self) {
+  return nyra_rc_get(self) == 1;
+}
+
+typedef struct nyra_rc_obj_header_t {
+  // The owners of the object.
+  nyra_rc_t strong;
+
+  // The observers of the object, and 1 for all the owners together. The
+  // memory is freed when it drops to 0.
+  nyra_rc_t weak;
+
+  // Releases what the object holds, but not the object itself.
+  void (*deinit)(void *obj);
+} nyra_rc_obj_header_t;
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline size_t nyra_rc_obj_header_size_(void) {
+  // Keep the object as aligned as 'malloc()' would.
+  return (sizeof(nyra_rc_obj_header_t) + 15) & ~(size_t)15;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_rc_obj_header_t *nyra_rc_obj_header_(void *obj) {
+  NYRA_ASSERT(obj, "Invalid argument.");
+  return (nyra_rc_obj_header_t *)((uint8_t *)obj - nyra_rc_obj_header_size_());
+}
+
+/**
+ * @brief Allocate @a size bytes for an object, with its counters in the same
+ * allocation. The caller holds the first reference, and initializes the
+ * object.
+ *
+ * @param deinit Called with the object when its last owner releases it, could
+ * be NULL.
+ */
+static inline void *nyra_rc_obj_create(size_t size, void (*deinit)(void *obj)) {
+  uint8_t *mem = (uint8_t *)NYRA_MALLOC(nyra_rc_obj_header_size_() + size);
+  NYRA_ASSERT(mem, "Failed to allocate memory.");
+
+  nyra_rc_obj_header_t *header = (nyra_rc_obj_header_t *)mem;
+  nyra_rc_init(&header->strong, 1);
+  nyra_rc_init(&header->weak, 1);
+  header->deinit = deinit;
+
+  return mem + nyra_rc_obj_header_size_();
+}
+
+static inline void *nyra_rc_obj_retain(void *obj) {
+  nyra_rc_inc(&nyra_rc_obj_header_(obj)->strong);
+  return obj;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_rc_obj_weak_release_header_(
+    nyra_rc_obj_header_t *header) {
+  if (nyra_rc_dec(&header->weak)) {
+    NYRA_FREE_(header);
+  }
+}
+
+/**
+ * @brief Drop one owner. The object is deinitted with the last owner, and its
+ * memory is freed once it has no observer either.
+ */
+static inline void nyra_rc_obj_release(void *obj) {
+  nyra_rc_obj_header_t *header = nyra_rc_obj_header_(obj);
+
+  if (nyra_rc_dec(&header->strong)) {
+    if (header->deinit) {
+      header->deinit(obj);
+    }
+    nyra_rc_obj_weak_release_header_(header);
+  }
+}
+
+static inline int64_t nyra_rc_obj_get_ref(void *obj) {
+  return nyra_rc_get(&nyra_rc_obj_header_(obj)->strong);
+}
+
+static inline bool nyra_rc_obj_is_unique(void *obj) {
+  return nyra_rc_is_unique(&nyra_rc_obj_header_(obj)->strong);
+}
+
+/**
+ * @brief Start observing the object. The caller must hold either an owner or
+ * an observer reference of it.
+ *
+ * The observer could keep the pointer, and must only access the object
+ * through 'nyra_rc_obj_lock()'.
+ */
+static inline void *nyra_rc_obj_weak_retain(void *obj) {
+  nyra_rc_inc(&nyra_rc_obj_header_(obj)->weak);
+  return obj;
+}
+
+static inline void nyra_rc_obj_weak_release(void *obj) {
+  nyra_rc_obj_weak_release_header_(nyra_rc_obj_header_(obj));
+}
+
+/**
+ * @brief Turn an observer into one more owner, if the object is still alive.
+ *
+ * @return @a obj with one more owner reference, which has to be released, or
+ * NULL if the object is dead. The observer reference is kept either way.
+ */
+static inline void *nyra_rc_obj_lock(void *obj) {
+  return nyra_rc_inc_if_non_zero(&nyra_rc_obj_header_(obj)->strong) ? obj
+                                                                    : NULL;
+}
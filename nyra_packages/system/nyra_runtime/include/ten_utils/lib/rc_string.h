@@ -0,0 +1,247 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nyra_utils/container/flat_hash_table.h"
+#include "nyra_utils/lib/alloc.h"
+#include "nyra_utils/lib/hash.h"
+#include "nyra_utils/lib/rc.h"
+#include "nyra_utils/lib/signature.h"
+#include "nyra_utils/lib/spinlock.h"
+#include "nyra_utils/macro/check.h"
+
+#define NYRA_RC_STRING_SIGNATURE 0x6B1F0A93D24C57E8U
+
+// An immutable string, whose header, bytes and terminating '\0' are in one
+// allocation, shared by reference counting. It is meant for the names which
+// are copied along with the messages, ex: the property keys, the message
+// names or the destination names. A copy costs an atomic increment rather
+// than a 'nyra_strdup()', and the hash is computed once at creation.
+//
+// A string could also be interned, then all the interned strings with the
+// same content are the same object, so they compare by their addresses.
+
+typedef struct nyra_rc_string_t {
+  nyra_signature_t signature;
+  nyra_rc_t ref_cnt;
+
+  uint64_t hash;
+  size_t len;
+  bool interned;
+
+  char data[];
+} nyra_rc_string_t;
+
+typedef struct nyra_rc_string_intern_table_t {
+  nyra_spinlock_t lock;
+  bool inited;
+
+  // The bytes of each string are the key of its own entry.
+  nyra_flat_hashtable_t table;
+} nyra_rc_string_intern_table_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+NYRA_SELECTANY nyra_rc_string_intern_table_t nyra_rc_string_intern_table;
+
+#ifdef __cplusplus
+}
+#endif
+
+static inline bool nyra_rc_string_check_integrity(nyra_rc_string_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  return nyra_signature_get(&self->signature) == NYRA_RC_STRING_SIGNATURE;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_rc_string_t *nyra_rc_string_alloc_(const char *str,
+                                                     size_t len,
+                                                     uint64_t hash) {
+  nyra_rc_string_t *self =
+      (nyra_rc_string_t *)NYRA_MALLOC(sizeof(nyra_rc_string_t) + len + 1);
+  NYRA_ASSERT(self, "Failed to allocate memory.");
+
+  nyra_signature_set(&self->signature, NYRA_RC_STRING_SIGNATURE);
+  nyra_rc_init(&self->ref_cnt, 1);
+  self->hash = hash;
+  self->len = len;
+  self->interned = false;
+
+  if (len) {
+    memcpy(self->data, str, len);
+  }
+  self->data[len] = '\0';
+
+  return self;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_rc_string_free_(nyra_rc_string_t *self) {
+  nyra_signature_set(&self->signature, 0);
+  NYRA_FREE_(self);
+}
+
+/**
+ * @brief Create a string holding one reference, with a copy of the @a len
+ * bytes at @a str.
+ */
+static inline nyra_rc_string_t *nyra_rc_string_create_with_len(const char *str,
+                                                              size_t len) {
+  NYRA_ASSERT(str || !len, "Invalid argument.");
+  return nyra_rc_string_alloc_(str, len, nyra_hash_bytes(str, len));
+}
+
+static inline nyra_rc_string_t *nyra_rc_string_create(const char *str) {
+  NYRA_ASSERT(str, "Invalid argument.");
+  return nyra_rc_string_create_with_len(str, strlen(str));
+}
+
+/**
+ * @brief Get the interned string with the content of @a str, which is created
+ * if there is none yet. The caller gets one reference of it.
+ */
+static inline nyra_rc_string_t *nyra_rc_string_intern_with_len(const char *str,
+                                                              size_t len) {
+  NYRA_ASSERT((str || !len) && len <= UINT32_MAX, "Invalid argument.");
+
+  nyra_rc_string_intern_table_t *intern = &nyra_rc_string_intern_table;
+  nyra_rc_string_t *self = NULL;
+
+  nyra_spinlock_lock(&intern->lock);
+
+  if (!intern->inited) {
+    nyra_flat_hashtable_init(&intern->table,
+                             NYRA_FLAT_HASHTABLE_KEY_TYPE_BYTES, NULL);
+    intern->inited = true;
+  }
+
+  self = (nyra_rc_string_t *)nyra_flat_hashtable_get_by_key(
+      &intern->table, str, (uint32_t)len);
+
+  // A string whose last reference is being released stays in the table until
+  // its releaser takes the lock, it is replaced by a new one here. The entry
+  // then takes the bytes of the new string as its key, as the dying one is
+  // about to be freed.
+  if (!self || !nyra_rc_inc_if_non_zero(&self->ref_cnt)) {
+    self = nyra_rc_string_alloc_(str, len, nyra_hash_bytes(str, len));
+    self->interned = true;
+
+    nyra_flat_hashtable_set_by_key(&intern->table, self->data, (uint32_t)len,
+                                   self);
+  }
+
+  nyra_spinlock_unlock(&intern->lock);
+
+  return self;
+}
+
+static inline nyra_rc_string_t *nyra_rc_string_intern(const char *str) {
+  NYRA_ASSERT(str, "Invalid argument.");
+  return nyra_rc_string_intern_with_len(str, strlen(str));
+}
+
+/**
+ * @brief Take one more reference of the string, which is its copy.
+ */
+static inline nyra_rc_string_t *nyra_rc_string_retain(nyra_rc_string_t *self) {
+  NYRA_ASSERT(self && nyra_rc_string_check_integrity(self),
+             "Invalid argument.");
+
+  nyra_rc_inc(&self->ref_cnt);
+  return self;
+}
+
+// Called once the last reference has been dropped. An interned string could
+// still be found in the table until the lock is taken here.
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_rc_string_destroy_(nyra_rc_string_t *self) {
+  if (self->interned) {
+    nyra_rc_string_intern_table_t *intern = &nyra_rc_string_intern_table;
+
+    nyra_spinlock_lock(&intern->lock);
+
+    // The entry might have been taken by a newer string with the same content
+    // in the meantime.
+    if (nyra_flat_hashtable_get_by_key(&intern->table, self->data,
+                                       (uint32_t)self->len) == self) {
+      nyra_flat_hashtable_del_by_key(&intern->table, self->data,
+                                     (uint32_t)self->len);
+    }
+
+    nyra_spinlock_unlock(&intern->lock);
+  }
+
+  nyra_rc_string_free_(self);
+}
+
+/**
+ * @brief Drop one reference, the string is freed with the last one.
+ */
+static inline void nyra_rc_string_release(nyra_rc_string_t *self) {
+  NYRA_ASSERT(self && nyra_rc_string_check_integrity(self),
+             "Invalid argument.");
+
+  if (nyra_rc_dec(&self->ref_cnt)) {
+    nyra_rc_string_destroy_(self);
+  }
+}
+
+static inline const char *nyra_rc_string_get_raw_str(nyra_rc_string_t *self) {
+  NYRA_ASSERT(self && nyra_rc_string_check_integrity(self),
+             "Invalid argument.");
+  return self->data;
+}
+
+static inline size_t nyra_rc_string_len(nyra_rc_string_t *self) {
+  NYRA_ASSERT(self && nyra_rc_string_check_integrity(self),
+             "Invalid argument.");
+  return self->len;
+}
+
+/**
+ * @brief The 'nyra_hash_bytes()' of the content, computed at creation.
+ */
+static inline uint64_t nyra_rc_string_hash(nyra_rc_string_t *self) {
+  NYRA_ASSERT(self && nyra_rc_string_check_integrity(self),
+             "Invalid argument.");
+  return self->hash;
+}
+
+static inline bool nyra_rc_string_is_equal(nyra_rc_string_t *self,
+                                          nyra_rc_string_t *other) {
+  NYRA_ASSERT(self && nyra_rc_string_check_integrity(self) && other &&
+                 nyra_rc_string_check_integrity(other),
+             "Invalid argument.");
+
+  if (self == other) {
+    return true;
+  }
+
+  // Two interned strings are different objects only if their contents differ.
+  if ((self->interned && other->interned) || self->hash != other->hash ||
+      self->len != other->len) {
+    return false;
+  }
+
+  return memcmp(self->data, other->data, self->len) == 0;
+}
+
+static inline bool nyra_rc_string_is_equal_c_str(nyra_rc_string_t *self,
+                                                const char *other) {
+  NYRA_ASSERT(self && nyra_rc_string_check_integrity(self) && other,
+             "Invalid argument.");
+  return strcmp(self->data, other) == 0;
+}
@@ -42,6 +42,9 @@ typedef struct nyra_string_t {
   nyra_signature_t signature;
 
   char *buf;  // Pointer to allocated buffer.
+
+  // The inline storage, 'buf' points here until the string outgrows it, so
+  // the short strings, ex: the property keys or the UUIDs, do not allocate.
   char pre_buf[NYRA_STRING_PRE_BUF_SIZE];
   size_t buf_size;          // Allocated capacity.
   size_t first_unused_idx;  // Index of first unused byte.
@@ -63,6 +66,15 @@ inline bool nyra_string_check_integrity(const nyra_string_t *self) {
   return true;
 }
 
+/**
+ * @brief Whether the content is still in the inline storage of the string,
+ * rather than in a buffer allocated from the heap.
+ */
+static inline bool nyra_string_is_using_pre_buf(const nyra_string_t *self) {
+  NYRA_ASSERT(self && nyra_string_check_integrity(self), "Invalid argument.");
+  return self->buf == self->pre_buf;
+}
+
 /**
  * @brief Create a string object.
  * @return A pointer to the string object.
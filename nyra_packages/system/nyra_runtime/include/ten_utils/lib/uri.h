@@ -13,6 +13,7 @@
 #define NYRA_PROTOCOL_TCP "tcp"
 #define NYRA_PROTOCOL_RAW "raw"
 #define NYRA_PROTOCOL_PIPE "pipe"
+#define NYRA_PROTOCOL_UNIX "unix"
 
 typedef struct nyra_value_t nyra_value_t;
 
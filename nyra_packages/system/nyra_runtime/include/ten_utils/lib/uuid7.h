@@ -0,0 +1,293 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nyra_utils/lib/hash.h"
+#include "nyra_utils/lib/random.h"
+#include "nyra_utils/lib/string.h"
+#include "nyra_utils/lib/thread_once.h"
+#include "nyra_utils/lib/time.h"
+#include "nyra_utils/macro/check.h"
+#include "nyra_utils/macro/mark.h"
+
+// Time-ordered UUIDs (version 7, RFC 9562) for the ids which are created for
+// each message, ex: the ones of the commands, to be matched with their
+// results. 'nyra_uuid4_gen()' reads the entropy of the system for each one,
+// and 'nyra_uuid4_gen_string()' formats it as well. These are generated from a
+// per-thread state without any lock, and kept as 2 integers, so comparing or
+// hashing them is as cheap as it is for a pointer. They are only converted to
+// text at the boundaries, ex: the protocols and the bindings.
+//
+// The 48 high bits are the Unix time in milliseconds, followed by the version.
+// The next 12 bits are a counter, which starts at a random value each
+// millisecond, so the ids of a thread are strictly increasing. The 62 low bits,
+// after the variant, are random.
+//
+// A child created by fork() gets a copy of the state of the forking thread, so
+// that state is reseeded in the child, which would otherwise generate the same
+// ids as its parent.
+//
+// Any UUID could be held, ex: the ones in the messages of the other peers.
+
+#define NYRA_UUID7_STRING_LEN 36
+
+typedef struct nyra_uuid7_t {
+  // The first 8 bytes and the last 8 bytes, read as big endian.
+  uint64_t hi;
+  uint64_t lo;
+} nyra_uuid7_t;
+
+typedef struct nyra_uuid7_thread_state_t {
+  uint64_t rng;
+  int64_t last_ms;
+  uint32_t counter;
+  bool seeded;
+} nyra_uuid7_thread_state_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+NYRA_SELECTANY NYRA_THREAD_LOCAL nyra_uuid7_thread_state_t
+    nyra_uuid7_thread_state;
+
+NYRA_SELECTANY nyra_thread_once_t nyra_uuid7_fork_handler_once =
+    NYRA_THREAD_ONCE_INIT;
+
+#ifdef __cplusplus
+}
+#endif
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline uint64_t nyra_uuid7_rand_(nyra_uuid7_thread_state_t *state) {
+  // wyrand.
+  state->rng += 0xA0761D6478BD642FULL;
+  return nyra_hash_mix_(state->rng, state->rng ^ 0xE7037ED1A0B428DBULL);
+}
+
+#if !defined(_WIN32)
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_uuid7_on_fork_child_(void) {
+  // The only thread of the child is the one which has called fork().
+  nyra_uuid7_thread_state.seeded = false;
+}
+#endif
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_uuid7_install_fork_handler_(void) {
+#if !defined(_WIN32)
+  pthread_atfork(NULL, NULL, nyra_uuid7_on_fork_child_);
+#endif
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_uuid7_seed_(nyra_uuid7_thread_state_t *state) {
+  nyra_thread_once(&nyra_uuid7_fork_handler_once,
+                   nyra_uuid7_install_fork_handler_);
+
+  uint64_t seed = 0;
+  if (nyra_random(&seed, sizeof(seed)) != 0) {
+    // The threads are still told apart by the address of their state.
+    seed = (uint64_t)nyra_current_time_us();
+  }
+
+  state->rng = seed ^ (uint64_t)(uintptr_t)state;
+  state->last_ms = 0;
+  state->counter = 0;
+  state->seeded = true;
+}
+
+/**
+ * @brief Generate a new id from the state of the calling thread.
+ */
+static inline void nyra_uuid7_gen(nyra_uuid7_t *out) {
+  NYRA_ASSERT(out, "Invalid argument.");
+
+  nyra_uuid7_thread_state_t *state = &nyra_uuid7_thread_state;
+  if (UNLIKELY(!state->seeded)) {
+    nyra_uuid7_seed_(state);
+  }
+
+  uint64_t random = nyra_uuid7_rand_(state);
+
+  int64_t now = nyra_current_time();
+  if (now > state->last_ms) {
+    state->last_ms = now;
+
+    // The highest bit is left clear, so the counter could not overflow within
+    // a millisecond unless 2048 ids are generated in it.
+    state->counter = (uint32_t)(random >> 53);
+  } else if (++state->counter > 0xFFF) {
+    // Too many ids in this millisecond, or the clock went back, so borrow the
+    // next one.
+    state->last_ms++;
+    state->counter = (uint32_t)(random >> 53);
+  }
+
+  out->hi = ((uint64_t)state->last_ms << 16) | 0x7000U | state->counter;
+  out->lo = (random & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;
+}
+
+static inline bool nyra_uuid7_is_equal(const nyra_uuid7_t *a,
+                                       const nyra_uuid7_t *b) {
+  NYRA_ASSERT(a && b, "Invalid argument.");
+  return a->hi == b->hi && a->lo == b->lo;
+}
+
+/**
+ * @return <0, 0 or >0, the ids of version 7 are ordered by their creation.
+ */
+static inline int nyra_uuid7_compare(const nyra_uuid7_t *a,
+                                     const nyra_uuid7_t *b) {
+  NYRA_ASSERT(a && b, "Invalid argument.");
+  if (a->hi != b->hi) {
+    return a->hi < b->hi ? -1 : 1;
+  }
+  if (a->lo != b->lo) {
+    return a->lo < b->lo ? -1 : 1;
+  }
+  return 0;
+}
+
+static inline bool nyra_uuid7_is_empty(const nyra_uuid7_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  return self->hi == 0 && self->lo == 0;
+}
+
+/**
+ * @brief A hash of the id. The low bits are random, so they are mixed with the
+ * high ones in case the id is not a generated one.
+ *
+ * As a key of a 'nyra_flat_hashtable_t', the id could also be used as 16 bytes
+ * with 'nyra_flat_hashtable_set_by_key()'.
+ */
+static inline uint64_t nyra_uuid7_hash(const nyra_uuid7_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  return nyra_hash_mix_(self->hi ^ NYRA_HASH_SECRET0,
+                        self->lo ^ NYRA_HASH_SECRET1);
+}
+
+/**
+ * @return The Unix time in milliseconds at which the id was generated.
+ */
+static inline int64_t nyra_uuid7_get_time_ms(const nyra_uuid7_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  return (int64_t)(self->hi >> 16);
+}
+
+/**
+ * @brief The 16 bytes of the id, in the order of RFC 9562, ex: for the
+ * 'bytes' of a 'nyra_uuid4_t'.
+ */
+static inline void nyra_uuid7_to_bytes(const nyra_uuid7_t *self,
+                                       uint8_t bytes[16]) {
+  NYRA_ASSERT(self && bytes, "Invalid argument.");
+  for (int i = 0; i < 8; i++) {
+    bytes[i] = (uint8_t)(self->hi >> (56 - 8 * i));
+    bytes[8 + i] = (uint8_t)(self->lo >> (56 - 8 * i));
+  }
+}
+
+static inline void nyra_uuid7_from_bytes(nyra_uuid7_t *self,
+                                         const uint8_t bytes[16]) {
+  NYRA_ASSERT(self && bytes, "Invalid argument.");
+  self->hi = 0;
+  self->lo = 0;
+  for (int i = 0; i < 8; i++) {
+    self->hi = (self->hi << 8) | bytes[i];
+    self->lo = (self->lo << 8) | bytes[8 + i];
+  }
+}
+
+/**
+ * @brief Write the id as 'xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx' in lower case
+ * to @a out, which must have room for 'NYRA_UUID7_STRING_LEN' + 1 characters.
+ */
+static inline void nyra_uuid7_to_chars(const nyra_uuid7_t *self, char *out) {
+  NYRA_ASSERT(self && out, "Invalid argument.");
+
+  static const char digits[] = "0123456789abcdef";
+
+  int digit_cnt = 0;
+  for (int i = 0; i < NYRA_UUID7_STRING_LEN; i++) {
+    if (i == 8 || i == 13 || i == 18 || i == 23) {
+      out[i] = '-';
+      continue;
+    }
+
+    uint64_t half = digit_cnt < 16 ? self->hi : self->lo;
+    int shift = 60 - 4 * (digit_cnt & 15);
+    out[i] = digits[(half >> shift) & 0xF];
+    digit_cnt++;
+  }
+  out[NYRA_UUID7_STRING_LEN] = '\0';
+}
+
+static inline void nyra_uuid7_to_string(const nyra_uuid7_t *self,
+                                        nyra_string_t *out) {
+  NYRA_ASSERT(self && out, "Invalid argument.");
+
+  char chars[NYRA_UUID7_STRING_LEN + 1];
+  nyra_uuid7_to_chars(self, chars);
+  nyra_string_init_from_c_str(out, chars, NYRA_UUID7_STRING_LEN);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline int nyra_uuid7_hex_digit_(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  c = (char)(c | 0x20);
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+/**
+ * @brief Parse an id written as 'xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx', in
+ * any case, of any version.
+ */
+static inline bool nyra_uuid7_from_chars(nyra_uuid7_t *self, const char *str,
+                                         size_t len) {
+  NYRA_ASSERT(self && (str || !len), "Invalid argument.");
+
+  if (len != NYRA_UUID7_STRING_LEN) {
+    return false;
+  }
+
+  uint64_t halves[2] = {0, 0};
+  int digit_cnt = 0;
+
+  for (size_t i = 0; i < len; i++) {
+    if (i == 8 || i == 13 || i == 18 || i == 23) {
+      if (str[i] != '-') {
+        return false;
+      }
+      continue;
+    }
+
+    int digit = nyra_uuid7_hex_digit_(str[i]);
+    if (digit < 0) {
+      return false;
+    }
+
+    uint64_t *half = &halves[digit_cnt / 16];
+    *half = (*half << 4) | (uint64_t)digit;
+    digit_cnt++;
+  }
+
+  self->hi = halves[0];
+  self->lo = halves[1];
+  return true;
+}
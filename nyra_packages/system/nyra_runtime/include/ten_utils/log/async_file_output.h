@@ -0,0 +1,70 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stdbool.h>
+
+#include "nyra_utils/io/async_file.h"
+#include "nyra_utils/lib/string.h"
+#include "nyra_utils/log/log.h"
+#include "nyra_utils/macro/check.h"
+
+// Send the output of a 'nyra_log_t' to a file through 'nyra_async_file_t', so
+// that a log statement on an extension or an engine thread only costs a
+// memcpy, and never waits for the disk.
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_log_output_to_async_file_cb_(nyra_string_t *msg,
+                                                    void *user_data) {
+  nyra_async_file_t *file = (nyra_async_file_t *)user_data;
+  NYRA_ASSERT(msg && file, "Invalid argument.");
+
+  nyra_async_file_append_line(file, nyra_string_get_raw_str(msg),
+                              nyra_string_len(msg));
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_log_close_async_file_cb_(void *user_data) {
+  nyra_async_file_t *file = (nyra_async_file_t *)user_data;
+  NYRA_ASSERT(file, "Invalid argument.");
+
+  // Make sure that the last lines before the shutdown are on the disk.
+  nyra_async_file_close(file);
+}
+
+/**
+ * @brief Append the log of @a self to the file @a path. The log lines are
+ * dropped rather than blocking the caller if the disk could not keep up, and
+ * the number of the dropped bytes could be read from the stats of the file.
+ *
+ * @param config NULL for the default configuration.
+ *
+ * @return The writer which is owned by @a self, and will be closed when the
+ * output of @a self is closed. NULL if the file could not be opened.
+ */
+static inline nyra_async_file_t *nyra_log_set_output_to_async_file(
+    nyra_log_t *self, const char *path,
+    const nyra_async_file_config_t *config) {
+  NYRA_ASSERT(self && path, "Invalid argument.");
+
+  nyra_async_file_t *file = nyra_async_file_open(path, config);
+  if (!file) {
+    return NULL;
+  }
+
+  if (self->output.close_cb) {
+    self->output.close_cb(self->output.user_data);
+  }
+
+  self->output.output_cb = nyra_log_output_to_async_file_cb_;
+  self->output.close_cb = nyra_log_close_async_file_cb_;
+  self->output.user_data = file;
+
+  return file;
+}
@@ -15,6 +15,10 @@
     while (expr) break;     \
   } while (0)
 
+// A variable defined in a header with 'NYRA_SELECTANY' has only one instance in
+// the whole program, rather than one in each translation unit. It is how the
+// header-only modules keep a process-wide state.
+
 #if defined(_WIN32) && !defined(__clang__)
 
   #if !defined(NYRA_UNUSED)
@@ -25,6 +29,18 @@
     #define PURE
   #endif  // !defined(PURE)
 
+  #if !defined(NYRA_SELECTANY)
+    #define NYRA_SELECTANY __declspec(selectany)
+  #endif  // !defined(NYRA_SELECTANY)
+
+  #if !defined(NYRA_THREAD_LOCAL)
+    #define NYRA_THREAD_LOCAL __declspec(thread)
+  #endif  // !defined(NYRA_THREAD_LOCAL)
+
+  #if !defined(NYRA_NOINLINE)
+    #define NYRA_NOINLINE __declspec(noinline)
+  #endif  // !defined(NYRA_NOINLINE)
+
   #ifndef LIKELY
     #define LIKELY(x) (x)
   #endif  // !LIKELY
@@ -43,6 +59,18 @@
     #define PURE __attribute__((const))
   #endif  // !defined(PURE)
 
+  #if !defined(NYRA_SELECTANY)
+    #define NYRA_SELECTANY __attribute__((weak))
+  #endif  // !defined(NYRA_SELECTANY)
+
+  #if !defined(NYRA_THREAD_LOCAL)
+    #define NYRA_THREAD_LOCAL __thread
+  #endif  // !defined(NYRA_THREAD_LOCAL)
+
+  #if !defined(NYRA_NOINLINE)
+    #define NYRA_NOINLINE __attribute__((noinline))
+  #endif  // !defined(NYRA_NOINLINE)
+
   #ifndef LIKELY
     #define LIKELY(x) __builtin_expect(!!(x), 1)
   #endif  // !LIKELY
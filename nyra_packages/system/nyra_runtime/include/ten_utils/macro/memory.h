@@ -11,6 +11,13 @@
 #include "nyra_utils/lib/alloc.h"
 #include "nyra_utils/sanitizer/memory_check.h"  // IWYU pragma: keep
 
+#if defined(NYRA_ENABLE_MEMORY_SAMPLING) && \
+    defined(NYRA_ENABLE_CUSTOM_ALLOCATOR)
+  // The sampler allocates through 'nyra_malloc' directly, so it would silently
+  // bypass the custom allocator.
+  #error "The memory sampling could not be used with a custom allocator."
+#endif
+
 #if defined(NYRA_ENABLE_MEMORY_CHECK)
 
 #define NYRA_MALLOC(size) \
@@ -37,6 +44,55 @@
 #define NYRA_STRDUP(str) \
   nyra_sanitizer_memory_strdup((str), __FILE__, __LINE__, __FUNCTION__)
 
+#elif defined(NYRA_ENABLE_MEMORY_SAMPLING)
+
+// Route through the sampler, which is included by "nyra_utils/lib/alloc.h".
+
+#define NYRA_MALLOC(size) nyra_sanitizer_memory_sample_malloc((size))
+
+#define NYRA_CALLOC(cnt, size) \
+  nyra_sanitizer_memory_sample_calloc((cnt), (size))
+
+#define NYRA_FREE(address)                                \
+  do {                                                   \
+    nyra_sanitizer_memory_sample_free((void *)(address)); \
+    address = NULL;                                      \
+  } while (0)
+
+#define NYRA_FREE_(address)                               \
+  do {                                                   \
+    nyra_sanitizer_memory_sample_free((void *)(address)); \
+  } while (0)
+
+#define NYRA_REALLOC(address, size) \
+  nyra_sanitizer_memory_sample_realloc((address), (size))
+
+#define NYRA_STRDUP(str) nyra_sanitizer_memory_sample_strdup((str))
+
+#elif defined(NYRA_ENABLE_CUSTOM_ALLOCATOR)
+
+// Route through the registered allocator, which is included by
+// "nyra_utils/lib/alloc.h".
+
+#define NYRA_MALLOC(size) nyra_allocator_malloc((size))
+
+#define NYRA_CALLOC(cnt, size) nyra_allocator_calloc((cnt), (size))
+
+#define NYRA_FREE(address)                  \
+  do {                                     \
+    nyra_allocator_free((void *)(address)); \
+    address = NULL;                        \
+  } while (0)
+
+#define NYRA_FREE_(address)                 \
+  do {                                     \
+    nyra_allocator_free((void *)(address)); \
+  } while (0)
+
+#define NYRA_REALLOC(address, size) nyra_allocator_realloc((address), (size))
+
+#define NYRA_STRDUP(str) nyra_allocator_strdup((str))
+
 #else
 
 #define NYRA_MALLOC(size) nyra_malloc((size))
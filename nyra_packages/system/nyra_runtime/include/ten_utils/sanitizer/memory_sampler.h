@@ -0,0 +1,494 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+  #include <windows.h>
+#elif (defined(__linux__) && defined(__GLIBC__)) || defined(__APPLE__)
+  #include <execinfo.h>
+  #define NYRA_SANITIZER_MEMORY_SAMPLER_HAS_EXECINFO
+#endif
+
+#include "nyra_utils/lib/alloc.h"
+#include "nyra_utils/lib/atomic.h"
+#include "nyra_utils/lib/spinlock.h"
+#include "nyra_utils/macro/check.h"
+#include "nyra_utils/macro/ctor.h"
+#include "nyra_utils/macro/mark.h"
+
+// The sampling counterpart of the memory check. The memory check records every
+// allocation, which is far too heavy for a production build. The sampler
+// records the stack of one allocation for every 'rate' bytes allocated on
+// average, so it could be left built in ('NYRA_ENABLE_MEMORY_SAMPLING') and be
+// turned on and off at runtime on a live session. The live samples could be
+// dumped as a heap profile in the legacy pprof format at any time, ex:
+//
+//   pprof -top <binary> heap.prof
+//
+// The intervals between the samples are exponentially distributed, which is
+// what pprof expects to unsample the 'heap_v2/<rate>' profiles, so the numbers
+// it reports are estimations of the whole heap.
+//
+// When the sampler is off, the cost is one atomic load per allocation, and one
+// per free as long as no sample is alive in the same bucket.
+//
+// Only the allocations made through the NYRA_MALLOC family, in the code built
+// with 'NYRA_ENABLE_MEMORY_SAMPLING', are sampled. The ones made inside the
+// prebuilt runtime, and the plain malloc or new of an extension or of the
+// libraries it uses, are not seen at all, so the growth of the memory of an
+// extension is only attributed as far as it allocates through NYRA_MALLOC.
+//
+// Note: the state is a weak symbol of the headers, so each module which does
+// not share the symbols of the others, ex: an extension loaded with
+// RTLD_LOCAL, gets a sampler of its own. It records and dumps only the
+// allocations made by the code of that module, and has to be enabled and
+// dumped from that module.
+
+#define NYRA_SANITIZER_MEMORY_SAMPLER_DEFAULT_RATE (512 * 1024)
+#define NYRA_SANITIZER_MEMORY_SAMPLER_MAX_DEPTH 32
+#define NYRA_SANITIZER_MEMORY_SAMPLER_BUCKET_CNT 4096
+
+typedef struct nyra_sanitizer_memory_sample_t {
+  struct nyra_sanitizer_memory_sample_t *next;
+
+  void *addr;
+  size_t size;
+
+  int depth;
+  void *stack[NYRA_SANITIZER_MEMORY_SAMPLER_MAX_DEPTH];
+} nyra_sanitizer_memory_sample_t;
+
+typedef struct nyra_sanitizer_memory_sampler_bucket_t {
+  // The number of the samples in the bucket, so that the frees could skip the
+  // lock when there is none.
+  nyra_atomic_t cnt;
+  nyra_sanitizer_memory_sample_t *head;
+} nyra_sanitizer_memory_sampler_bucket_t;
+
+typedef struct nyra_sanitizer_memory_sampler_t {
+  // 0 if the sampler is off.
+  nyra_atomic_t rate;
+
+  // Protects all the buckets. The samples are rare, so a single lock is enough.
+  nyra_spinlock_t lock;
+  nyra_sanitizer_memory_sampler_bucket_t
+      buckets[NYRA_SANITIZER_MEMORY_SAMPLER_BUCKET_CNT];
+
+  nyra_atomic_t sample_cnt;
+  nyra_atomic_t sample_bytes;
+} nyra_sanitizer_memory_sampler_t;
+
+typedef struct nyra_sanitizer_memory_sampler_thread_state_t {
+  // The bytes to be allocated by this thread before the next sample.
+  int64_t bytes_until_sample;
+  uint64_t rng;
+} nyra_sanitizer_memory_sampler_thread_state_t;
+
+typedef struct nyra_sanitizer_memory_sampler_stats_t {
+  size_t rate;
+
+  // The live samples, and the sum of their sizes.
+  size_t sample_cnt;
+  size_t sample_bytes;
+} nyra_sanitizer_memory_sampler_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+NYRA_SELECTANY nyra_sanitizer_memory_sampler_t nyra_sanitizer_memory_sampler;
+
+NYRA_SELECTANY NYRA_THREAD_LOCAL nyra_sanitizer_memory_sampler_thread_state_t
+    nyra_sanitizer_memory_sampler_thread_state;
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @brief Turn the sampler on, or change its rate.
+ *
+ * @param rate The average number of bytes allocated between two samples, 0 for
+ * the default one.
+ */
+static inline void nyra_sanitizer_memory_sampler_enable(size_t rate) {
+  if (!rate) {
+    rate = NYRA_SANITIZER_MEMORY_SAMPLER_DEFAULT_RATE;
+  }
+
+  nyra_atomic_store(&nyra_sanitizer_memory_sampler.rate, (int64_t)rate);
+}
+
+/**
+ * @brief Turn the sampler off. The live samples are kept until their blocks
+ * are freed, so they could still be dumped.
+ */
+static inline void nyra_sanitizer_memory_sampler_disable(void) {
+  nyra_atomic_store(&nyra_sanitizer_memory_sampler.rate, 0);
+}
+
+static inline bool nyra_sanitizer_memory_sampler_is_enabled(void) {
+  return nyra_atomic_load(&nyra_sanitizer_memory_sampler.rate) != 0;
+}
+
+/**
+ * @brief Turn the sampler on if the 'NYRA_MEMORY_SAMPLING_RATE' environment
+ * variable is set to a positive number of bytes. It is called when the module
+ * is loaded, except for the C code built by MSVC, which has to call it.
+ */
+static inline void nyra_sanitizer_memory_sampler_enable_from_env(void) {
+  const char *env = getenv("NYRA_MEMORY_SAMPLING_RATE");
+  if (!env) {
+    return;
+  }
+
+  long long rate = strtoll(env, NULL, 10);
+  if (rate > 0) {
+    nyra_sanitizer_memory_sampler_enable((size_t)rate);
+  }
+}
+
+#if defined(NYRA_ENABLE_MEMORY_SAMPLING) && \
+    (defined(__GNUC__) || defined(__clang__) || defined(__cplusplus))
+// Every translation unit gets a copy of it, it does not matter since it could
+// be called more than once.
+NYRA_CONSTRUCTOR(nyra_sanitizer_memory_sampler_init_from_env_) {
+  nyra_sanitizer_memory_sampler_enable_from_env();
+}
+#endif
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline int64_t nyra_sanitizer_memory_sampler_next_interval_(
+    nyra_sanitizer_memory_sampler_thread_state_t *state, int64_t rate) {
+  if (!state->rng) {
+    state->rng = (uint64_t)(uintptr_t)state ^ 0x9E3779B97F4A7C15ULL;
+  }
+
+  // xorshift64*
+  state->rng ^= state->rng >> 12;
+  state->rng ^= state->rng << 25;
+  state->rng ^= state->rng >> 27;
+  uint64_t r = state->rng * 0x2545F4914F6CDD1DULL;
+
+  // Uniform in (0, 1], then exponentially distributed with the mean of 'rate'.
+  double u = (double)((r >> 11) + 1) / 9007199254740992.0;
+  double interval = -log(u) * (double)rate;
+
+  return interval < 1.0 ? 1 : (int64_t)interval;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline size_t nyra_sanitizer_memory_sampler_bucket_of_(void *addr) {
+  uint64_t h = (uint64_t)(uintptr_t)addr * 0x9E3779B97F4A7C15ULL;
+  return (size_t)(h >> 32) % NYRA_SANITIZER_MEMORY_SAMPLER_BUCKET_CNT;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_sanitizer_memory_sampler_insert_(
+    nyra_sanitizer_memory_sample_t *sample) {
+  nyra_sanitizer_memory_sampler_bucket_t *bucket =
+      &nyra_sanitizer_memory_sampler
+           .buckets[nyra_sanitizer_memory_sampler_bucket_of_(sample->addr)];
+
+  nyra_spinlock_lock(&nyra_sanitizer_memory_sampler.lock);
+  sample->next = bucket->head;
+  bucket->head = sample;
+  nyra_atomic_add_fetch(&bucket->cnt, 1);
+  nyra_spinlock_unlock(&nyra_sanitizer_memory_sampler.lock);
+
+  nyra_atomic_add_fetch(&nyra_sanitizer_memory_sampler.sample_cnt, 1);
+  nyra_atomic_add_fetch(&nyra_sanitizer_memory_sampler.sample_bytes,
+                       (int64_t)sample->size);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static NYRA_NOINLINE NYRA_UNUSED void nyra_sanitizer_memory_sampler_record_(
+    void *addr, size_t size) {
+  // Do not go through 'nyra_malloc', the memory check would record the sample
+  // itself.
+  nyra_sanitizer_memory_sample_t *sample =
+      (nyra_sanitizer_memory_sample_t *)nyra_malloc_without_backtrace(
+          sizeof(nyra_sanitizer_memory_sample_t));
+  if (!sample) {
+    return;
+  }
+
+  // One more frame for this function itself.
+  void *stack[NYRA_SANITIZER_MEMORY_SAMPLER_MAX_DEPTH + 1];
+  int depth = 0;
+
+#if defined(NYRA_SANITIZER_MEMORY_SAMPLER_HAS_EXECINFO)
+  depth = backtrace(stack, NYRA_SANITIZER_MEMORY_SAMPLER_MAX_DEPTH + 1);
+#elif defined(_WIN32)
+  depth = (int)CaptureStackBackTrace(
+      0, NYRA_SANITIZER_MEMORY_SAMPLER_MAX_DEPTH + 1, stack, NULL);
+#endif
+
+  sample->depth = depth > 1 ? depth - 1 : 0;
+  memcpy(sample->stack, stack + 1, sizeof(void *) * (size_t)sample->depth);
+
+  sample->addr = addr;
+  sample->size = size;
+
+  nyra_sanitizer_memory_sampler_insert_(sample);
+}
+
+// Remove the sample of @a addr, and hand it over to the caller, NULL if it does
+// not have one.
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_sanitizer_memory_sample_t *
+nyra_sanitizer_memory_sampler_take_(void *addr) {
+  nyra_sanitizer_memory_sampler_bucket_t *bucket =
+      &nyra_sanitizer_memory_sampler
+           .buckets[nyra_sanitizer_memory_sampler_bucket_of_(addr)];
+
+  if (!nyra_atomic_load(&bucket->cnt)) {
+    return NULL;
+  }
+
+  nyra_sanitizer_memory_sample_t *found = NULL;
+
+  nyra_spinlock_lock(&nyra_sanitizer_memory_sampler.lock);
+  for (nyra_sanitizer_memory_sample_t **p = &bucket->head; *p;
+       p = &(*p)->next) {
+    if ((*p)->addr == addr) {
+      found = *p;
+      *p = found->next;
+      nyra_atomic_sub_fetch(&bucket->cnt, 1);
+      break;
+    }
+  }
+  nyra_spinlock_unlock(&nyra_sanitizer_memory_sampler.lock);
+
+  if (found) {
+    nyra_atomic_sub_fetch(&nyra_sanitizer_memory_sampler.sample_cnt, 1);
+    nyra_atomic_sub_fetch(&nyra_sanitizer_memory_sampler.sample_bytes,
+                         (int64_t)found->size);
+  }
+
+  return found;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_sanitizer_memory_sampler_forget_(void *addr) {
+  nyra_sanitizer_memory_sample_t *sample =
+      nyra_sanitizer_memory_sampler_take_(addr);
+  if (sample) {
+    nyra_free_without_backtrace(sample);
+  }
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_sanitizer_memory_sampler_on_alloc_(void *addr,
+                                                          size_t size) {
+  int64_t rate = nyra_atomic_load(&nyra_sanitizer_memory_sampler.rate);
+  if (!rate || !addr) {
+    return;
+  }
+
+  nyra_sanitizer_memory_sampler_thread_state_t *state =
+      &nyra_sanitizer_memory_sampler_thread_state;
+
+  if (!state->rng) {
+    // The first allocation of this thread.
+    state->bytes_until_sample =
+        nyra_sanitizer_memory_sampler_next_interval_(state, rate);
+  }
+
+  state->bytes_until_sample -= (int64_t)size;
+  if (state->bytes_until_sample > 0) {
+    return;
+  }
+
+  state->bytes_until_sample =
+      nyra_sanitizer_memory_sampler_next_interval_(state, rate);
+
+  nyra_sanitizer_memory_sampler_record_(addr, size);
+}
+
+/**
+ * @brief Malloc, and record the stack if it is the turn of a sample.
+ * @see NYRA_MALLOC
+ * @note Please free memory using nyra_sanitizer_memory_sample_free().
+ */
+static inline void *nyra_sanitizer_memory_sample_malloc(size_t size) {
+  void *p = nyra_malloc(size);
+  nyra_sanitizer_memory_sampler_on_alloc_(p, size);
+  return p;
+}
+
+static inline void *nyra_sanitizer_memory_sample_calloc(size_t cnt,
+                                                       size_t size) {
+  void *p = nyra_calloc(cnt, size);
+  nyra_sanitizer_memory_sampler_on_alloc_(p, cnt * size);
+  return p;
+}
+
+/**
+ * @brief Free memory, and drop its sample if it has one.
+ * @see nyra_free
+ */
+static inline void nyra_sanitizer_memory_sample_free(void *addr) {
+  if (!addr) {
+    return;
+  }
+
+  nyra_sanitizer_memory_sampler_forget_(addr);
+  nyra_free(addr);
+}
+
+static inline void *nyra_sanitizer_memory_sample_realloc(void *addr,
+                                                        size_t size) {
+  // The sample is taken out before the realloc, since another thread could get
+  // the same address once it has been released, but it is only dropped if the
+  // realloc succeeds.
+  nyra_sanitizer_memory_sample_t *sample =
+      addr ? nyra_sanitizer_memory_sampler_take_(addr) : NULL;
+
+  void *p = nyra_realloc(addr, size);
+  if (!p && size) {
+    // The old block is still alive.
+    if (sample) {
+      nyra_sanitizer_memory_sampler_insert_(sample);
+    }
+    return NULL;
+  }
+
+  if (sample) {
+    nyra_free_without_backtrace(sample);
+  }
+
+  nyra_sanitizer_memory_sampler_on_alloc_(p, size);
+  return p;
+}
+
+static inline char *nyra_sanitizer_memory_sample_strdup(const char *str) {
+  char *p = nyra_strdup(str);
+  nyra_sanitizer_memory_sampler_on_alloc_(p, p ? strlen(p) + 1 : 0);
+  return p;
+}
+
+static inline void nyra_sanitizer_memory_sampler_get_stats(
+    nyra_sanitizer_memory_sampler_stats_t *stats) {
+  NYRA_ASSERT(stats, "Invalid argument.");
+
+  stats->rate = (size_t)nyra_atomic_load(&nyra_sanitizer_memory_sampler.rate);
+  stats->sample_cnt =
+      (size_t)nyra_atomic_load(&nyra_sanitizer_memory_sampler.sample_cnt);
+  stats->sample_bytes =
+      (size_t)nyra_atomic_load(&nyra_sanitizer_memory_sampler.sample_bytes);
+}
+
+/**
+ * @brief Write the live samples to @a path as a heap profile in the legacy
+ * pprof format, which is understood by 'pprof' and 'go tool pprof'.
+ *
+ * @return false if the file could not be written.
+ */
+static inline bool nyra_sanitizer_memory_sampler_dump(const char *path) {
+  NYRA_ASSERT(path, "Invalid argument.");
+
+  FILE *fp = fopen(path, "w");
+  if (!fp) {
+    return false;
+  }
+
+  int64_t rate = nyra_atomic_load(&nyra_sanitizer_memory_sampler.rate);
+  if (!rate) {
+    rate = NYRA_SANITIZER_MEMORY_SAMPLER_DEFAULT_RATE;
+  }
+
+  // The samples are copied under the lock, so that none of them is freed
+  // meanwhile, and written after it is released, so that the sampled
+  // allocations and frees of the other threads do not wait for the file. The
+  // copy is allocated before taking the lock, and again if the samples have
+  // outgrown it meanwhile.
+  nyra_sanitizer_memory_sample_t *samples = NULL;
+  size_t total_cnt = 0;
+  size_t cap =
+      (size_t)nyra_atomic_load(&nyra_sanitizer_memory_sampler.sample_cnt) + 16;
+
+  for (;;) {
+    samples = (nyra_sanitizer_memory_sample_t *)nyra_malloc_without_backtrace(
+        cap * sizeof(nyra_sanitizer_memory_sample_t));
+    if (!samples) {
+      fclose(fp);
+      return false;
+    }
+
+    bool fits = true;
+    total_cnt = 0;
+
+    nyra_spinlock_lock(&nyra_sanitizer_memory_sampler.lock);
+    for (size_t i = 0; fits && i < NYRA_SANITIZER_MEMORY_SAMPLER_BUCKET_CNT;
+         ++i) {
+      for (nyra_sanitizer_memory_sample_t *sample =
+               nyra_sanitizer_memory_sampler.buckets[i].head;
+           sample; sample = sample->next) {
+        if (total_cnt == cap) {
+          fits = false;
+          break;
+        }
+        samples[total_cnt++] = *sample;
+      }
+    }
+    nyra_spinlock_unlock(&nyra_sanitizer_memory_sampler.lock);
+
+    if (fits) {
+      break;
+    }
+
+    nyra_free_without_backtrace(samples);
+    cap *= 2;
+  }
+
+  size_t total_bytes = 0;
+  for (size_t i = 0; i < total_cnt; ++i) {
+    total_bytes += samples[i].size;
+  }
+
+  fprintf(fp, "heap profile: %zu: %zu [%zu: %zu] @ heap_v2/%lld\n", total_cnt,
+          total_bytes, total_cnt, total_bytes, (long long)rate);
+
+  for (size_t i = 0; i < total_cnt; ++i) {
+    fprintf(fp, "1: %zu [1: %zu] @", samples[i].size, samples[i].size);
+    for (int j = 0; j < samples[i].depth; ++j) {
+      fprintf(fp, " %p", samples[i].stack[j]);
+    }
+    fprintf(fp, "\n");
+  }
+
+  nyra_free_without_backtrace(samples);
+
+#if defined(__linux__)
+  // pprof needs the mappings to symbolize the addresses.
+  FILE *maps = fopen("/proc/self/maps", "r");
+  if (maps) {
+    fprintf(fp, "\nMAPPED_LIBRARIES:\n");
+
+    char buf[4096];
+    size_t n = 0;
+    while ((n = fread(buf, 1, sizeof(buf), maps)) > 0) {
+      fwrite(buf, 1, n, fp);
+    }
+    fclose(maps);
+  }
+#endif
+
+  bool ok = !ferror(fp);
+  return fclose(fp) == 0 && ok;
+}
@@ -0,0 +1,584 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nyra_runtime/common/errno.h"
+#include "nyra_utils/container/list.h"
+#include "nyra_utils/container/list_node_ptr.h"
+#include "nyra_utils/lib/arena.h"
+#include "nyra_utils/lib/error.h"
+#include "nyra_utils/lib/hash.h"
+#include "nyra_utils/lib/string.h"
+#include "nyra_utils/macro/check.h"
+#include "nyra_utils/value/type.h"
+#include "nyra_utils/value/value.h"
+#include "nyra_utils/value/value_json_writer.h"
+#include "nyra_utils/value/value_kv.h"
+
+// An immutable copy of a 'nyra_value_t' laid out in a 'nyra_arena_t', for the
+// configurations which are merged over and over, ex: the defaults of an addon,
+// the properties of its node in the graph and the overrides of a session.
+//
+// The members of an object are in an array sorted by key, so two objects are
+// merged by walking both arrays once, and a member is found by a binary
+// search, instead of looking each key of one object up in the list of the
+// other. Nothing is freed one by one, a whole tree goes away with its arena.
+// The order the keys had is not kept: a flat value turned back into a
+// 'nyra_value_t' or a JSON text has its keys sorted.
+//
+// As a flat value is never modified, a merge shares the subtrees it does not
+// change with its inputs instead of copying them, so the arenas of the inputs
+// must live as long as the result.
+
+typedef struct nyra_value_flat_t nyra_value_flat_t;
+
+typedef struct nyra_value_flat_member_t {
+  const char *key;
+  size_t key_len;
+  const nyra_value_flat_t *value;
+} nyra_value_flat_member_t;
+
+struct nyra_value_flat_t {
+  NYRA_TYPE type;
+
+  // The bytes of a string, the members of an object or the items of an array.
+  size_t count;
+
+  union {
+    bool boolean;
+    int64_t int64;    // Any signed integer type.
+    uint64_t uint64;  // Any unsigned integer type.
+    double float64;   // Any floating point type.
+    const char *string;
+    const nyra_value_flat_member_t *members;
+    const nyra_value_flat_t *const *items;
+  } content;
+};
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void *nyra_value_flat_alloc_(nyra_arena_t *arena, size_t size) {
+  void *p = nyra_arena_alloc(arena, size ? size : 1);
+  NYRA_ASSERT(p, "Failed to allocate memory.");
+  return p;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline int nyra_value_flat_key_cmp_(const char *a, size_t a_len,
+                                           const char *b, size_t b_len) {
+  int rc = memcmp(a, b, a_len < b_len ? a_len : b_len);
+  if (rc) {
+    return rc;
+  }
+  return a_len < b_len ? -1 : (a_len > b_len ? 1 : 0);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline int nyra_value_flat_member_cmp_(const void *a, const void *b) {
+  const nyra_value_flat_member_t *ma = (const nyra_value_flat_member_t *)a;
+  const nyra_value_flat_member_t *mb = (const nyra_value_flat_member_t *)b;
+  return nyra_value_flat_key_cmp_(ma->key, ma->key_len, mb->key, mb->key_len);
+}
+
+/**
+ * @brief Copy @a value into @a arena. The keys of an object are unique, as in
+ * a 'nyra_value_t'.
+ *
+ * @return NULL if @a value holds a buf, a ptr or an invalid value, which a
+ * configuration could not have.
+ */
+static inline const nyra_value_flat_t *nyra_value_flat_from_value(
+    nyra_arena_t *arena, nyra_value_t *value, nyra_error_t *err) {
+  NYRA_ASSERT(arena && value, "Invalid argument.");
+
+  nyra_value_flat_t *flat =
+      (nyra_value_flat_t *)nyra_value_flat_alloc_(arena, sizeof(*flat));
+  flat->type = value->type;
+  flat->count = 0;
+
+  switch (value->type) {
+    case NYRA_TYPE_NULL:
+      flat->content.uint64 = 0;
+      return flat;
+
+    case NYRA_TYPE_BOOL:
+      flat->content.boolean = value->content.boolean;
+      return flat;
+
+    case NYRA_TYPE_INT8:
+      flat->content.int64 = value->content.int8;
+      return flat;
+    case NYRA_TYPE_INT16:
+      flat->content.int64 = value->content.int16;
+      return flat;
+    case NYRA_TYPE_INT32:
+      flat->content.int64 = value->content.int32;
+      return flat;
+    case NYRA_TYPE_INT64:
+      flat->content.int64 = value->content.int64;
+      return flat;
+    case NYRA_TYPE_UINT8:
+      flat->content.uint64 = value->content.uint8;
+      return flat;
+    case NYRA_TYPE_UINT16:
+      flat->content.uint64 = value->content.uint16;
+      return flat;
+    case NYRA_TYPE_UINT32:
+      flat->content.uint64 = value->content.uint32;
+      return flat;
+    case NYRA_TYPE_UINT64:
+      flat->content.uint64 = value->content.uint64;
+      return flat;
+    case NYRA_TYPE_FLOAT32:
+      flat->content.float64 = value->content.float32;
+      return flat;
+    case NYRA_TYPE_FLOAT64:
+      flat->content.float64 = value->content.float64;
+      return flat;
+
+    case NYRA_TYPE_STRING:
+      flat->count = value->content.string.first_unused_idx;
+      flat->content.string = nyra_arena_strndup(
+          arena, value->content.string.buf, flat->count);
+      NYRA_ASSERT(flat->content.string, "Failed to allocate memory.");
+      return flat;
+
+    case NYRA_TYPE_ARRAY: {
+      flat->count = nyra_list_size(&value->content.array);
+      const nyra_value_flat_t **items =
+          (const nyra_value_flat_t **)nyra_value_flat_alloc_(
+              arena, flat->count * sizeof(*items));
+
+      size_t i = 0;
+      for (nyra_listnode_t *node = value->content.array.front; node;
+           node = node->next) {
+        items[i] = nyra_value_flat_from_value(
+            arena, (nyra_value_t *)((nyra_ptr_listnode_t *)node)->ptr, err);
+        if (!items[i++]) {
+          return NULL;
+        }
+      }
+
+      flat->content.items = items;
+      return flat;
+    }
+
+    case NYRA_TYPE_OBJECT: {
+      flat->count = nyra_list_size(&value->content.object);
+      nyra_value_flat_member_t *members =
+          (nyra_value_flat_member_t *)nyra_value_flat_alloc_(
+              arena, flat->count * sizeof(*members));
+
+      size_t i = 0;
+      for (nyra_listnode_t *node = value->content.object.front; node;
+           node = node->next) {
+        nyra_value_kv_t *kv =
+            (nyra_value_kv_t *)((nyra_ptr_listnode_t *)node)->ptr;
+
+        members[i].key_len = kv->key.first_unused_idx;
+        members[i].key =
+            nyra_arena_strndup(arena, kv->key.buf, members[i].key_len);
+        NYRA_ASSERT(members[i].key, "Failed to allocate memory.");
+
+        members[i].value = nyra_value_flat_from_value(arena, kv->value, err);
+        if (!members[i++].value) {
+          return NULL;
+        }
+      }
+
+      qsort(members, flat->count, sizeof(*members),
+            nyra_value_flat_member_cmp_);
+
+      flat->content.members = members;
+      return flat;
+    }
+
+    default:
+      if (err) {
+        nyra_error_set(err, NYRA_ERRNO_INVALID_TYPE,
+                      "A buf, a ptr or an invalid value could not be "
+                      "flattened.");
+      }
+      return NULL;
+  }
+}
+
+/**
+ * @brief The value of the member @a key of the object @a self, NULL if there
+ * is none.
+ */
+static inline const nyra_value_flat_t *nyra_value_flat_object_peek(
+    const nyra_value_flat_t *self, const char *key) {
+  NYRA_ASSERT(self && key, "Invalid argument.");
+
+  if (self->type != NYRA_TYPE_OBJECT) {
+    return NULL;
+  }
+
+  size_t key_len = strlen(key);
+  size_t lo = 0;
+  size_t hi = self->count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    const nyra_value_flat_member_t *member = &self->content.members[mid];
+
+    int rc = nyra_value_flat_key_cmp_(member->key, member->key_len, key,
+                                      key_len);
+    if (rc == 0) {
+      return member->value;
+    }
+    if (rc < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Merge @a overrides onto @a base: the members of two objects are
+ * merged recursively, anything else in @a overrides replaces what is in
+ * @a base. Either could be NULL.
+ *
+ * It is the merge of 'nyra_value_object_merge_with_clone(base, overrides)',
+ * not the one of 'nyra_json_object_update_missing()', which only adds the keys
+ * missing at the top level.
+ *
+ * @return The merged value, which shares the subtrees left as they were with
+ * @a base and @a overrides. The members of its objects are in the order of
+ * their keys.
+ */
+static inline const nyra_value_flat_t *nyra_value_flat_merge(
+    nyra_arena_t *arena, const nyra_value_flat_t *base,
+    const nyra_value_flat_t *overrides) {
+  NYRA_ASSERT(arena, "Invalid argument.");
+
+  if (!base) {
+    return overrides;
+  }
+  if (!overrides) {
+    return base;
+  }
+  if (base->type != NYRA_TYPE_OBJECT || overrides->type != NYRA_TYPE_OBJECT) {
+    return overrides;
+  }
+  if (!overrides->count) {
+    return base;
+  }
+  if (!base->count) {
+    return overrides;
+  }
+
+  nyra_value_flat_member_t *members =
+      (nyra_value_flat_member_t *)nyra_value_flat_alloc_(
+          arena, (base->count + overrides->count) * sizeof(*members));
+
+  size_t i = 0;
+  size_t j = 0;
+  size_t n = 0;
+  while (i < base->count || j < overrides->count) {
+    int rc = 0;
+    if (i == base->count) {
+      rc = 1;
+    } else if (j == overrides->count) {
+      rc = -1;
+    } else {
+      rc = nyra_value_flat_member_cmp_(&base->content.members[i],
+                                       &overrides->content.members[j]);
+    }
+
+    if (rc < 0) {
+      members[n++] = base->content.members[i++];
+    } else if (rc > 0) {
+      members[n++] = overrides->content.members[j++];
+    } else {
+      members[n] = base->content.members[i++];
+      members[n].value = nyra_value_flat_merge(
+          arena, members[n].value, overrides->content.members[j++].value);
+      n++;
+    }
+  }
+
+  nyra_value_flat_t *merged =
+      (nyra_value_flat_t *)nyra_value_flat_alloc_(arena, sizeof(*merged));
+  merged->type = NYRA_TYPE_OBJECT;
+  merged->count = n;
+  merged->content.members = members;
+
+  return merged;
+}
+
+static inline bool nyra_value_flat_is_equal(const nyra_value_flat_t *a,
+                                            const nyra_value_flat_t *b) {
+  NYRA_ASSERT(a && b, "Invalid argument.");
+
+  if (a == b) {
+    return true;
+  }
+  if (a->type != b->type || a->count != b->count) {
+    return false;
+  }
+
+  switch (a->type) {
+    case NYRA_TYPE_NULL:
+      return true;
+    case NYRA_TYPE_BOOL:
+      return a->content.boolean == b->content.boolean;
+    case NYRA_TYPE_FLOAT32:
+    case NYRA_TYPE_FLOAT64:
+      return a->content.float64 == b->content.float64;
+    case NYRA_TYPE_STRING:
+      return memcmp(a->content.string, b->content.string, a->count) == 0;
+
+    case NYRA_TYPE_ARRAY:
+      for (size_t i = 0; i < a->count; ++i) {
+        if (!nyra_value_flat_is_equal(a->content.items[i],
+                                      b->content.items[i])) {
+          return false;
+        }
+      }
+      return true;
+
+    case NYRA_TYPE_OBJECT:
+      for (size_t i = 0; i < a->count; ++i) {
+        const nyra_value_flat_member_t *ma = &a->content.members[i];
+        const nyra_value_flat_member_t *mb = &b->content.members[i];
+        if (ma->key_len != mb->key_len ||
+            memcmp(ma->key, mb->key, ma->key_len) != 0 ||
+            !nyra_value_flat_is_equal(ma->value, mb->value)) {
+          return false;
+        }
+      }
+      return true;
+
+    default:
+      // The integers.
+      return a->content.uint64 == b->content.uint64;
+  }
+}
+
+/**
+ * @brief A hash of @a self, the same for the values which are equal by
+ * 'nyra_value_flat_is_equal()'.
+ */
+static inline uint64_t nyra_value_flat_hash(const nyra_value_flat_t *self,
+                                            uint64_t seed) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  uint64_t hash = nyra_hash_u64_with_seed((uint64_t)self->type, seed);
+  hash = nyra_hash_u64_with_seed((uint64_t)self->count, hash);
+
+  switch (self->type) {
+    case NYRA_TYPE_NULL:
+      return hash;
+    case NYRA_TYPE_BOOL:
+      return nyra_hash_u64_with_seed(self->content.boolean ? 1 : 0, hash);
+    case NYRA_TYPE_FLOAT32:
+    case NYRA_TYPE_FLOAT64: {
+      // 0.0 and -0.0 are equal.
+      double d = self->content.float64 == 0 ? 0 : self->content.float64;
+      uint64_t bits = 0;
+      memcpy(&bits, &d, sizeof(bits));
+      return nyra_hash_u64_with_seed(bits, hash);
+    }
+    case NYRA_TYPE_STRING:
+      return nyra_hash_bytes_with_seed(self->content.string, self->count, hash);
+
+    case NYRA_TYPE_ARRAY:
+      for (size_t i = 0; i < self->count; ++i) {
+        hash = nyra_value_flat_hash(self->content.items[i], hash);
+      }
+      return hash;
+
+    case NYRA_TYPE_OBJECT:
+      for (size_t i = 0; i < self->count; ++i) {
+        const nyra_value_flat_member_t *member = &self->content.members[i];
+        hash = nyra_hash_bytes_with_seed(member->key, member->key_len, hash);
+        hash = nyra_value_flat_hash(member->value, hash);
+      }
+      return hash;
+
+    default:
+      return nyra_hash_u64_with_seed(self->content.uint64, hash);
+  }
+}
+
+/**
+ * @brief Create a 'nyra_value_t' holding @a self, which is owned by the
+ * caller. The members of its objects are in the order of their keys, not in
+ * the one of the value @a self has been made from.
+ */
+static inline nyra_value_t *nyra_value_flat_to_value(
+    const nyra_value_flat_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  switch (self->type) {
+    case NYRA_TYPE_NULL:
+      return nyra_value_create_null();
+    case NYRA_TYPE_BOOL:
+      return nyra_value_create_bool(self->content.boolean);
+    case NYRA_TYPE_INT8:
+      return nyra_value_create_int8((int8_t)self->content.int64);
+    case NYRA_TYPE_INT16:
+      return nyra_value_create_int16((int16_t)self->content.int64);
+    case NYRA_TYPE_INT32:
+      return nyra_value_create_int32((int32_t)self->content.int64);
+    case NYRA_TYPE_INT64:
+      return nyra_value_create_int64(self->content.int64);
+    case NYRA_TYPE_UINT8:
+      return nyra_value_create_uint8((uint8_t)self->content.uint64);
+    case NYRA_TYPE_UINT16:
+      return nyra_value_create_uint16((uint16_t)self->content.uint64);
+    case NYRA_TYPE_UINT32:
+      return nyra_value_create_uint32((uint32_t)self->content.uint64);
+    case NYRA_TYPE_UINT64:
+      return nyra_value_create_uint64(self->content.uint64);
+    case NYRA_TYPE_FLOAT32:
+      return nyra_value_create_float32((float)self->content.float64);
+    case NYRA_TYPE_FLOAT64:
+      return nyra_value_create_float64(self->content.float64);
+    case NYRA_TYPE_STRING:
+      return nyra_value_create_string_with_size(self->content.string,
+                                               self->count);
+
+    case NYRA_TYPE_ARRAY: {
+      nyra_list_t items;
+      nyra_list_init(&items);
+      for (size_t i = 0; i < self->count; ++i) {
+        nyra_list_push_ptr_back(
+            &items, nyra_value_flat_to_value(self->content.items[i]),
+            (nyra_ptr_listnode_destroy_func_t)nyra_value_destroy);
+      }
+      return nyra_value_create_array_with_move(&items);
+    }
+
+    case NYRA_TYPE_OBJECT: {
+      nyra_list_t kvs;
+      nyra_list_init(&kvs);
+      for (size_t i = 0; i < self->count; ++i) {
+        const nyra_value_flat_member_t *member = &self->content.members[i];
+
+        // 'nyra_value_kv_create()' takes the key as a format, which a key with
+        // a '%' in it would be mistaken for.
+        nyra_value_kv_t *kv = nyra_value_kv_create_empty("");
+        if (member->key_len) {
+          nyra_string_set_from_c_str(&kv->key, member->key, member->key_len);
+        }
+        kv->value = nyra_value_flat_to_value(member->value);
+
+        nyra_list_push_ptr_back(
+            &kvs, kv, (nyra_ptr_listnode_destroy_func_t)nyra_value_kv_destroy);
+      }
+      return nyra_value_create_object_with_move(&kvs);
+    }
+
+    default:
+      NYRA_ASSERT(0, "Should not happen.");
+      return NULL;
+  }
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_value_flat_write_json_(nyra_value_json_writer_t *writer,
+                                               const nyra_value_flat_t *self) {
+  switch (self->type) {
+    case NYRA_TYPE_NULL:
+      nyra_value_json_writer_put_(writer, "null", 4);
+      return true;
+
+    case NYRA_TYPE_BOOL:
+      if (self->content.boolean) {
+        nyra_value_json_writer_put_(writer, "true", 4);
+      } else {
+        nyra_value_json_writer_put_(writer, "false", 5);
+      }
+      return true;
+
+    case NYRA_TYPE_INT8:
+    case NYRA_TYPE_INT16:
+    case NYRA_TYPE_INT32:
+    case NYRA_TYPE_INT64:
+      nyra_value_json_writer_int_(writer, self->content.int64);
+      return true;
+
+    case NYRA_TYPE_UINT8:
+    case NYRA_TYPE_UINT16:
+    case NYRA_TYPE_UINT32:
+    case NYRA_TYPE_UINT64:
+      nyra_value_json_writer_uint_(writer, self->content.uint64);
+      return true;
+
+    case NYRA_TYPE_FLOAT32:
+    case NYRA_TYPE_FLOAT64:
+      return nyra_value_json_writer_real_(writer, self->content.float64);
+
+    case NYRA_TYPE_STRING:
+      nyra_value_json_writer_string_(writer, self->content.string,
+                                     self->count);
+      return true;
+
+    case NYRA_TYPE_ARRAY:
+      nyra_value_json_writer_put_(writer, "[", 1);
+      for (size_t i = 0; i < self->count; ++i) {
+        if (i) {
+          nyra_value_json_writer_put_(writer, ", ", 2);
+        }
+        if (!nyra_value_flat_write_json_(writer, self->content.items[i])) {
+          return false;
+        }
+      }
+      nyra_value_json_writer_put_(writer, "]", 1);
+      return true;
+
+    case NYRA_TYPE_OBJECT:
+      nyra_value_json_writer_put_(writer, "{", 1);
+      for (size_t i = 0; i < self->count; ++i) {
+        const nyra_value_flat_member_t *member = &self->content.members[i];
+        if (i) {
+          nyra_value_json_writer_put_(writer, ", ", 2);
+        }
+        nyra_value_json_writer_string_(writer, member->key, member->key_len);
+        nyra_value_json_writer_put_(writer, ": ", 2);
+        if (!nyra_value_flat_write_json_(writer, member->value)) {
+          return false;
+        }
+      }
+      nyra_value_json_writer_put_(writer, "}", 1);
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Append the JSON text of @a self to the buffer of @a writer, the
+ * members of the objects in the order of their keys.
+ *
+ * @return false if @a self holds a NaN or an infinity, then the buffer is back
+ * to its size before the call.
+ */
+static inline bool nyra_value_flat_write_json(nyra_value_json_writer_t *writer,
+                                              const nyra_value_flat_t *self) {
+  NYRA_ASSERT(writer && writer->grow && self, "Invalid argument.");
+
+  size_t size = writer->size;
+  if (!nyra_value_flat_write_json_(writer, self)) {
+    writer->size = size;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,477 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nyra_utils/container/list.h"
+#include "nyra_utils/container/list_ptr.h"
+#include "nyra_utils/lib/alloc.h"
+#include "nyra_utils/lib/error.h"
+#include "nyra_utils/lib/signature.h"
+#include "nyra_utils/lib/string.h"
+#include "nyra_utils/macro/check.h"
+#include "nyra_utils/value/value.h"
+#include "nyra_utils/value/value_get.h"
+#include "nyra_utils/value/value_json_parser.h"
+#include "nyra_utils/value/value_object.h"
+
+#define NYRA_VALUE_JSON_LAZY_SIGNATURE 0x2E5D7C41A9B3F068U
+
+// The properties of a message which came as JSON, ex: from another app, kept
+// as their JSON text rather than being turned into a tree of values up front.
+//
+// Peeking a path finds the bytes of its value by skipping over the others,
+// which are only checked for their structure, and parses that value alone.
+// It is then cached, so a destination which reads two fields of a big payload
+// only pays for those two. A message which is forwarded as it is could be
+// sent from 'nyra_value_json_lazy_get_raw()', without being parsed and written
+// again.
+//
+// As the skipped parts are not fully parsed, an error in them, ex: an invalid
+// escape, is only reported by 'nyra_value_json_lazy_materialize()'.
+
+typedef struct nyra_value_json_lazy_entry_t {
+  char *path;
+  nyra_value_t *value;
+} nyra_value_json_lazy_entry_t;
+
+typedef struct nyra_value_json_lazy_t {
+  nyra_signature_t signature;
+
+  char *json;
+  size_t len;
+
+  // The values which have been peeked by their path, which are valid until the
+  // document is deinitted.
+  nyra_list_t cache;
+
+  // The whole document, once it has been materialized.
+  nyra_value_t *root;
+} nyra_value_json_lazy_t;
+
+static inline bool nyra_value_json_lazy_check_integrity(
+    nyra_value_json_lazy_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  return nyra_signature_get(&self->signature) ==
+         NYRA_VALUE_JSON_LAZY_SIGNATURE;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_value_json_lazy_entry_destroy_(
+    nyra_value_json_lazy_entry_t *entry) {
+  NYRA_FREE_(entry->path);
+  if (entry->value) {
+    nyra_value_destroy(entry->value);
+  }
+  NYRA_FREE_(entry);
+}
+
+/**
+ * @brief Keep a copy of the @a len bytes of JSON at @a json, which are not
+ * parsed yet.
+ */
+static inline void nyra_value_json_lazy_init(nyra_value_json_lazy_t *self,
+                                             const char *json, size_t len) {
+  NYRA_ASSERT(self && (json || !len), "Invalid argument.");
+
+  nyra_signature_set(&self->signature, NYRA_VALUE_JSON_LAZY_SIGNATURE);
+
+  self->json = (char *)NYRA_MALLOC(len + 1);
+  NYRA_ASSERT(self->json, "Failed to allocate memory.");
+  if (len) {
+    memcpy(self->json, json, len);
+  }
+  self->json[len] = '\0';
+  self->len = len;
+
+  nyra_list_init(&self->cache);
+  self->root = NULL;
+}
+
+static inline void nyra_value_json_lazy_deinit(nyra_value_json_lazy_t *self) {
+  NYRA_ASSERT(self && nyra_value_json_lazy_check_integrity(self),
+             "Invalid argument.");
+
+  nyra_list_clear(&self->cache);
+  if (self->root) {
+    nyra_value_destroy(self->root);
+    self->root = NULL;
+  }
+
+  NYRA_FREE_(self->json);
+  self->json = NULL;
+  self->len = 0;
+
+  nyra_signature_set(&self->signature, 0);
+}
+
+/**
+ * @brief The JSON text as it has been received, ex: to forward it.
+ */
+static inline const char *nyra_value_json_lazy_get_raw(
+    nyra_value_json_lazy_t *self, size_t *len) {
+  NYRA_ASSERT(self && nyra_value_json_lazy_check_integrity(self),
+             "Invalid argument.");
+
+  if (len) {
+    *len = self->len;
+  }
+  return self->json;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_value_json_lazy_skip_string_(
+    nyra_value_json_parser_t *parser) {
+  const char *p = parser->pos + 1;
+
+  for (;;) {
+    p += nyra_value_json_parser_scan_plain_(p, parser->end);
+    if (p >= parser->end) {
+      parser->pos = p;
+      nyra_value_json_parser_fail_(parser,
+                                   "premature end of input in a string");
+      return false;
+    }
+
+    unsigned char c = (unsigned char)*p;
+    if (c == '"') {
+      parser->pos = p + 1;
+      return true;
+    }
+    if (c == '\\') {
+      p += 2;
+    } else if (c < 0x20) {
+      parser->pos = p;
+      nyra_value_json_parser_fail_(parser, "control character in a string");
+      return false;
+    } else {
+      // Not ASCII, which is validated when the string is parsed.
+      ++p;
+    }
+  }
+}
+
+/**
+ * @brief Move past the value at the position of @a parser, only checking that
+ * its strings and brackets are closed.
+ */
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_value_json_lazy_skip_value_(
+    nyra_value_json_parser_t *parser) {
+  if (parser->pos >= parser->end) {
+    nyra_value_json_parser_fail_(parser, "premature end of input");
+    return false;
+  }
+
+  char c = *parser->pos;
+
+  if (c == '"') {
+    return nyra_value_json_lazy_skip_string_(parser);
+  }
+
+  if (c == '{' || c == '[') {
+    size_t depth = 0;
+
+    while (parser->pos < parser->end) {
+      c = *parser->pos;
+      if (c == '"') {
+        if (!nyra_value_json_lazy_skip_string_(parser)) {
+          return false;
+        }
+        continue;
+      }
+
+      if (c == '{' || c == '[') {
+        if (++depth > NYRA_VALUE_JSON_PARSER_MAX_DEPTH) {
+          nyra_value_json_parser_fail_(parser,
+                                       "maximum parsing depth reached");
+          return false;
+        }
+      } else if (c == '}' || c == ']') {
+        if (--depth == 0) {
+          ++parser->pos;
+          return true;
+        }
+      }
+      ++parser->pos;
+    }
+
+    nyra_value_json_parser_fail_(parser, "premature end of input");
+    return false;
+  }
+
+  // A number or a literal.
+  const char *start = parser->pos;
+  while (parser->pos < parser->end) {
+    c = *parser->pos;
+    if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\n' ||
+        c == '\r' || c == '\t') {
+      break;
+    }
+    ++parser->pos;
+  }
+  if (parser->pos == start) {
+    nyra_value_json_parser_fail_(parser, "invalid token");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Move to the value of the key @a name of the object at the position of
+ * @a parser. As in a parsed object, the last one of the duplicated keys wins.
+ *
+ * @return false if it is not found, or on error.
+ */
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_value_json_lazy_find_key_(
+    nyra_value_json_parser_t *parser, const char *name, size_t name_len) {
+  if (parser->pos >= parser->end || *parser->pos != '{') {
+    return false;
+  }
+
+  const char *found = NULL;
+
+  ++parser->pos;
+  nyra_value_json_parser_skip_ws_(parser);
+  if (parser->pos < parser->end && *parser->pos == '}') {
+    return false;
+  }
+
+  for (;;) {
+    if (parser->pos >= parser->end || *parser->pos != '"') {
+      nyra_value_json_parser_fail_(parser, "string or '}' expected");
+      return false;
+    }
+
+    size_t key_len = 0;
+    const char *key =
+        nyra_value_json_parser_parse_string_(parser, false, &key_len);
+    if (!key) {
+      return false;
+    }
+    bool match = key_len == name_len && memcmp(key, name, name_len) == 0;
+
+    nyra_value_json_parser_skip_ws_(parser);
+    if (parser->pos >= parser->end || *parser->pos != ':') {
+      nyra_value_json_parser_fail_(parser, "':' expected");
+      return false;
+    }
+    ++parser->pos;
+    nyra_value_json_parser_skip_ws_(parser);
+
+    if (match) {
+      found = parser->pos;
+    }
+    if (!nyra_value_json_lazy_skip_value_(parser)) {
+      return false;
+    }
+
+    nyra_value_json_parser_skip_ws_(parser);
+    if (parser->pos >= parser->end) {
+      nyra_value_json_parser_fail_(parser, "'}' expected");
+      return false;
+    }
+
+    char c = *parser->pos++;
+    if (c == '}') {
+      break;
+    }
+    if (c != ',') {
+      --parser->pos;
+      nyra_value_json_parser_fail_(parser, "'}' expected");
+      return false;
+    }
+    nyra_value_json_parser_skip_ws_(parser);
+  }
+
+  if (!found) {
+    return false;
+  }
+  parser->pos = found;
+  return true;
+}
+
+/**
+ * @brief Move to the item @a index of the array at the position of @a parser.
+ *
+ * @return false if it is not found, or on error.
+ */
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_value_json_lazy_find_index_(
+    nyra_value_json_parser_t *parser, size_t index) {
+  if (parser->pos >= parser->end || *parser->pos != '[') {
+    return false;
+  }
+
+  ++parser->pos;
+  nyra_value_json_parser_skip_ws_(parser);
+  if (parser->pos < parser->end && *parser->pos == ']') {
+    return false;
+  }
+
+  for (size_t i = 0;; ++i) {
+    if (i == index) {
+      return true;
+    }
+
+    if (!nyra_value_json_lazy_skip_value_(parser)) {
+      return false;
+    }
+
+    nyra_value_json_parser_skip_ws_(parser);
+    if (parser->pos >= parser->end) {
+      nyra_value_json_parser_fail_(parser, "']' expected");
+      return false;
+    }
+
+    char c = *parser->pos++;
+    if (c == ']') {
+      return false;
+    }
+    if (c != ',') {
+      --parser->pos;
+      nyra_value_json_parser_fail_(parser, "']' expected");
+      return false;
+    }
+    nyra_value_json_parser_skip_ws_(parser);
+  }
+}
+
+/**
+ * @brief Parse the value at @a path, ex: "a.b[2].c", out of the JSON text.
+ *
+ * @return The value, which the caller owns, or NULL if there is none at
+ * @a path, or on error, then @a err tells why.
+ */
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_value_t *nyra_value_json_lazy_parse_path_(
+    nyra_value_json_lazy_t *self, const char *path, nyra_error_t *err) {
+  nyra_value_json_parser_t parser;
+  parser.begin = self->json;
+  parser.pos = self->json;
+  parser.end = self->json + self->len;
+  parser.err = err;
+  parser.failed = false;
+  parser.depth = 0;
+  parser.scratch = parser.scratch_buf;
+  parser.scratch_size = sizeof(parser.scratch_buf);
+
+  nyra_value_t *value = NULL;
+  const char *p = path;
+
+  nyra_value_json_parser_skip_ws_(&parser);
+
+  while (*p) {
+    bool found = false;
+
+    if (*p == '[') {
+      char *index_end = NULL;
+      unsigned long long index = strtoull(p + 1, &index_end, 10);
+      if (index_end == p + 1 || *index_end != ']') {
+        if (err) {
+          nyra_error_set(err, NYRA_VALUE_JSON_PARSER_ERRNO,
+                         "Invalid path: %s", path);
+        }
+        goto done;
+      }
+      found = nyra_value_json_lazy_find_index_(&parser, (size_t)index);
+      p = index_end + 1;
+    } else {
+      if (*p == '.') {
+        ++p;
+      }
+      size_t name_len = strcspn(p, ".[");
+      found = nyra_value_json_lazy_find_key_(&parser, p, name_len);
+      p += name_len;
+    }
+
+    if (!found) {
+      goto done;
+    }
+    nyra_value_json_parser_skip_ws_(&parser);
+  }
+
+  value = nyra_value_json_parser_parse_value_(&parser);
+
+done:
+  if (parser.scratch != parser.scratch_buf) {
+    NYRA_FREE_(parser.scratch);
+  }
+  return value;
+}
+
+/**
+ * @brief Parse the whole document, which the values peeked afterwards come
+ * from. An error anywhere in the text is reported here.
+ *
+ * @return The document, which @a self owns, or NULL if it is not valid JSON.
+ */
+static inline nyra_value_t *nyra_value_json_lazy_materialize(
+    nyra_value_json_lazy_t *self, nyra_error_t *err) {
+  NYRA_ASSERT(self && nyra_value_json_lazy_check_integrity(self),
+             "Invalid argument.");
+
+  if (!self->root) {
+    self->root = nyra_value_from_json_str_with_len(self->json, self->len, err);
+  }
+  return self->root;
+}
+
+/**
+ * @brief Get the value at @a path, which is parsed on the first call for this
+ * path, and cached.
+ *
+ * @param path A path like "a.b[2].c". The whole document for NULL or "".
+ *
+ * @return The value, which @a self owns until it is deinitted, or NULL if
+ * there is none at @a path, or on error, then @a err tells why.
+ */
+static inline nyra_value_t *nyra_value_json_lazy_peek(
+    nyra_value_json_lazy_t *self, const char *path, nyra_error_t *err) {
+  NYRA_ASSERT(self && nyra_value_json_lazy_check_integrity(self),
+             "Invalid argument.");
+
+  if (!path || !*path) {
+    return nyra_value_json_lazy_materialize(self, err);
+  }
+
+  nyra_list_foreach (&self->cache, iter) {
+    nyra_value_json_lazy_entry_t *entry =
+        (nyra_value_json_lazy_entry_t *)nyra_ptr_listnode_get(iter.node);
+    if (strcmp(entry->path, path) == 0) {
+      return entry->value;
+    }
+  }
+
+  nyra_value_t *value = nyra_value_json_lazy_parse_path_(self, path, err);
+  if (!value) {
+    return NULL;
+  }
+
+  nyra_value_json_lazy_entry_t *entry = (nyra_value_json_lazy_entry_t *)
+      NYRA_MALLOC(sizeof(nyra_value_json_lazy_entry_t));
+  NYRA_ASSERT(entry, "Failed to allocate memory.");
+
+  size_t path_len = strlen(path);
+  entry->path = (char *)NYRA_MALLOC(path_len + 1);
+  NYRA_ASSERT(entry->path, "Failed to allocate memory.");
+  memcpy(entry->path, path, path_len + 1);
+  entry->value = value;
+
+  nyra_list_push_ptr_back(
+      &self->cache, entry,
+      (nyra_ptr_listnode_destroy_func_t)nyra_value_json_lazy_entry_destroy_);
+
+  return value;
+}
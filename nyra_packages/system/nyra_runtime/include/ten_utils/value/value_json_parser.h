@@ -0,0 +1,899 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <locale.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define NYRA_VALUE_JSON_PARSER_USE_SSE2
+#endif
+
+#include "nyra_utils/container/flat_hash_table.h"
+#include "nyra_utils/container/list.h"
+#include "nyra_utils/container/list_ptr.h"
+#include "nyra_utils/lib/alloc.h"
+#include "nyra_utils/lib/error.h"
+#include "nyra_utils/lib/string.h"
+#include "nyra_utils/macro/check.h"
+#include "nyra_utils/macro/mark.h"
+#include "nyra_utils/value/value.h"
+#include "nyra_utils/value/value_kv.h"
+
+// Parse a JSON text straight into a 'nyra_value_t', without building the
+// 'nyra_json_t' tree which 'nyra_json_from_string()' + 'nyra_value_from_json()'
+// go through, and then throw away.
+//
+// The input is walked once. The runs of plain characters in the strings,
+// which make most of the property files and of the LLM payloads, are skipped
+// 16 bytes at a time with SSE2, or 8 bytes at a time otherwise. A string
+// without escapes is not copied before its value is created.
+//
+// It produces the same values as 'nyra_value_from_json()':
+//
+// - an integer is a 'uint64' if it is not negative, an 'int64' otherwise, and
+//   has to fit in an 'int64' either way.
+// - a number with a fraction or an exponent is a 'float64'.
+// - when a key appears twice in an object, the last value wins, at the
+//   position of the first one.
+//
+// And it rejects what the tree parser rejects, ex: invalid UTF-8, '\u0000',
+// unpaired surrogates, leading zeros, or a nesting deeper than
+// 'NYRA_VALUE_JSON_PARSER_MAX_DEPTH'.
+
+#define NYRA_VALUE_JSON_PARSER_MAX_DEPTH 2048
+
+// The errno which the JSON functions of this library report, the
+// 'NYRA_ERRNO_INVALID_JSON' of the runtime.
+#define NYRA_VALUE_JSON_PARSER_ERRNO 2
+
+#define NYRA_VALUE_JSON_PARSER_SCRATCH_SIZE 256
+
+// An object gets an index of its keys to find the duplicated ones once it has
+// that many keys, below that a linear search is cheaper.
+#define NYRA_VALUE_JSON_PARSER_INDEX_THRESHOLD 16
+
+typedef struct nyra_value_json_parser_t {
+  const char *begin;
+  const char *pos;
+  const char *end;
+
+  nyra_error_t *err;
+  bool failed;
+
+  size_t depth;
+
+  // The decoded strings which could not be used in place, ex: the ones with
+  // escapes, and the keys which need a '\0'.
+  char *scratch;
+  size_t scratch_size;
+  char scratch_buf[NYRA_VALUE_JSON_PARSER_SCRATCH_SIZE];
+} nyra_value_json_parser_t;
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void *nyra_value_json_parser_fail_(
+    nyra_value_json_parser_t *self, const char *reason) {
+  if (!self->failed) {
+    self->failed = true;
+    if (self->err) {
+      nyra_error_set(self->err, NYRA_VALUE_JSON_PARSER_ERRNO,
+                     "Failed to parse JSON at offset %zu: %s",
+                     (size_t)(self->pos - self->begin), reason);
+    }
+  }
+  return NULL;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline char *nyra_value_json_parser_reserve_(
+    nyra_value_json_parser_t *self, size_t used, size_t more) {
+  if (used + more > self->scratch_size) {
+    size_t size = self->scratch_size * 2;
+    while (size < used + more) {
+      size *= 2;
+    }
+
+    char *scratch = NULL;
+    if (self->scratch == self->scratch_buf) {
+      scratch = (char *)NYRA_MALLOC(size);
+      NYRA_ASSERT(scratch, "Failed to allocate memory.");
+      memcpy(scratch, self->scratch_buf, used);
+    } else {
+      scratch = (char *)NYRA_REALLOC(self->scratch, size);
+      NYRA_ASSERT(scratch, "Failed to allocate memory.");
+    }
+
+    self->scratch = scratch;
+    self->scratch_size = size;
+  }
+
+  return self->scratch + used;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_value_json_parser_skip_ws_(
+    nyra_value_json_parser_t *self) {
+  const char *p = self->pos;
+  while (p < self->end &&
+         (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+    ++p;
+  }
+  self->pos = p;
+}
+
+/**
+ * @brief The offset of the first byte in [p, end) which is '"', '\\', a
+ * control character or not ASCII, or 'end - p' if there is none.
+ */
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline size_t nyra_value_json_parser_scan_plain_(const char *p,
+                                                        const char *end) {
+  const char *start = p;
+
+#if defined(NYRA_VALUE_JSON_PARSER_USE_SSE2)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i space = _mm_set1_epi8(0x20);
+
+  while (end - p >= 16) {
+    __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+
+    // As signed bytes, the non ASCII ones are below 0x20 too.
+    __m128i special = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                     _mm_cmpeq_epi8(chunk, backslash)),
+        _mm_cmplt_epi8(chunk, space));
+
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(special);
+    if (mask) {
+      return (size_t)(p - start) + nyra_flat_hashtable_ctz_(mask);
+    }
+    p += 16;
+  }
+#else
+  const uint64_t lsbs = 0x0101010101010101ULL;
+  const uint64_t msbs = 0x8080808080808080ULL;
+
+  while (end - p >= 8) {
+    uint64_t x = 0;
+    memcpy(&x, p, sizeof(x));
+  #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    x = __builtin_bswap64(x);
+  #endif
+
+    uint64_t q = x ^ (lsbs * '"');
+    uint64_t b = x ^ (lsbs * '\\');
+    uint64_t special = ((q - lsbs) & ~q) | ((b - lsbs) & ~b) |
+                       (x - lsbs * 0x20) | x;
+    special &= msbs;
+
+    // The borrows of the subtractions could only flag the bytes above a
+    // flagged one, so the lowest flag is exact.
+    if (special) {
+      return (size_t)(p - start) + (nyra_flat_hashtable_ctz_(special) >> 3);
+    }
+    p += 8;
+  }
+#endif
+
+  while (p < end) {
+    unsigned char c = (unsigned char)*p;
+    if (c == '"' || c == '\\' || c < 0x20 || c >= 0x80) {
+      break;
+    }
+    ++p;
+  }
+
+  return (size_t)(p - start);
+}
+
+/**
+ * @brief The length of the valid UTF-8 sequence starting with a non ASCII
+ * byte at @a p, or 0 if it is invalid.
+ */
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline size_t nyra_value_json_parser_utf8_len_(const char *p,
+                                                      const char *end) {
+  const unsigned char *s = (const unsigned char *)p;
+  size_t avail = (size_t)(end - p);
+  unsigned char c = s[0];
+
+  if (c >= 0xC2 && c <= 0xDF) {
+    return (avail >= 2 && (s[1] & 0xC0) == 0x80) ? 2 : 0;
+  }
+
+  if (c >= 0xE0 && c <= 0xEF) {
+    if (avail < 3 || (s[1] & 0xC0) != 0x80 || (s[2] & 0xC0) != 0x80) {
+      return 0;
+    }
+    // Overlong encodings, and surrogates.
+    if ((c == 0xE0 && s[1] < 0xA0) || (c == 0xED && s[1] > 0x9F)) {
+      return 0;
+    }
+    return 3;
+  }
+
+  if (c >= 0xF0 && c <= 0xF4) {
+    if (avail < 4 || (s[1] & 0xC0) != 0x80 || (s[2] & 0xC0) != 0x80 ||
+        (s[3] & 0xC0) != 0x80) {
+      return 0;
+    }
+    // Overlong encodings, and code points above U+10FFFF.
+    if ((c == 0xF0 && s[1] < 0x90) || (c == 0xF4 && s[1] > 0x8F)) {
+      return 0;
+    }
+    return 4;
+  }
+
+  return 0;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline int32_t nyra_value_json_parser_hex4_(const char *p) {
+  int32_t v = 0;
+  for (int i = 0; i < 4; ++i) {
+    char c = p[i];
+    v <<= 4;
+    if (c >= '0' && c <= '9') {
+      v |= c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      v |= c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      v |= c - 'A' + 10;
+    } else {
+      return -1;
+    }
+  }
+  return v;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline size_t nyra_value_json_parser_put_utf8_(char *out, int32_t cp) {
+  if (cp < 0x80) {
+    out[0] = (char)cp;
+    return 1;
+  }
+  if (cp < 0x800) {
+    out[0] = (char)(0xC0 | (cp >> 6));
+    out[1] = (char)(0x80 | (cp & 0x3F));
+    return 2;
+  }
+  if (cp < 0x10000) {
+    out[0] = (char)(0xE0 | (cp >> 12));
+    out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[2] = (char)(0x80 | (cp & 0x3F));
+    return 3;
+  }
+  out[0] = (char)(0xF0 | (cp >> 18));
+  out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+  out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+  out[3] = (char)(0x80 | (cp & 0x3F));
+  return 4;
+}
+
+/**
+ * @brief Parse the string at the current '"'.
+ *
+ * @param need_nul Whether the result must be followed by a '\0', then it is
+ * always in the scratch buffer.
+ *
+ * @return The decoded bytes, which are either in the input or in the scratch
+ * buffer, so they are only valid until the next string is parsed. NULL on
+ * error.
+ */
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline const char *nyra_value_json_parser_parse_string_(
+    nyra_value_json_parser_t *self, bool need_nul, size_t *len) {
+  NYRA_ASSERT(*self->pos == '"', "Should not happen.");
+
+  const char *p = ++self->pos;
+  const char *run = p;
+  size_t used = 0;
+  bool in_scratch = need_nul;
+
+  for (;;) {
+    p += nyra_value_json_parser_scan_plain_(p, self->end);
+    if (p >= self->end) {
+      self->pos = p;
+      return (const char *)nyra_value_json_parser_fail_(
+          self, "premature end of input in a string");
+    }
+
+    unsigned char c = (unsigned char)*p;
+
+    if (c >= 0x80) {
+      size_t n = nyra_value_json_parser_utf8_len_(p, self->end);
+      if (!n) {
+        self->pos = p;
+        return (const char *)nyra_value_json_parser_fail_(
+            self, "invalid UTF-8 in a string");
+      }
+      p += n;
+      continue;
+    }
+
+    if (c < 0x20) {
+      self->pos = p;
+      return (const char *)nyra_value_json_parser_fail_(
+          self, "control character in a string");
+    }
+
+    // Flush the plain bytes before the '"' or the '\\'.
+    if (in_scratch) {
+      size_t n = (size_t)(p - run);
+      memcpy(nyra_value_json_parser_reserve_(self, used, n), run, n);
+      used += n;
+    }
+
+    if (c == '"') {
+      self->pos = p + 1;
+
+      if (!in_scratch) {
+        *len = (size_t)(p - run);
+        return run;
+      }
+
+      if (need_nul) {
+        *nyra_value_json_parser_reserve_(self, used, 1) = '\0';
+      }
+      *len = used;
+      return self->scratch;
+    }
+
+    // An escape, the bytes are not the input ones from now on.
+    if (!in_scratch) {
+      size_t n = (size_t)(p - run);
+      memcpy(nyra_value_json_parser_reserve_(self, 0, n), run, n);
+      used = n;
+      in_scratch = true;
+    }
+
+    if (self->end - p < 2) {
+      self->pos = p;
+      return (const char *)nyra_value_json_parser_fail_(
+          self, "premature end of input in a string");
+    }
+
+    char *out = nyra_value_json_parser_reserve_(self, used, 4);
+    char e = p[1];
+    p += 2;
+
+    switch (e) {
+      case '"':
+      case '\\':
+      case '/':
+        *out = e;
+        used++;
+        break;
+      case 'b':
+        *out = '\b';
+        used++;
+        break;
+      case 'f':
+        *out = '\f';
+        used++;
+        break;
+      case 'n':
+        *out = '\n';
+        used++;
+        break;
+      case 'r':
+        *out = '\r';
+        used++;
+        break;
+      case 't':
+        *out = '\t';
+        used++;
+        break;
+      case 'u': {
+        int32_t cp = self->end - p >= 4 ? nyra_value_json_parser_hex4_(p) : -1;
+        if (cp < 0) {
+          self->pos = p - 2;
+          return (const char *)nyra_value_json_parser_fail_(
+              self, "invalid \\u escape");
+        }
+        p += 4;
+
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+          int32_t low = -1;
+          if (self->end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+            low = nyra_value_json_parser_hex4_(p + 2);
+          }
+          if (low < 0xDC00 || low > 0xDFFF) {
+            self->pos = p - 6;
+            return (const char *)nyra_value_json_parser_fail_(
+                self, "unpaired surrogate in a \\u escape");
+          }
+          p += 6;
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+          self->pos = p - 6;
+          return (const char *)nyra_value_json_parser_fail_(
+              self, "unpaired surrogate in a \\u escape");
+        } else if (cp == 0) {
+          self->pos = p - 6;
+          return (const char *)nyra_value_json_parser_fail_(
+              self, "\\u0000 is not allowed");
+        }
+
+        used += nyra_value_json_parser_put_utf8_(out, cp);
+        break;
+      }
+      default:
+        self->pos = p - 2;
+        return (const char *)nyra_value_json_parser_fail_(self,
+                                                          "invalid escape");
+    }
+
+    run = p;
+  }
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_value_t *nyra_value_json_parser_parse_real_(
+    nyra_value_json_parser_t *self, const char *start, const char *stop,
+    uint64_t mantissa, int digits, int32_t exp10, bool negative) {
+  // Both the mantissa and the power of 10 are exact doubles, so is their
+  // product or quotient.
+  static const double pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                 1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  double d = 0;
+
+  if (digits <= 19 && mantissa <= (1ULL << 53) && exp10 >= -22 &&
+      exp10 <= 22) {
+    d = (double)mantissa;
+    d = exp10 < 0 ? d / pow10[-exp10] : d * pow10[exp10];
+    if (negative) {
+      d = -d;
+    }
+  } else {
+    // 'strtod()' follows the decimal point of the locale.
+    char local[64];
+    char *buf = local;
+    size_t n = (size_t)(stop - start);
+    if (n >= sizeof(local)) {
+      buf = (char *)NYRA_MALLOC(n + 1);
+      NYRA_ASSERT(buf, "Failed to allocate memory.");
+    }
+    memcpy(buf, start, n);
+    buf[n] = '\0';
+
+    const char *point = localeconv()->decimal_point;
+    if (point && point[0] != '.' && point[0] && !point[1]) {
+      char *dot = strchr(buf, '.');
+      if (dot) {
+        *dot = point[0];
+      }
+    }
+
+    d = strtod(buf, NULL);
+
+    if (buf != local) {
+      NYRA_FREE_(buf);
+    }
+  }
+
+  if (isinf(d)) {
+    self->pos = start;
+    return (nyra_value_t *)nyra_value_json_parser_fail_(
+        self, "real number overflow");
+  }
+
+  return nyra_value_create_float64(d);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_value_t *nyra_value_json_parser_parse_number_(
+    nyra_value_json_parser_t *self) {
+  const char *start = self->pos;
+  const char *p = start;
+  const char *end = self->end;
+  bool negative = false;
+
+  if (*p == '-') {
+    negative = true;
+    ++p;
+  }
+
+  if (p >= end || *p < '0' || *p > '9') {
+    return (nyra_value_t *)nyra_value_json_parser_fail_(self, "invalid token");
+  }
+
+  uint64_t mantissa = 0;
+  int digits = 0;
+  bool overflow = false;
+
+  if (*p == '0') {
+    ++p;
+    if (p < end && *p >= '0' && *p <= '9') {
+      return (nyra_value_t *)nyra_value_json_parser_fail_(self,
+                                                          "invalid token");
+    }
+  } else {
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+      uint64_t digit = (uint64_t)(*p - '0');
+      if (mantissa > (UINT64_MAX - digit) / 10) {
+        overflow = true;
+      } else {
+        mantissa = mantissa * 10 + digit;
+      }
+      ++digits;
+    }
+  }
+
+  bool is_real = false;
+  int32_t exp10 = 0;
+
+  if (p < end && *p == '.') {
+    is_real = true;
+    ++p;
+    if (p >= end || *p < '0' || *p > '9') {
+      return (nyra_value_t *)nyra_value_json_parser_fail_(self,
+                                                          "invalid token");
+    }
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+      if (mantissa <= (UINT64_MAX - 9) / 10) {
+        mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+        if (mantissa) {
+          ++digits;
+        }
+        --exp10;
+      } else {
+        overflow = true;
+      }
+    }
+  }
+
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    is_real = true;
+    ++p;
+
+    bool exp_negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+      exp_negative = *p == '-';
+      ++p;
+    }
+    if (p >= end || *p < '0' || *p > '9') {
+      return (nyra_value_t *)nyra_value_json_parser_fail_(self,
+                                                          "invalid token");
+    }
+
+    int32_t e = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+      if (e < 100000) {
+        e = e * 10 + (*p - '0');
+      }
+    }
+    exp10 += exp_negative ? -e : e;
+  }
+
+  self->pos = p;
+
+  if (is_real) {
+    return nyra_value_json_parser_parse_real_(
+        self, start, p, mantissa, overflow ? 20 : digits, exp10, negative);
+  }
+
+  if (!negative) {
+    if (overflow || mantissa > (uint64_t)INT64_MAX) {
+      self->pos = start;
+      return (nyra_value_t *)nyra_value_json_parser_fail_(self,
+                                                          "too big integer");
+    }
+    return nyra_value_create_uint64(mantissa);
+  }
+
+  if (overflow || mantissa > (uint64_t)INT64_MAX + 1) {
+    self->pos = start;
+    return (nyra_value_t *)nyra_value_json_parser_fail_(self,
+                                                        "too big integer");
+  }
+
+  // '-0' is 0, which is not negative.
+  if (!mantissa) {
+    return nyra_value_create_uint64(0);
+  }
+
+  return nyra_value_create_int64((int64_t)(0 - mantissa));
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_value_json_parser_match_(nyra_value_json_parser_t *self,
+                                                 const char *word,
+                                                 size_t len) {
+  if ((size_t)(self->end - self->pos) < len ||
+      memcmp(self->pos, word, len) != 0) {
+    nyra_value_json_parser_fail_(self, "invalid token");
+    return false;
+  }
+  self->pos += len;
+  return true;
+}
+
+static inline nyra_value_t *nyra_value_json_parser_parse_value_(
+    nyra_value_json_parser_t *self);
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_value_t *nyra_value_json_parser_parse_array_(
+    nyra_value_json_parser_t *self) {
+  nyra_list_t items = NYRA_LIST_INIT_VAL;
+
+  ++self->pos;
+  nyra_value_json_parser_skip_ws_(self);
+
+  if (self->pos < self->end && *self->pos == ']') {
+    ++self->pos;
+    return nyra_value_create_array_with_move(&items);
+  }
+
+  for (;;) {
+    nyra_value_t *item = nyra_value_json_parser_parse_value_(self);
+    if (!item) {
+      nyra_list_clear(&items);
+      return NULL;
+    }
+    nyra_list_push_ptr_back(
+        &items, item, (nyra_ptr_listnode_destroy_func_t)nyra_value_destroy);
+
+    nyra_value_json_parser_skip_ws_(self);
+    if (self->pos >= self->end) {
+      nyra_list_clear(&items);
+      return (nyra_value_t *)nyra_value_json_parser_fail_(self,
+                                                          "']' expected");
+    }
+
+    char c = *self->pos++;
+    if (c == ']') {
+      return nyra_value_create_array_with_move(&items);
+    }
+    if (c != ',') {
+      --self->pos;
+      nyra_list_clear(&items);
+      return (nyra_value_t *)nyra_value_json_parser_fail_(self,
+                                                          "']' expected");
+    }
+
+    nyra_value_json_parser_skip_ws_(self);
+  }
+}
+
+/**
+ * @brief Find the pair of @a key among the ones already parsed in an object.
+ */
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_value_kv_t *nyra_value_json_parser_find_key_(
+    nyra_list_t *kvs, nyra_flat_hashtable_t *index, const char *key,
+    size_t len) {
+  if (index->capacity) {
+    return (nyra_value_kv_t *)nyra_flat_hashtable_get_by_key(index, key,
+                                                            (uint32_t)len);
+  }
+
+  nyra_list_foreach (kvs, iter) {
+    nyra_value_kv_t *kv = (nyra_value_kv_t *)nyra_ptr_listnode_get(iter.node);
+    if (nyra_string_len(&kv->key) == len &&
+        memcmp(nyra_string_get_raw_str(&kv->key), key, len) == 0) {
+      return kv;
+    }
+  }
+
+  return NULL;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_value_t *nyra_value_json_parser_parse_object_(
+    nyra_value_json_parser_t *self) {
+  nyra_list_t kvs = NYRA_LIST_INIT_VAL;
+  nyra_value_t *result = NULL;
+
+  // The keys are the bytes of the 'nyra_value_kv_t' themselves, which do not
+  // move.
+  nyra_flat_hashtable_t index;
+  nyra_flat_hashtable_init(&index, NYRA_FLAT_HASHTABLE_KEY_TYPE_BYTES, NULL);
+
+  ++self->pos;
+  nyra_value_json_parser_skip_ws_(self);
+
+  if (self->pos < self->end && *self->pos == '}') {
+    ++self->pos;
+    return nyra_value_create_object_with_move(&kvs);
+  }
+
+  for (;;) {
+    if (self->pos >= self->end || *self->pos != '"') {
+      nyra_value_json_parser_fail_(self, "string or '}' expected");
+      goto done;
+    }
+
+    size_t key_len = 0;
+    const char *key =
+        nyra_value_json_parser_parse_string_(self, true, &key_len);
+    if (!key) {
+      goto done;
+    }
+
+    // The key is in the scratch buffer, which the value could overwrite.
+    nyra_value_kv_t *kv =
+        nyra_value_json_parser_find_key_(&kvs, &index, key, key_len);
+    bool is_new = kv == NULL;
+    if (is_new) {
+      // 'nyra_value_kv_create_empty()' takes its name as a format, so a key
+      // with a '%' is set afterwards rather than passed to it.
+      kv = nyra_value_kv_create_empty("");
+      NYRA_ASSERT(kv, "Failed to allocate memory.");
+      if (key_len) {
+        nyra_string_set_from_c_str(&kv->key, key, key_len);
+      }
+      kv->value = NULL;
+      nyra_list_push_ptr_back(
+          &kvs, kv, (nyra_ptr_listnode_destroy_func_t)nyra_value_kv_destroy);
+    }
+
+    nyra_value_json_parser_skip_ws_(self);
+    if (self->pos >= self->end || *self->pos != ':') {
+      nyra_value_json_parser_fail_(self, "':' expected");
+      goto done;
+    }
+    ++self->pos;
+    nyra_value_json_parser_skip_ws_(self);
+
+    nyra_value_t *value = nyra_value_json_parser_parse_value_(self);
+    if (!value) {
+      goto done;
+    }
+    if (kv->value) {
+      nyra_value_destroy(kv->value);
+    }
+    kv->value = value;
+
+    if (is_new) {
+      size_t cnt = nyra_list_size(&kvs);
+      if (cnt == NYRA_VALUE_JSON_PARSER_INDEX_THRESHOLD) {
+        nyra_list_foreach (&kvs, iter) {
+          nyra_value_kv_t *item =
+              (nyra_value_kv_t *)nyra_ptr_listnode_get(iter.node);
+          nyra_flat_hashtable_set_by_key(
+              &index, nyra_string_get_raw_str(&item->key),
+              (uint32_t)nyra_string_len(&item->key), item);
+        }
+      } else if (cnt > NYRA_VALUE_JSON_PARSER_INDEX_THRESHOLD) {
+        nyra_flat_hashtable_set_by_key(
+            &index, nyra_string_get_raw_str(&kv->key), (uint32_t)key_len, kv);
+      }
+    }
+
+    nyra_value_json_parser_skip_ws_(self);
+    if (self->pos >= self->end) {
+      nyra_value_json_parser_fail_(self, "'}' expected");
+      goto done;
+    }
+
+    char c = *self->pos++;
+    if (c == '}') {
+      result = nyra_value_create_object_with_move(&kvs);
+      goto done;
+    }
+    if (c != ',') {
+      --self->pos;
+      nyra_value_json_parser_fail_(self, "'}' expected");
+      goto done;
+    }
+
+    nyra_value_json_parser_skip_ws_(self);
+  }
+
+done:
+  nyra_flat_hashtable_deinit(&index);
+  if (!result) {
+    nyra_list_clear(&kvs);
+  }
+  return result;
+}
+
+static inline nyra_value_t *nyra_value_json_parser_parse_value_(
+    nyra_value_json_parser_t *self) {
+  if (self->pos >= self->end) {
+    return (nyra_value_t *)nyra_value_json_parser_fail_(
+        self, "premature end of input");
+  }
+
+  switch (*self->pos) {
+    case '{':
+    case '[': {
+      if (++self->depth > NYRA_VALUE_JSON_PARSER_MAX_DEPTH) {
+        return (nyra_value_t *)nyra_value_json_parser_fail_(
+            self, "maximum parsing depth reached");
+      }
+      nyra_value_t *value = *self->pos == '{'
+                                ? nyra_value_json_parser_parse_object_(self)
+                                : nyra_value_json_parser_parse_array_(self);
+      --self->depth;
+      return value;
+    }
+
+    case '"': {
+      size_t len = 0;
+      const char *str = nyra_value_json_parser_parse_string_(self, false, &len);
+      return str ? nyra_value_create_string_with_size(str, len) : NULL;
+    }
+
+    case 't':
+      return nyra_value_json_parser_match_(self, "true", 4)
+                 ? nyra_value_create_bool(true)
+                 : NULL;
+
+    case 'f':
+      return nyra_value_json_parser_match_(self, "false", 5)
+                 ? nyra_value_create_bool(false)
+                 : NULL;
+
+    case 'n':
+      return nyra_value_json_parser_match_(self, "null", 4)
+                 ? nyra_value_create_null()
+                 : NULL;
+
+    default:
+      return nyra_value_json_parser_parse_number_(self);
+  }
+}
+
+/**
+ * @brief Parse the @a len bytes of JSON at @a json into a value.
+ *
+ * @return The value, which the caller owns, or NULL if @a json is not valid
+ * JSON, then @a err, if not NULL, tells why.
+ */
+static inline nyra_value_t *nyra_value_from_json_str_with_len(
+    const char *json, size_t len, nyra_error_t *err) {
+  NYRA_ASSERT(json || !len, "Invalid argument.");
+
+  nyra_value_json_parser_t parser;
+  parser.begin = json;
+  parser.pos = json;
+  parser.end = json + len;
+  parser.err = err;
+  parser.failed = false;
+  parser.depth = 0;
+  parser.scratch = parser.scratch_buf;
+  parser.scratch_size = sizeof(parser.scratch_buf);
+
+  nyra_value_json_parser_skip_ws_(&parser);
+  nyra_value_t *value = nyra_value_json_parser_parse_value_(&parser);
+
+  if (value) {
+    nyra_value_json_parser_skip_ws_(&parser);
+    if (parser.pos != parser.end) {
+      nyra_value_destroy(value);
+      value = (nyra_value_t *)nyra_value_json_parser_fail_(
+          &parser, "end of input expected");
+    }
+  }
+
+  if (parser.scratch != parser.scratch_buf) {
+    NYRA_FREE_(parser.scratch);
+  }
+
+  return value;
+}
+
+static inline nyra_value_t *nyra_value_from_json_str(const char *json,
+                                                     nyra_error_t *err) {
+  NYRA_ASSERT(json, "Invalid argument.");
+  return nyra_value_from_json_str_with_len(json, strlen(json), err);
+}
@@ -0,0 +1,402 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <locale.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "nyra_utils/container/list.h"
+#include "nyra_utils/container/list_node_ptr.h"
+#include "nyra_utils/lib/string.h"
+#include "nyra_utils/macro/check.h"
+#include "nyra_utils/macro/mark.h"
+#include "nyra_utils/value/value.h"
+#include "nyra_utils/value/value_kv.h"
+
+// Write a 'nyra_value_t' as JSON text straight into a buffer, without the
+// 'nyra_json_t' tree which 'nyra_value_to_json()' + 'nyra_json_to_string()' go
+// through, nor the copy of their result. The buffer belongs to the caller, ex:
+// a 'nyra_string_t' or a 'std::string', so that a buffer which is reused for
+// each message keeps its capacity, and the writing of a property does not
+// allocate at all once it has grown enough.
+//
+// The text is the same as the one of the tree path: ", " and ": " between the
+// items, the floats as "%.17g" with a ".0" for the integral ones and without
+// the '+' and the leading zeros of the exponent, only '"', '\\' and the
+// control characters escaped. A 'buf' or a 'ptr' is written as null.
+
+// Makes room for at least @a need bytes in the buffer of @a ctx, of which the
+// first @a size ones are in use, and returns its start and its @a capacity.
+typedef char *(*nyra_value_json_writer_grow_func_t)(void *ctx, size_t size,
+                                                     size_t need,
+                                                     size_t *capacity);
+
+typedef struct nyra_value_json_writer_t {
+  char *data;
+  size_t size;
+  size_t capacity;
+
+  nyra_value_json_writer_grow_func_t grow;
+  void *ctx;
+} nyra_value_json_writer_t;
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline char *nyra_value_json_writer_reserve_(
+    nyra_value_json_writer_t *self, size_t more) {
+  if (UNLIKELY(self->size + more > self->capacity)) {
+    self->data =
+        self->grow(self->ctx, self->size, self->size + more, &self->capacity);
+    NYRA_ASSERT(self->data && self->capacity >= self->size + more,
+               "Failed to allocate memory.");
+  }
+  return self->data + self->size;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_value_json_writer_put_(nyra_value_json_writer_t *self,
+                                               const char *str, size_t len) {
+  memcpy(nyra_value_json_writer_reserve_(self, len), str, len);
+  self->size += len;
+}
+
+/**
+ * @brief Write @a v in decimal at @a out, which has room for 20 digits.
+ *
+ * @return The number of digits.
+ */
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline size_t nyra_value_json_writer_u64_(char *out, uint64_t v) {
+  static const char pairs[] =
+      "00010203040506070809101112131415161718192021222324252627282930313233343"
+      "53637383940414243444546474849505152535455565758596061626364656667686970"
+      "7172737475767778798081828384858687888990919293949596979899";
+
+  char tmp[20];
+  char *p = tmp + sizeof(tmp);
+
+  while (v >= 100) {
+    size_t i = (size_t)(v % 100) * 2;
+    v /= 100;
+    *--p = pairs[i + 1];
+    *--p = pairs[i];
+  }
+  if (v >= 10) {
+    size_t i = (size_t)v * 2;
+    *--p = pairs[i + 1];
+    *--p = pairs[i];
+  } else {
+    *--p = (char)('0' + v);
+  }
+
+  size_t len = (size_t)(tmp + sizeof(tmp) - p);
+  memcpy(out, p, len);
+  return len;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_value_json_writer_uint_(nyra_value_json_writer_t *self,
+                                                uint64_t v) {
+  self->size +=
+      nyra_value_json_writer_u64_(nyra_value_json_writer_reserve_(self, 20), v);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_value_json_writer_int_(nyra_value_json_writer_t *self,
+                                               int64_t v) {
+  char *out = nyra_value_json_writer_reserve_(self, 21);
+  size_t len = 0;
+
+  if (v < 0) {
+    out[len++] = '-';
+    len += nyra_value_json_writer_u64_(out + len, 0 - (uint64_t)v);
+  } else {
+    len += nyra_value_json_writer_u64_(out + len, (uint64_t)v);
+  }
+
+  self->size += len;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_value_json_writer_real_(nyra_value_json_writer_t *self,
+                                                double d) {
+  if (isnan(d) || isinf(d)) {
+    return false;
+  }
+
+  // The integral values below 1e17 are written by "%.17g" without exponent.
+  if (d > -1e17 && d < 1e17 && d == (double)(int64_t)d &&
+      !(d == 0 && signbit(d))) {
+    nyra_value_json_writer_int_(self, (int64_t)d);
+    nyra_value_json_writer_put_(self, ".0", 2);
+    return true;
+  }
+
+  char buf[32];
+  int n = snprintf(buf, sizeof(buf), "%.17g", d);
+  NYRA_ASSERT(n > 0 && (size_t)n < sizeof(buf), "Should not happen.");
+
+  const char *point = localeconv()->decimal_point;
+  if (point && point[0] != '.' && point[0] && !point[1]) {
+    char *p = strchr(buf, point[0]);
+    if (p) {
+      *p = '.';
+    }
+  }
+
+  char *e = strchr(buf, 'e');
+  if (e) {
+    // "1e+022" -> "1e22", "1e-07" -> "1e-7".
+    char *src = e + 1;
+    char *dst = e + 1;
+    if (*src == '+') {
+      ++src;
+    } else if (*src == '-') {
+      *dst++ = *src++;
+    }
+    while (*src == '0' && src[1]) {
+      ++src;
+    }
+    memmove(dst, src, strlen(src) + 1);
+    n = (int)strlen(buf);
+  } else if (!strchr(buf, '.')) {
+    buf[n++] = '.';
+    buf[n++] = '0';
+  }
+
+  nyra_value_json_writer_put_(self, buf, (size_t)n);
+  return true;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_value_json_writer_string_(
+    nyra_value_json_writer_t *self, const char *str, size_t len) {
+  static const char hex[] = "0123456789ABCDEF";
+
+  // Most strings have nothing to escape, and are copied at once.
+  char *out = nyra_value_json_writer_reserve_(self, len + 2);
+  *out++ = '"';
+  self->size++;
+
+  size_t run = 0;
+  for (size_t i = 0; i < len; ++i) {
+    unsigned char c = (unsigned char)str[i];
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+
+    nyra_value_json_writer_put_(self, str + run, i - run);
+    run = i + 1;
+
+    char esc = 0;
+    switch (c) {
+      case '"':
+        esc = '"';
+        break;
+      case '\\':
+        esc = '\\';
+        break;
+      case '\b':
+        esc = 'b';
+        break;
+      case '\f':
+        esc = 'f';
+        break;
+      case '\n':
+        esc = 'n';
+        break;
+      case '\r':
+        esc = 'r';
+        break;
+      case '\t':
+        esc = 't';
+        break;
+      default:
+        break;
+    }
+
+    if (esc) {
+      char seq[2] = {'\\', esc};
+      nyra_value_json_writer_put_(self, seq, 2);
+    } else {
+      char seq[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+      nyra_value_json_writer_put_(self, seq, 6);
+    }
+  }
+
+  nyra_value_json_writer_put_(self, str + run, len - run);
+  nyra_value_json_writer_put_(self, "\"", 1);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline bool nyra_value_json_writer_value_(nyra_value_json_writer_t *self,
+                                                 nyra_value_t *value) {
+  NYRA_ASSERT(value, "Invalid argument.");
+
+  switch (value->type) {
+    case NYRA_TYPE_NULL:
+    case NYRA_TYPE_BUF:
+    case NYRA_TYPE_PTR:
+      nyra_value_json_writer_put_(self, "null", 4);
+      return true;
+
+    case NYRA_TYPE_BOOL:
+      if (value->content.boolean) {
+        nyra_value_json_writer_put_(self, "true", 4);
+      } else {
+        nyra_value_json_writer_put_(self, "false", 5);
+      }
+      return true;
+
+    case NYRA_TYPE_INT8:
+      nyra_value_json_writer_int_(self, value->content.int8);
+      return true;
+    case NYRA_TYPE_INT16:
+      nyra_value_json_writer_int_(self, value->content.int16);
+      return true;
+    case NYRA_TYPE_INT32:
+      nyra_value_json_writer_int_(self, value->content.int32);
+      return true;
+    case NYRA_TYPE_INT64:
+      nyra_value_json_writer_int_(self, value->content.int64);
+      return true;
+    case NYRA_TYPE_UINT8:
+      nyra_value_json_writer_int_(self, value->content.uint8);
+      return true;
+    case NYRA_TYPE_UINT16:
+      nyra_value_json_writer_int_(self, value->content.uint16);
+      return true;
+    case NYRA_TYPE_UINT32:
+      nyra_value_json_writer_int_(self, value->content.uint32);
+      return true;
+    case NYRA_TYPE_UINT64:
+      // The tree path aborts on the ones above INT64_MAX, which are written
+      // as they are here.
+      nyra_value_json_writer_uint_(self, value->content.uint64);
+      return true;
+
+    case NYRA_TYPE_FLOAT32:
+      return nyra_value_json_writer_real_(self, value->content.float32);
+    case NYRA_TYPE_FLOAT64:
+      return nyra_value_json_writer_real_(self, value->content.float64);
+
+    case NYRA_TYPE_STRING:
+      nyra_value_json_writer_string_(self, value->content.string.buf,
+                                     value->content.string.first_unused_idx);
+      return true;
+
+    case NYRA_TYPE_ARRAY: {
+      nyra_value_json_writer_put_(self, "[", 1);
+
+      // The nodes are read in place, rather than through the exported
+      // accessors.
+      for (nyra_listnode_t *node = value->content.array.front; node;
+           node = node->next) {
+        if (node != value->content.array.front) {
+          nyra_value_json_writer_put_(self, ", ", 2);
+        }
+        nyra_value_t *item = (nyra_value_t *)((nyra_ptr_listnode_t *)node)->ptr;
+        if (!nyra_value_json_writer_value_(self, item)) {
+          return false;
+        }
+      }
+
+      nyra_value_json_writer_put_(self, "]", 1);
+      return true;
+    }
+
+    case NYRA_TYPE_OBJECT: {
+      nyra_value_json_writer_put_(self, "{", 1);
+
+      for (nyra_listnode_t *node = value->content.object.front; node;
+           node = node->next) {
+        if (node != value->content.object.front) {
+          nyra_value_json_writer_put_(self, ", ", 2);
+        }
+        nyra_value_kv_t *kv =
+            (nyra_value_kv_t *)((nyra_ptr_listnode_t *)node)->ptr;
+        nyra_value_json_writer_string_(self, kv->key.buf,
+                                       kv->key.first_unused_idx);
+        nyra_value_json_writer_put_(self, ": ", 2);
+        if (!nyra_value_json_writer_value_(self, kv->value)) {
+          return false;
+        }
+      }
+
+      nyra_value_json_writer_put_(self, "}", 1);
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Append the JSON text of @a value to the buffer of @a self.
+ *
+ * @return false if @a value could not be written, ex: it is invalid or holds
+ * a NaN, then the buffer is back to its size before the call.
+ */
+static inline bool nyra_value_json_writer_write(nyra_value_json_writer_t *self,
+                                                nyra_value_t *value) {
+  NYRA_ASSERT(self && self->grow && value, "Invalid argument.");
+
+  size_t size = self->size;
+  if (!nyra_value_json_writer_value_(self, value)) {
+    self->size = size;
+    return false;
+  }
+  return true;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline char *nyra_value_json_writer_grow_string_(void *ctx, size_t size,
+                                                        size_t need,
+                                                        size_t *capacity) {
+  nyra_string_t *str = (nyra_string_t *)ctx;
+
+  // One more byte for the '\0'.
+  str->first_unused_idx = size;
+  nyra_string_reserve(str, need - size + 1);
+
+  *capacity = str->buf_size - 1;
+  return str->buf;
+}
+
+/**
+ * @brief Replace the content of @a out with the JSON text of @a value. The
+ * memory of @a out is reused, so a string which is kept across the calls
+ * stops allocating once it is big enough.
+ *
+ * @return false if @a value could not be written, then @a out is empty.
+ */
+static inline bool nyra_value_to_json_string(nyra_value_t *value,
+                                             nyra_string_t *out) {
+  NYRA_ASSERT(value && out && nyra_string_check_integrity(out),
+             "Invalid argument.");
+
+  nyra_value_json_writer_t writer;
+  writer.data = out->buf;
+  writer.size = 0;
+  writer.capacity = out->buf_size - 1;
+  writer.grow = nyra_value_json_writer_grow_string_;
+  writer.ctx = out;
+
+  bool rc = nyra_value_json_writer_write(&writer, value);
+
+  out->first_unused_idx = writer.size;
+  out->buf[writer.size] = '\0';
+
+  return rc;
+}
@@ -0,0 +1,370 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+#pragma once
+
+#include "nyra_utils/nyra_config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nyra_runtime/common/errno.h"
+#include "nyra_utils/container/list.h"
+#include "nyra_utils/container/list_ptr.h"
+#include "nyra_utils/lib/alloc.h"
+#include "nyra_utils/lib/arena.h"
+#include "nyra_utils/lib/error.h"
+#include "nyra_utils/lib/mutex.h"
+#include "nyra_utils/lib/signature.h"
+#include "nyra_utils/lib/string.h"
+#include "nyra_utils/macro/check.h"
+#include "nyra_utils/value/value.h"
+#include "nyra_utils/value/value_flat.h"
+
+// The properties of the extension instances, i.e. the defaults of their addon
+// with the overrides of their node merged onto them, cached by addon and by
+// overrides. The instances of an addon which are started with the same
+// overrides, ex: the same graph in many sessions, share one merged result
+// instead of merging and serializing the defaults again each time.
+//
+// The defaults of an addon are set once with
+// 'nyra_value_merge_cache_set_base()', and flattened into an arena of their
+// own. A merge only allocates, in the arena of its result, the objects on the
+// paths which are overridden. The result holds the merged tree as well as its
+// JSON text, ex: for 'nyra_env_init_property_from_json()'.
+//
+// The cache could be shared by the threads. A result stays valid until it is
+// released, even if the cache evicts it or the defaults of its addon change.
+
+#define NYRA_VALUE_MERGE_CACHE_SIGNATURE 0x4AD06E2B19C7F35EU
+
+#define NYRA_VALUE_MERGE_CACHE_DEFAULT_MAX_ENTRIES 64
+
+typedef struct nyra_value_merged_t {
+  // Holds this struct, the merged objects and the JSON text.
+  nyra_arena_t *arena;
+
+  // Holds the defaults, which the merged tree shares.
+  nyra_arena_t *base_arena;
+
+  const char *addon;
+  uint64_t hash;
+  const nyra_value_flat_t *overrides;
+
+  const nyra_value_flat_t *root;
+  const char *json;
+  size_t json_len;
+} nyra_value_merged_t;
+
+typedef struct nyra_value_merge_cache_base_t {
+  char *addon;
+  nyra_arena_t *arena;
+  const nyra_value_flat_t *root;
+} nyra_value_merge_cache_base_t;
+
+typedef struct nyra_value_merge_cache_t {
+  nyra_signature_t signature;
+  nyra_mutex_t *lock;
+
+  nyra_list_t bases;    // nyra_value_merge_cache_base_t*
+  nyra_list_t entries;  // nyra_value_merged_t*, the least recently used first
+  size_t max_entries;
+
+  size_t hits;
+  size_t misses;
+} nyra_value_merge_cache_t;
+
+static inline bool nyra_value_merge_cache_check_integrity(
+    nyra_value_merge_cache_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  return nyra_signature_get(&self->signature) ==
+         NYRA_VALUE_MERGE_CACHE_SIGNATURE;
+}
+
+static inline void nyra_value_merged_retain(nyra_value_merged_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+  nyra_arena_retain(self->arena);
+  nyra_arena_retain(self->base_arena);
+}
+
+static inline void nyra_value_merged_release(nyra_value_merged_t *self) {
+  NYRA_ASSERT(self, "Invalid argument.");
+
+  // 'self' lives in its arena.
+  nyra_arena_t *base_arena = self->base_arena;
+  nyra_arena_release(self->arena);
+  nyra_arena_release(base_arena);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline void nyra_value_merge_cache_base_destroy_(
+    nyra_value_merge_cache_base_t *self) {
+  nyra_arena_release(self->arena);
+  NYRA_FREE_(self->addon);
+  NYRA_FREE_(self);
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_value_merge_cache_base_t *nyra_value_merge_cache_find_base_(
+    nyra_value_merge_cache_t *self, const char *addon) {
+  nyra_list_foreach (&self->bases, iter) {
+    nyra_value_merge_cache_base_t *base =
+        (nyra_value_merge_cache_base_t *)nyra_ptr_listnode_get(iter.node);
+    if (strcmp(base->addon, addon) == 0) {
+      return base;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @param max_entries The number of merged results kept, 0 for the default.
+ */
+static inline nyra_value_merge_cache_t *nyra_value_merge_cache_create(
+    size_t max_entries) {
+  nyra_value_merge_cache_t *self =
+      (nyra_value_merge_cache_t *)NYRA_MALLOC(sizeof(nyra_value_merge_cache_t));
+  NYRA_ASSERT(self, "Failed to allocate memory.");
+
+  nyra_signature_set(&self->signature, NYRA_VALUE_MERGE_CACHE_SIGNATURE);
+  self->lock = nyra_mutex_create();
+  nyra_list_init(&self->bases);
+  nyra_list_init(&self->entries);
+  self->max_entries =
+      max_entries ? max_entries : NYRA_VALUE_MERGE_CACHE_DEFAULT_MAX_ENTRIES;
+  self->hits = 0;
+  self->misses = 0;
+
+  return self;
+}
+
+static inline void nyra_value_merge_cache_destroy(
+    nyra_value_merge_cache_t *self) {
+  NYRA_ASSERT(self && nyra_value_merge_cache_check_integrity(self),
+             "Invalid argument.");
+
+  nyra_list_clear(&self->entries);
+  nyra_list_clear(&self->bases);
+  nyra_mutex_destroy(self->lock);
+  nyra_signature_set(&self->signature, 0);
+  NYRA_FREE_(self);
+}
+
+/**
+ * @brief Set the defaults of the properties of the instances of @a addon,
+ * which replace the previous ones. The results merged from the previous ones
+ * are dropped from the cache.
+ */
+static inline bool nyra_value_merge_cache_set_base(
+    nyra_value_merge_cache_t *self, const char *addon, nyra_value_t *base,
+    nyra_error_t *err) {
+  NYRA_ASSERT(self && nyra_value_merge_cache_check_integrity(self) && addon &&
+                 base,
+             "Invalid argument.");
+
+  nyra_arena_t *arena = nyra_arena_create(0);
+  const nyra_value_flat_t *root = nyra_value_flat_from_value(arena, base, err);
+  if (!root) {
+    nyra_arena_release(arena);
+    return false;
+  }
+
+  nyra_mutex_lock(self->lock);
+
+  nyra_value_merge_cache_base_t *entry =
+      nyra_value_merge_cache_find_base_(self, addon);
+  if (entry) {
+    nyra_arena_release(entry->arena);
+  } else {
+    entry = (nyra_value_merge_cache_base_t *)NYRA_MALLOC(
+        sizeof(nyra_value_merge_cache_base_t));
+    NYRA_ASSERT(entry, "Failed to allocate memory.");
+
+    size_t addon_len = strlen(addon);
+    entry->addon = (char *)NYRA_MALLOC(addon_len + 1);
+    NYRA_ASSERT(entry->addon, "Failed to allocate memory.");
+    memcpy(entry->addon, addon, addon_len + 1);
+
+    nyra_list_push_ptr_back(
+        &self->bases, entry,
+        (nyra_ptr_listnode_destroy_func_t)nyra_value_merge_cache_base_destroy_);
+  }
+  entry->arena = arena;
+  entry->root = root;
+
+  nyra_list_foreach (&self->entries, iter) {
+    nyra_value_merged_t *merged =
+        (nyra_value_merged_t *)nyra_ptr_listnode_get(iter.node);
+    if (strcmp(merged->addon, addon) == 0) {
+      nyra_list_remove_node(&self->entries, iter.node);
+    }
+  }
+
+  nyra_mutex_unlock(self->lock);
+  return true;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_value_merged_t *nyra_value_merge_cache_find_(
+    nyra_value_merge_cache_t *self, nyra_value_merge_cache_base_t *base,
+    uint64_t hash, const nyra_value_flat_t *overrides) {
+  nyra_list_foreach (&self->entries, iter) {
+    nyra_value_merged_t *merged =
+        (nyra_value_merged_t *)nyra_ptr_listnode_get(iter.node);
+
+    if (merged->hash != hash || merged->base_arena != base->arena ||
+        strcmp(merged->addon, base->addon) != 0) {
+      continue;
+    }
+    if ((merged->overrides == NULL) != (overrides == NULL) ||
+        (overrides &&
+         !nyra_value_flat_is_equal(merged->overrides, overrides))) {
+      continue;
+    }
+
+    // The most recently used at the back.
+    if (iter.node != nyra_list_back(&self->entries)) {
+      nyra_list_detach_node(&self->entries, iter.node);
+      nyra_list_push_back(&self->entries, iter.node);
+    }
+    return merged;
+  }
+  return NULL;
+}
+
+// NOLINTNEXTLINE(clang-diagnostic-unused-function)
+static inline nyra_value_merged_t *nyra_value_merge_cache_build_(
+    nyra_arena_t *arena, nyra_value_merge_cache_base_t *base, uint64_t hash,
+    const nyra_value_flat_t *overrides, nyra_error_t *err) {
+  const nyra_value_flat_t *root =
+      nyra_value_flat_merge(arena, base->root, overrides);
+
+  nyra_string_t json;
+  nyra_string_init(&json);
+
+  nyra_value_json_writer_t writer;
+  writer.data = json.buf;
+  writer.size = 0;
+  writer.capacity = json.buf_size - 1;
+  writer.grow = nyra_value_json_writer_grow_string_;
+  writer.ctx = &json;
+
+  if (!nyra_value_flat_write_json(&writer, root)) {
+    nyra_string_deinit(&json);
+    if (err) {
+      nyra_error_set(err, NYRA_ERRNO_INVALID_ARGUMENT,
+                    "The merged properties could not be written as JSON.");
+    }
+    return NULL;
+  }
+
+  nyra_value_merged_t *merged =
+      (nyra_value_merged_t *)nyra_value_flat_alloc_(arena, sizeof(*merged));
+  merged->arena = arena;
+  merged->base_arena = base->arena;
+  merged->addon = nyra_arena_strdup(arena, base->addon);
+  NYRA_ASSERT(merged->addon, "Failed to allocate memory.");
+  merged->hash = hash;
+  merged->overrides = overrides;
+  merged->root = root;
+  merged->json_len = writer.size;
+  merged->json = nyra_arena_strndup(arena, writer.data, writer.size);
+  NYRA_ASSERT(merged->json, "Failed to allocate memory.");
+
+  nyra_string_deinit(&json);
+  return merged;
+}
+
+/**
+ * @brief The properties of an instance of @a addon, i.e. its defaults with
+ * @a overrides, which could be NULL, merged onto them. They are merged only if
+ * the same overrides have not been merged onto the same defaults before.
+ *
+ * @return The merged result, which the caller releases with
+ * 'nyra_value_merged_release()', or NULL if there is no defaults for @a addon
+ * or @a overrides could not be merged.
+ */
+static inline nyra_value_merged_t *nyra_value_merge_cache_get(
+    nyra_value_merge_cache_t *self, const char *addon, nyra_value_t *overrides,
+    nyra_error_t *err) {
+  NYRA_ASSERT(self && nyra_value_merge_cache_check_integrity(self) && addon,
+             "Invalid argument.");
+
+  // The overrides are small, they are flattened into the arena the result
+  // would live in, to be compared with the ones of the cached results.
+  nyra_arena_t *arena = nyra_arena_create(0);
+
+  const nyra_value_flat_t *flat_overrides = NULL;
+  uint64_t hash = 0;
+  if (overrides) {
+    flat_overrides = nyra_value_flat_from_value(arena, overrides, err);
+    if (!flat_overrides) {
+      nyra_arena_release(arena);
+      return NULL;
+    }
+    hash = nyra_value_flat_hash(flat_overrides, 0);
+  }
+
+  nyra_mutex_lock(self->lock);
+
+  nyra_value_merge_cache_base_t *base =
+      nyra_value_merge_cache_find_base_(self, addon);
+  if (!base) {
+    nyra_mutex_unlock(self->lock);
+    nyra_arena_release(arena);
+    if (err) {
+      nyra_error_set(err, NYRA_ERRNO_INVALID_ARGUMENT,
+                    "No default properties for addon %s.", addon);
+    }
+    return NULL;
+  }
+
+  nyra_value_merged_t *merged =
+      nyra_value_merge_cache_find_(self, base, hash, flat_overrides);
+  if (merged) {
+    self->hits++;
+    nyra_value_merged_retain(merged);
+    nyra_mutex_unlock(self->lock);
+    nyra_arena_release(arena);
+    return merged;
+  }
+
+  // The defaults are never modified, so they are merged without the lock.
+  self->misses++;
+  nyra_value_merge_cache_base_t snapshot = *base;
+  nyra_arena_retain(snapshot.arena);
+  nyra_mutex_unlock(self->lock);
+
+  merged = nyra_value_merge_cache_build_(arena, &snapshot, hash,
+                                         flat_overrides, err);
+  if (!merged) {
+    nyra_arena_release(snapshot.arena);
+    nyra_arena_release(arena);
+    return NULL;
+  }
+
+  nyra_mutex_lock(self->lock);
+
+  // One reference for the cache, the ones created with the arena and taken on
+  // the defaults above are for the caller. It is not cached if the defaults
+  // have changed meanwhile.
+  if (nyra_value_merge_cache_find_base_(self, addon) == base &&
+      base->arena == snapshot.arena) {
+    nyra_value_merged_retain(merged);
+    nyra_list_push_ptr_back(
+        &self->entries, merged,
+        (nyra_ptr_listnode_destroy_func_t)nyra_value_merged_release);
+
+    while (nyra_list_size(&self->entries) > self->max_entries) {
+      nyra_list_remove_node(&self->entries, nyra_list_front(&self->entries));
+    }
+  }
+
+  nyra_mutex_unlock(self->lock);
+  return merged;
+}
@@ -0,0 +1,146 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+// The 'buf' values of 'nyra_utils/lang/cpp/lib/fixed_layout.h': the padding of
+// the struct is not copied into them, a buf larger than its content is still
+// read, and a buf of another layout is refused.
+//
+//   # From the root of the app, see the 'nyra_runtime_tests' target of '../BUILD.gn'.
+//   gn gen out --args='nyra_runtime_enable_tests=true'
+//   ninja -C out cpp_fixed_layout_test
+//   out/cpp_fixed_layout_test
+//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "nyra_utils/lang/cpp/lib/fixed_layout.h"
+#include "nyra_utils/value/value_json_parser.h"
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+              #cond);                                                 \
+      exit(1);                                                        \
+    }                                                                 \
+  } while (0)
+
+struct span_t {
+  int32_t start;
+  int64_t end;
+};
+
+struct vad_event_t {
+  int64_t start_ms;
+  float energy;
+  bool speech;
+  span_t span;
+};
+
+NYRA_STRUCT_BINDING(span_t, NYRA_STRUCT_FIELD(span_t, start),
+                    NYRA_STRUCT_FIELD(span_t, end))
+
+NYRA_STRUCT_BINDING(vad_event_t, NYRA_STRUCT_FIELD(vad_event_t, start_ms),
+                    NYRA_STRUCT_FIELD(vad_event_t, energy),
+                    NYRA_STRUCT_FIELD(vad_event_t, speech),
+                    NYRA_STRUCT_FIELD(vad_event_t, span))
+
+struct other_t {
+  int64_t start_ms;
+};
+
+NYRA_STRUCT_BINDING(other_t, NYRA_STRUCT_FIELD(other_t, start_ms))
+
+static void test_padding() {
+  // The padding of the struct is garbage.
+  alignas(vad_event_t) unsigned char storage[sizeof(vad_event_t)];
+  memset(storage, 0xAB, sizeof(storage));
+  auto *event = new (storage) vad_event_t;
+  event->start_ms = 1;
+  event->energy = 0.5f;
+  event->speech = true;
+  event->span.start = 2;
+  event->span.end = 3;
+
+  nyra_value_t *value = ten::fixed_layout_to_value(*event);
+  nyra_buf_t *buf = nyra_value_peek_buf(value);
+  CHECK(buf->content_size == sizeof(ten::fixed_layout_header_t) +
+                                 sizeof(vad_event_t));
+
+  const uint8_t *bytes = buf->data + sizeof(ten::fixed_layout_header_t);
+  for (size_t i = 0; i < sizeof(vad_event_t); i++) {
+    CHECK(bytes[i] != 0xAB);
+  }
+
+  vad_event_t out{};
+  CHECK(ten::fixed_layout_from_value(value, out));
+  CHECK(out.start_ms == 1 && out.energy == 0.5f && out.speech);
+  CHECK(out.span.start == 2 && out.span.end == 3);
+
+  nyra_value_destroy(value);
+}
+
+static void test_larger_buf() {
+  vad_event_t event{};
+  event.start_ms = 7;
+
+  nyra_value_t *fixed = ten::fixed_layout_to_value(event);
+  nyra_buf_t *fixed_buf = nyra_value_peek_buf(fixed);
+
+  nyra_buf_t buf;
+  nyra_buf_init_with_owned_data(&buf, fixed_buf->content_size + 64);
+  memcpy(buf.data, fixed_buf->data, fixed_buf->content_size);
+  buf.content_size = fixed_buf->content_size;
+  nyra_value_t *value = nyra_value_create_buf_with_move(buf);
+
+  vad_event_t out{};
+  CHECK(ten::fixed_layout_from_value(value, out));
+  CHECK(out.start_ms == 7);
+
+  nyra_value_destroy(value);
+  nyra_value_destroy(fixed);
+}
+
+static void test_other_layout() {
+  other_t other{42};
+  nyra_value_t *value = ten::fixed_layout_to_value(other);
+
+  vad_event_t out{};
+  out.start_ms = 5;
+
+  nyra_error_t err;
+  nyra_error_init(&err);
+  CHECK(!ten::fixed_layout_from_value(value, out, &err));
+  CHECK(!nyra_error_is_success(&err));
+  CHECK(out.start_ms == 5);
+  nyra_error_deinit(&err);
+
+  nyra_value_destroy(value);
+}
+
+static void test_object() {
+  nyra_value_t *value = nyra_value_from_json_str(
+      R"({"start_ms": 9, "speech": true, "span": {"end": 4}})", nullptr);
+  CHECK(value != nullptr);
+
+  vad_event_t out{};
+  CHECK(ten::fixed_layout_from_value(value, out));
+  CHECK(out.start_ms == 9 && out.speech && out.span.end == 4);
+
+  nyra_value_destroy(value);
+}
+
+int main() {
+  test_padding();
+  test_larger_buf();
+  test_other_layout();
+  test_object();
+
+  printf("OK\n");
+  return 0;
+}
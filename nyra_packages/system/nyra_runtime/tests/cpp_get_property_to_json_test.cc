@@ -0,0 +1,79 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+// The 'get_property_to_json()' overload of 'ten::msg_t' which appends to a
+// caller's string, so that a string kept across the calls is reused.
+// 'ten::nyra_env_t' shares the same writer.
+//
+//   # From the root of the app, see the 'nyra_runtime_tests' target of '../BUILD.gn'.
+//   gn gen out --args='nyra_runtime_enable_tests=true'
+//   ninja -C out cpp_get_property_to_json_test
+//   out/cpp_get_property_to_json_test
+//
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "nyra_runtime/binding/cpp/ten.h"
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+              #cond);                                                 \
+      exit(1);                                                        \
+    }                                                                 \
+  } while (0)
+
+static void test_append() {
+  auto cmd = ten::cmd_t::create("test");
+  CHECK(cmd->set_property_from_json("a", R"({"b": [1, "x"]})"));
+
+  std::string out = "a=";
+  CHECK(cmd->get_property_to_json("a", out));
+  CHECK(out == R"(a={"b": [1, "x"]})");
+
+  out += ";b=";
+  CHECK(cmd->get_property_to_json("a.b", out));
+  CHECK(out == R"(a={"b": [1, "x"]};b=[1, "x"])");
+
+  // The returning overload gives the same text.
+  CHECK(cmd->get_property_to_json("a.b") == R"([1, "x"])");
+}
+
+static void test_reuse() {
+  auto cmd = ten::cmd_t::create("test");
+  CHECK(cmd->set_property_from_json("a", R"([1, 2, 3, 4, 5, 6, 7, 8, 9])"));
+
+  std::string out;
+  CHECK(cmd->get_property_to_json("a", out));
+  const char *data = out.data();
+
+  for (int i = 0; i < 100; i++) {
+    out.clear();
+    CHECK(cmd->get_property_to_json("a", out));
+  }
+  CHECK(out.data() == data);
+}
+
+static void test_missing() {
+  auto cmd = ten::cmd_t::create("test");
+
+  // Nothing is appended for a missing property.
+  std::string out = "unchanged";
+  ten::error_t err;
+  CHECK(!cmd->get_property_to_json("missing", out, &err));
+  CHECK(out == "unchanged");
+}
+
+int main() {
+  test_append();
+  test_reuse();
+  test_missing();
+
+  printf("OK\n");
+  return 0;
+}
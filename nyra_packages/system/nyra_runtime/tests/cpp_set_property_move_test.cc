@@ -0,0 +1,82 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+// The rvalue 'set_property()' overloads of 'ten::msg_t', which move the items
+// of a 'std::vector' or a 'std::map' into the property rather than cloning
+// them. 'ten::nyra_env_t' shares the same conversion.
+//
+//   # From the root of the app, see the 'nyra_runtime_tests' target of '../BUILD.gn'.
+//   gn gen out --args='nyra_runtime_enable_tests=true'
+//   ninja -C out cpp_set_property_move_test
+//   out/cpp_set_property_move_test
+//
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "nyra_runtime/binding/cpp/ten.h"
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+              #cond);                                                 \
+      exit(1);                                                        \
+    }                                                                 \
+  } while (0)
+
+static void test_vector() {
+  auto cmd = ten::cmd_t::create("test");
+
+  std::vector<int32_t> ints{1, 2, 3};
+  CHECK(cmd->set_property("ints", std::move(ints)));
+  CHECK(ints.empty());  // NOLINT(bugprone-use-after-move)
+  CHECK(cmd->get_property_to_json("ints") == "[1, 2, 3]");
+
+  std::vector<std::string> strs{"a", "b"};
+  CHECK(cmd->set_property("strs", std::move(strs)));
+  CHECK(cmd->get_property_to_json("strs") == R"(["a", "b"])");
+
+  std::vector<std::vector<bool>> nested{{true}, {false, true}};
+  CHECK(cmd->set_property("nested", std::move(nested)));
+  CHECK(cmd->get_property_to_json("nested") == "[[true], [false, true]]");
+}
+
+static void test_map() {
+  auto cmd = ten::cmd_t::create("test");
+
+  std::map<std::string, std::vector<int64_t>> map{{"a", {1}}, {"b", {2, 3}}};
+  CHECK(cmd->set_property("map", std::move(map)));
+  CHECK(map.empty());  // NOLINT(bugprone-use-after-move)
+  CHECK(cmd->get_property_int64("map.b[1]") == 3);
+  CHECK(cmd->get_property_to_json("map") == R"({"a": [1], "b": [2, 3]})");
+
+  // The keys are not taken as formats.
+  std::map<std::string, int32_t> fmt{{"%s%n", 1}};
+  CHECK(cmd->set_property("fmt", std::move(fmt)));
+  CHECK(cmd->get_property_to_json("fmt") == R"({"%s%n": 1})");
+}
+
+static void test_private_path() {
+  auto cmd = ten::cmd_t::create("test");
+
+  // The value is destroyed by 'set_property_impl()' when it is refused.
+  std::vector<int32_t> ints{1};
+  ten::error_t err;
+  CHECK(!cmd->set_property("__nyra.ints", std::move(ints), &err));
+  CHECK(!cmd->is_property_exist("__nyra.ints"));
+}
+
+int main() {
+  test_vector();
+  test_map();
+  test_private_path();
+
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,133 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+// The number members of 'nyra_utils/lang/cpp/lib/struct_binding.h' read from
+// JSON texts, whose integers are uint64 or int64 whatever the type of the
+// member they are meant for.
+//
+//   # From the root of the app, see the 'nyra_runtime_tests' target of '../BUILD.gn'.
+//   gn gen out --args='nyra_runtime_enable_tests=true'
+//   ninja -C out cpp_struct_binding_test
+//   out/cpp_struct_binding_test
+//
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "nyra_utils/lang/cpp/lib/struct_binding.h"
+#include "nyra_utils/value/value_json_parser.h"
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+              #cond);                                                 \
+      exit(1);                                                        \
+    }                                                                 \
+  } while (0)
+
+struct numbers_t {
+  bool b = false;
+  int8_t i8 = 0;
+  uint8_t u8 = 0;
+  int32_t i32 = 0;
+  uint32_t u32 = 0;
+  int64_t i64 = 0;
+  uint64_t u64 = 0;
+  float f = 0;
+  double d = 0;
+};
+
+NYRA_STRUCT_BINDING(numbers_t, NYRA_STRUCT_FIELD(numbers_t, b),
+                    NYRA_STRUCT_FIELD(numbers_t, i8),
+                    NYRA_STRUCT_FIELD(numbers_t, u8),
+                    NYRA_STRUCT_FIELD(numbers_t, i32),
+                    NYRA_STRUCT_FIELD(numbers_t, u32),
+                    NYRA_STRUCT_FIELD(numbers_t, i64),
+                    NYRA_STRUCT_FIELD(numbers_t, u64),
+                    NYRA_STRUCT_FIELD(numbers_t, f),
+                    NYRA_STRUCT_FIELD(numbers_t, d))
+
+struct named_t {
+  int32_t value = 0;
+};
+
+NYRA_STRUCT_BINDING(named_t, NYRA_STRUCT_FIELD_NAMED(named_t, value, "a%sb%n"))
+
+static bool read(const char *json, numbers_t &out) {
+  nyra_value_t *value = nyra_value_from_json_str(json, nullptr);
+  CHECK(value != nullptr);
+
+  nyra_error_t err;
+  nyra_error_init(&err);
+
+  bool rc = ten::struct_from_value(value, out, &err);
+  CHECK(rc == nyra_error_is_success(&err));
+
+  nyra_error_deinit(&err);
+  nyra_value_destroy(value);
+
+  return rc;
+}
+
+static void test_convert() {
+  numbers_t n;
+  CHECK(read(R"({"b": true, "i8": -128, "u8": 255, "i32": -5, "u32": 7,
+                 "i64": -9223372036854775808, "u64": 9223372036854775807,
+                 "f": 2, "d": 1})",
+             n));
+  CHECK(n.b);
+  CHECK(n.i8 == -128);
+  CHECK(n.u8 == 255);
+  CHECK(n.i32 == -5);
+  CHECK(n.u32 == 7);
+  CHECK(n.i64 == INT64_MIN);
+  CHECK(n.u64 == INT64_MAX);
+  CHECK(n.f == 2.0f);
+  CHECK(n.d == 1.0);
+
+  CHECK(read(R"({"f": -0.5, "d": -3})", n));
+  CHECK(n.f == -0.5f);
+  CHECK(n.d == -3.0);
+}
+
+static void test_reject() {
+  numbers_t n;
+  CHECK(!read(R"({"u8": 256})", n));
+  CHECK(!read(R"({"i8": -129})", n));
+  CHECK(!read(R"({"u32": -1})", n));
+  CHECK(!read(R"({"u64": -1})", n));
+  CHECK(!read(R"({"i32": 1.5})", n));
+  CHECK(!read(R"({"f": 1e300})", n));
+  CHECK(!read(R"({"d": "1"})", n));
+  CHECK(!read(R"({"b": 1})", n));
+}
+
+// The names are not taken as formats when the struct is written.
+static void test_format_names() {
+  named_t in;
+  in.value = 3;
+
+  nyra_value_t *value = ten::struct_to_value(in);
+  auto *kv = static_cast<nyra_value_kv_t *>(
+      nyra_ptr_listnode_get(nyra_list_front(&value->content.object)));
+  CHECK(strcmp(nyra_string_get_raw_str(&kv->key), "a%sb%n") == 0);
+
+  named_t out;
+  CHECK(ten::struct_from_value(value, out));
+  CHECK(out.value == 3);
+
+  nyra_value_destroy(value);
+}
+
+int main() {
+  test_convert();
+  test_reject();
+  test_format_names();
+
+  printf("OK\n");
+  return 0;
+}
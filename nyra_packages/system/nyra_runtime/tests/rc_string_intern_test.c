@@ -0,0 +1,91 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+// The interning of 'nyra_utils/lib/rc_string.h' while an interned string with
+// the same content is dying: its last reference is dropped, but its releaser
+// has not taken the lock of the table yet. It is meant to be built with
+// AddressSanitizer, which catches the table keeping the bytes of the freed
+// string as the key of the entry.
+//
+//   # From the root of the app, see the 'nyra_runtime_tests' target of '../BUILD.gn'.
+//   gn gen out --args='nyra_runtime_enable_tests=true'
+//   ninja -C out rc_string_intern_test
+//   out/rc_string_intern_test
+//
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "nyra_utils/lib/rc_string.h"
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+              #cond);                                                 \
+      exit(1);                                                        \
+    }                                                                 \
+  } while (0)
+
+#define THREAD_CNT 4
+#define ROUNDS 100000
+
+static void test_intern_while_dying(void) {
+  nyra_rc_string_t *dying = nyra_rc_string_intern("dying");
+
+  // The first half of 'nyra_rc_string_release()', the string is still in the
+  // table.
+  CHECK(nyra_rc_dec(&dying->ref_cnt));
+
+  nyra_rc_string_t *fresh = nyra_rc_string_intern("dying");
+  CHECK(fresh != dying);
+
+  // The second half, which must leave the entry of the fresh string alone.
+  nyra_rc_string_destroy_(dying);
+
+  nyra_rc_string_t *again = nyra_rc_string_intern("dying");
+  CHECK(again == fresh);
+  CHECK(nyra_rc_string_is_equal_c_str(again, "dying"));
+
+  nyra_rc_string_release(again);
+  nyra_rc_string_release(fresh);
+
+  // The last release removes the entry.
+  nyra_rc_string_t *last = nyra_rc_string_intern("dying");
+  CHECK(nyra_rc_get(&last->ref_cnt) == 1);
+  nyra_rc_string_release(last);
+}
+
+static void *intern_and_release(void *arg) {
+  (void)arg;
+
+  for (int i = 0; i < ROUNDS; i++) {
+    nyra_rc_string_t *str = nyra_rc_string_intern("shared");
+    CHECK(nyra_rc_string_is_equal_c_str(str, "shared"));
+    nyra_rc_string_release(str);
+  }
+
+  return NULL;
+}
+
+static void test_intern_release_race(void) {
+  pthread_t threads[THREAD_CNT];
+
+  for (int i = 0; i < THREAD_CNT; i++) {
+    CHECK(pthread_create(&threads[i], NULL, intern_and_release, NULL) == 0);
+  }
+  for (int i = 0; i < THREAD_CNT; i++) {
+    pthread_join(threads[i], NULL);
+  }
+}
+
+int main(void) {
+  test_intern_while_dying();
+  test_intern_release_race();
+
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,72 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+// The ids of 'nyra_utils/lib/uuid7.h' generated on both sides of a fork(),
+// whose child starts with a copy of the state of the forking thread.
+//
+//   # From the root of the app, see the 'nyra_runtime_tests' target of '../BUILD.gn'.
+//   gn gen out --args='nyra_runtime_enable_tests=true'
+//   ninja -C out uuid7_fork_test
+//   out/uuid7_fork_test
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "nyra_utils/lib/uuid7.h"
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+              #cond);                                                 \
+      exit(1);                                                        \
+    }                                                                 \
+  } while (0)
+
+#define ID_CNT 16
+
+int main(void) {
+  nyra_uuid7_t id;
+
+  // Seed the state of this thread before forking.
+  nyra_uuid7_gen(&id);
+
+  int fds[2];
+  CHECK(pipe(fds) == 0);
+
+  pid_t pid = fork();
+  CHECK(pid >= 0);
+
+  nyra_uuid7_t ids[ID_CNT];
+  for (int i = 0; i < ID_CNT; i++) {
+    nyra_uuid7_gen(&ids[i]);
+  }
+
+  if (pid == 0) {
+    ssize_t size = write(fds[1], ids, sizeof(ids));
+    _exit(size == (ssize_t)sizeof(ids) ? 0 : 1);
+  }
+
+  nyra_uuid7_t child_ids[ID_CNT];
+  CHECK(read(fds[0], child_ids, sizeof(child_ids)) ==
+        (ssize_t)sizeof(child_ids));
+
+  int status = 0;
+  CHECK(waitpid(pid, &status, 0) == pid);
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  for (int i = 0; i < ID_CNT; i++) {
+    for (int j = 0; j < ID_CNT; j++) {
+      CHECK(!nyra_uuid7_is_equal(&ids[i], &child_ids[j]));
+      CHECK(ids[i].lo != child_ids[j].lo);
+    }
+  }
+
+  printf("OK\n");
+  return 0;
+}
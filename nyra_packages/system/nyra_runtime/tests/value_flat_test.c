@@ -0,0 +1,96 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+// The flat values of 'nyra_utils/value/value_flat.h': the merge is recursive,
+// the keys come out sorted, and the keys with a '%' in them survive the way
+// back to a 'nyra_value_t'.
+//
+//   # From the root of the app, see the 'nyra_runtime_tests' target of '../BUILD.gn'.
+//   gn gen out --args='nyra_runtime_enable_tests=true'
+//   ninja -C out value_flat_test
+//   out/value_flat_test
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nyra_utils/lib/arena.h"
+#include "nyra_utils/lib/string.h"
+#include "nyra_utils/value/value.h"
+#include "nyra_utils/value/value_flat.h"
+#include "nyra_utils/value/value_json_parser.h"
+#include "nyra_utils/value/value_json_writer.h"
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+              #cond);                                                 \
+      exit(1);                                                        \
+    }                                                                 \
+  } while (0)
+
+static const nyra_value_flat_t *flat_from_json(nyra_arena_t *arena,
+                                               const char *json) {
+  nyra_value_t *value = nyra_value_from_json_str(json, NULL);
+  CHECK(value);
+
+  const nyra_value_flat_t *flat = nyra_value_flat_from_value(arena, value, NULL);
+  CHECK(flat);
+
+  nyra_value_destroy(value);
+  return flat;
+}
+
+// The JSON text of @a flat, once back to a 'nyra_value_t'.
+static void check_json(const nyra_value_flat_t *flat, const char *expected) {
+  nyra_value_t *value = nyra_value_flat_to_value(flat);
+
+  nyra_string_t json;
+  nyra_string_init(&json);
+  CHECK(nyra_value_to_json_string(value, &json));
+  if (strcmp(nyra_string_get_raw_str(&json), expected) != 0) {
+    fprintf(stderr, "Expected %s, got %s\n", expected,
+            nyra_string_get_raw_str(&json));
+    exit(1);
+  }
+
+  nyra_string_deinit(&json);
+  nyra_value_destroy(value);
+}
+
+static void test_merge(void) {
+  nyra_arena_t *arena = nyra_arena_create(0);
+
+  const nyra_value_flat_t *base = flat_from_json(
+      arena, "{\"tts\":{\"voice\":\"a\",\"rate\":1},\"llm\":\"x\"}");
+  const nyra_value_flat_t *overrides =
+      flat_from_json(arena, "{\"tts\":{\"voice\":\"b\"},\"asr\":[1]}");
+
+  // The nested object is merged rather than replaced, and the keys are sorted.
+  check_json(nyra_value_flat_merge(arena, base, overrides),
+             "{\"asr\": [1], \"llm\": \"x\", \"tts\": {\"rate\": 1, "
+             "\"voice\": \"b\"}}");
+
+  nyra_arena_release(arena);
+}
+
+static void test_format_keys(void) {
+  nyra_arena_t *arena = nyra_arena_create(0);
+
+  check_json(flat_from_json(arena, "{\"%s%n\":{\"\":1,\"%d\":2}}"),
+             "{\"%s%n\": {\"\": 1, \"%d\": 2}}");
+
+  nyra_arena_release(arena);
+}
+
+int main(void) {
+  test_merge();
+  test_format_keys();
+
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,308 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+// 'nyra_value_from_json_str()' of 'nyra_utils/value/value_json_parser.h'
+// against the tree path, 'nyra_json_from_string()' + 'nyra_value_from_json()'.
+// Both must accept the same texts, and build the same values, types included,
+// for hand-written cases and for random mutations of them.
+//
+//   # From the root of the app, see the 'nyra_runtime_tests' target of '../BUILD.gn'.
+//   gn gen out --args='nyra_runtime_enable_tests=true'
+//   ninja -C out value_json_parser_test
+//   out/value_json_parser_test [mutations]
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nyra_utils/container/list.h"
+#include "nyra_utils/container/list_node_ptr.h"
+#include "nyra_utils/lib/json.h"
+#include "nyra_utils/lib/string.h"
+#include "nyra_utils/value/value.h"
+#include "nyra_utils/value/value_get.h"
+#include "nyra_utils/value/value_json.h"
+#include "nyra_utils/value/value_json_parser.h"
+#include "nyra_utils/value/value_kv.h"
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+              #cond);                                                 \
+      exit(1);                                                        \
+    }                                                                 \
+  } while (0)
+
+static const char *cases[] = {
+    // Accepted.
+    "null",
+    "true",
+    "false",
+    "0",
+    "-0",
+    "42",
+    "-42",
+    "9223372036854775807",
+    "-9223372036854775808",
+    "1.5",
+    "-1e-3",
+    "1E+10",
+    "0.1e1",
+    "\"\"",
+    "\"plain\"",
+    "\"esc \\\" \\\\ \\/ \\b \\f \\n \\r \\t\"",
+    "\"\\u00e9\\u4e2d\\ud83d\\ude00\"",
+    "\"\xc3\xa9\xe4\xb8\xad\xf0\x9f\x98\x80\"",
+    "[]",
+    "{}",
+    " [ 1 , [ 2 , [ ] ] , { } ] ",
+    "{\"a\":1,\"b\":[true,null],\"c\":{\"d\":\"e\"}}",
+    "{\"a\":1,\"a\":2}",
+    "{\"a\":1,\"b\":2,\"a\":3}",
+    "{\"k0\":0,\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,\"k6\":6,\"k7\":7,"
+    "\"k8\":8,\"k9\":9,\"k3\":33,\"k10\":10}",
+    "{\"tool_calls\":[{\"id\":\"call_1\",\"type\":\"function\",\"function\":{"
+    "\"name\":\"get_weather\",\"arguments\":\"{\\\"city\\\":\\\"Paris\\\"}\"}}"
+    "]}",
+
+    // Rejected.
+    "",
+    " ",
+    "nul",
+    "01",
+    "-",
+    "1.",
+    ".5",
+    "1e",
+    "+1",
+    "9223372036854775808",
+    "-9223372036854775809",
+    "\"unterminated",
+    "\"\\x\"",
+    "\"\\u00\"",
+    "\"\\u0000\"",
+    "\"\\ud83d\"",
+    "\"\\ude00\"",
+    "\"\xc3\"",
+    "\"\xc0\xaf\"",
+    "\"\xed\xa0\x80\"",
+    "\"tab\there\"",
+    "[1,]",
+    "[1 2]",
+    "{\"a\"}",
+    "{\"a\":}",
+    "{\"a\":1,}",
+    "{1:2}",
+    "[] []",
+    "{\"a\":1} x",
+};
+
+static nyra_value_t *parse_with_tree(const char *json) {
+  nyra_json_t *tree = nyra_json_from_string(json, NULL);
+  if (!tree) {
+    return NULL;
+  }
+
+  nyra_value_t *value = nyra_value_from_json(tree);
+  nyra_json_destroy(tree);
+
+  return value;
+}
+
+static bool is_same_string(nyra_string_t *a, nyra_string_t *b) {
+  return nyra_string_len(a) == nyra_string_len(b) &&
+         memcmp(nyra_string_get_raw_str(a), nyra_string_get_raw_str(b),
+                nyra_string_len(a)) == 0;
+}
+
+static bool is_same_value(nyra_value_t *a, nyra_value_t *b) {
+  if (nyra_value_get_type(a) != nyra_value_get_type(b)) {
+    return false;
+  }
+
+  switch (nyra_value_get_type(a)) {
+    case NYRA_TYPE_NULL:
+      return true;
+    case NYRA_TYPE_BOOL:
+      return a->content.boolean == b->content.boolean;
+    case NYRA_TYPE_INT64:
+      return a->content.int64 == b->content.int64;
+    case NYRA_TYPE_UINT64:
+      return a->content.uint64 == b->content.uint64;
+    case NYRA_TYPE_FLOAT64:
+      return memcmp(&a->content.float64, &b->content.float64,
+                    sizeof(double)) == 0;
+    case NYRA_TYPE_STRING:
+      return is_same_string(&a->content.string, &b->content.string);
+    case NYRA_TYPE_ARRAY:
+    case NYRA_TYPE_OBJECT: {
+      bool is_object = nyra_value_get_type(a) == NYRA_TYPE_OBJECT;
+      nyra_list_t *la = is_object ? &a->content.object : &a->content.array;
+      nyra_list_t *lb = is_object ? &b->content.object : &b->content.array;
+      if (nyra_list_size(la) != nyra_list_size(lb)) {
+        return false;
+      }
+
+      // The keys of an object must come in the same order too.
+      for (nyra_listnode_t *na = nyra_list_front(la), *nb = nyra_list_front(lb);
+           na; na = na->next, nb = nb->next) {
+        void *ia = nyra_ptr_listnode_get(na);
+        void *ib = nyra_ptr_listnode_get(nb);
+        if (is_object) {
+          nyra_value_kv_t *kva = (nyra_value_kv_t *)ia;
+          nyra_value_kv_t *kvb = (nyra_value_kv_t *)ib;
+          if (!is_same_string(&kva->key, &kvb->key) ||
+              !is_same_value(kva->value, kvb->value)) {
+            return false;
+          }
+        } else if (!is_same_value((nyra_value_t *)ia, (nyra_value_t *)ib)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+// Return whether @a json is accepted.
+static bool check_same(const char *json) {
+  nyra_error_t err;
+  nyra_error_init(&err);
+
+  nyra_value_t *expected = parse_with_tree(json);
+  nyra_value_t *actual = nyra_value_from_json_str(json, &err);
+
+  if (!expected != !actual || (expected && !is_same_value(expected, actual))) {
+    fprintf(stderr, "Mismatch on: %s\n", json);
+    exit(1);
+  }
+
+  // A rejected text tells why.
+  CHECK(actual || !nyra_error_is_success(&err));
+
+  bool accepted = actual != NULL;
+  if (expected) {
+    nyra_value_destroy(expected);
+    nyra_value_destroy(actual);
+  }
+  nyra_error_deinit(&err);
+
+  return accepted;
+}
+
+static void test_cases(void) {
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    check_same(cases[i]);
+  }
+
+  CHECK(check_same("[1.5,\"x\"]"));
+  CHECK(!check_same("[1.5,\"x\""));
+}
+
+static bool check_depth(size_t depth) {
+  char *json = (char *)malloc(depth * 2 + 1);
+  CHECK(json);
+
+  memset(json, '[', depth);
+  memset(json + depth, ']', depth);
+  json[depth * 2] = '\0';
+
+  bool accepted = check_same(json);
+  free(json);
+
+  return accepted;
+}
+
+static void test_depth(void) {
+  CHECK(check_depth(NYRA_VALUE_JSON_PARSER_MAX_DEPTH));
+  CHECK(!check_depth(NYRA_VALUE_JSON_PARSER_MAX_DEPTH + 1));
+}
+
+// 'nyra_value_from_json()' passes the keys to 'nyra_value_kv_create_empty()',
+// which takes them as formats, so only the parser is checked here.
+static void test_format_keys(void) {
+  const char *json = "{\"%s%n\":1,\"\":2,\"%s%n\":3}";
+
+  nyra_value_t *value = nyra_value_from_json_str(json, NULL);
+  CHECK(value && nyra_list_size(&value->content.object) == 2);
+
+  nyra_value_kv_t *kv = (nyra_value_kv_t *)nyra_ptr_listnode_get(
+      nyra_list_front(&value->content.object));
+  CHECK(strcmp(nyra_string_get_raw_str(&kv->key), "%s%n") == 0);
+  CHECK(kv->value->content.uint64 == 3);
+
+  nyra_value_destroy(value);
+}
+
+// Flip, insert or delete a few bytes, mostly the ones the grammar cares
+// about, so that many mutants are still valid and reach deep into the parser.
+static void mutate(char *buf, size_t *len, size_t cap) {
+  static const char interesting[] = "{}[]:,\"\\0123456789.eE+-tfnu \x80\xc3";
+
+  int edits = 1 + rand() % 3;
+  for (int i = 0; i < edits; i++) {
+    char c = rand() % 4 ? interesting[rand() % (sizeof(interesting) - 1)]
+                        : (char)(1 + rand() % 255);
+    if (c == '%') {
+      // The tree path takes the keys as formats, see 'test_format_keys()'.
+      c = '#';
+    }
+    size_t pos = *len ? (size_t)rand() % (*len + 1) : 0;
+
+    switch (rand() % 3) {
+      case 0:
+        if (pos < *len) {
+          buf[pos] = c;
+        }
+        break;
+      case 1:
+        if (*len + 1 < cap) {
+          memmove(buf + pos + 1, buf + pos, *len - pos);
+          buf[pos] = c;
+          (*len)++;
+        }
+        break;
+      default:
+        if (pos < *len) {
+          memmove(buf + pos, buf + pos + 1, *len - pos - 1);
+          (*len)--;
+        }
+        break;
+    }
+  }
+  buf[*len] = '\0';
+}
+
+static void test_mutations(int cnt) {
+  char buf[1024];
+  size_t case_cnt = sizeof(cases) / sizeof(cases[0]);
+  int accepted = 0;
+
+  srand(1);
+  for (int i = 0; i < cnt; i++) {
+    const char *seed = cases[(size_t)rand() % case_cnt];
+    size_t len = strlen(seed);
+    memcpy(buf, seed, len + 1);
+
+    mutate(buf, &len, sizeof(buf));
+    accepted += check_same(buf);
+  }
+
+  printf("%d mutations, %d accepted\n", cnt, accepted);
+}
+
+int main(int argc, char **argv) {
+  test_cases();
+  test_depth();
+  test_format_keys();
+  test_mutations(argc > 1 ? atoi(argv[1]) : 100000);
+
+  printf("OK\n");
+  return 0;
+}
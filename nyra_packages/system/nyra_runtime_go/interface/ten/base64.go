@@ -0,0 +1,178 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+
+package ten
+
+import (
+	"bytes"
+	"encoding/base64"
+)
+
+// Base64Encoder encodes a stream of bytes into standard base64 chunk by chunk,
+// ex: the audio frames sent to a realtime API, without joining the chunks
+// first. The encoding is appended to a []byte which could be reused. The bytes
+// which do not fill a group of 3 are kept for the next chunk.
+//
+// The zero value is ready to use.
+type Base64Encoder struct {
+	pending    [3]byte
+	pendingLen int
+}
+
+// Base64Decoder decodes a stream of standard base64 chunk by chunk, ex: the
+// audio deltas received from a realtime API, without joining the chunks first.
+// The decoding is strict: line breaks, characters out of the alphabet or data
+// after the padding are errors. The characters which do not fill a group of 4
+// are kept for the next chunk.
+//
+// The zero value is ready to use.
+type Base64Decoder struct {
+	pending    [4]byte
+	pendingLen int
+	padded     bool
+}
+
+// base64Grow extends dst by n bytes, reallocating it if there is no room.
+func base64Grow(dst []byte, n int) []byte {
+	if cap(dst)-len(dst) < n {
+		grown := make([]byte, len(dst), 2*cap(dst)+n)
+		copy(grown, dst)
+		dst = grown
+	}
+
+	return dst[:len(dst)+n]
+}
+
+// Append appends the encoding of the next chunk of the stream to dst.
+func (e *Base64Encoder) Append(dst []byte, src []byte) []byte {
+	total := e.pendingLen + len(src)
+	if total < 3 {
+		e.pendingLen += copy(e.pending[e.pendingLen:], src)
+		return dst
+	}
+
+	start := len(dst)
+	dst = base64Grow(dst, total/3*4)
+	out := dst[start:]
+
+	if e.pendingLen > 0 {
+		taken := copy(e.pending[e.pendingLen:], src)
+		base64.StdEncoding.Encode(out, e.pending[:])
+		out = out[4:]
+		src = src[taken:]
+	}
+
+	whole := len(src) / 3 * 3
+	base64.StdEncoding.Encode(out, src[:whole])
+	e.pendingLen = copy(e.pending[:], src[whole:])
+
+	return dst
+}
+
+// Finish appends the encoding of the end of the stream, with the padding, to
+// dst. The encoder could be used for another stream then.
+func (e *Base64Encoder) Finish(dst []byte) []byte {
+	if e.pendingLen == 0 {
+		return dst
+	}
+
+	start := len(dst)
+	dst = base64Grow(dst, 4)
+	base64.StdEncoding.Encode(dst[start:], e.pending[:e.pendingLen])
+	e.pendingLen = 0
+
+	return dst
+}
+
+func (d *Base64Decoder) decode(dst []byte, src []byte) (int, error) {
+	if d.padded {
+		return 0, newTenError(
+			ErrnoInvalidArgument,
+			"base64 data after the padding",
+		)
+	}
+
+	// They are skipped by encoding/base64.
+	if bytes.IndexByte(src, '\n') >= 0 || bytes.IndexByte(src, '\r') >= 0 {
+		return 0, newTenError(ErrnoInvalidArgument, "line break in base64 data")
+	}
+
+	n, err := base64.StdEncoding.Decode(dst, src)
+	if err != nil {
+		return 0, newTenError(ErrnoInvalidArgument, err.Error())
+	}
+
+	d.padded = src[len(src)-1] == '='
+	return n, nil
+}
+
+// Append appends the decoding of the next chunk of the stream to dst. dst is
+// returned as it was on error, and the decoder must be finished then.
+func (d *Base64Decoder) Append(dst []byte, src []byte) ([]byte, error) {
+	total := d.pendingLen + len(src)
+	if total < 4 {
+		if len(src) > 0 && d.padded {
+			return dst, newTenError(
+				ErrnoInvalidArgument,
+				"base64 data after the padding",
+			)
+		}
+
+		d.pendingLen += copy(d.pending[d.pendingLen:], src)
+		return dst, nil
+	}
+
+	start := len(dst)
+	dst = base64Grow(dst, total/4*3)
+	n := 0
+
+	if d.pendingLen > 0 {
+		taken := copy(d.pending[d.pendingLen:], src)
+		decoded, err := d.decode(dst[start:], d.pending[:])
+		if err != nil {
+			return dst[:start], err
+		}
+
+		n += decoded
+		src = src[taken:]
+		d.pendingLen = 0
+	}
+
+	whole := len(src) / 4 * 4
+	if whole > 0 {
+		decoded, err := d.decode(dst[start+n:], src[:whole])
+		if err != nil {
+			return dst[:start], err
+		}
+
+		n += decoded
+	}
+
+	rest := src[whole:]
+	if len(rest) > 0 && d.padded {
+		return dst[:start], newTenError(
+			ErrnoInvalidArgument,
+			"base64 data after the padding",
+		)
+	}
+	d.pendingLen = copy(d.pending[:], rest)
+
+	return dst[:start+n], nil
+}
+
+// Finish checks the end of the stream, and returns an error if it is
+// truncated. The decoder could be used for another stream then.
+func (d *Base64Decoder) Finish() error {
+	truncated := d.pendingLen > 0
+	*d = Base64Decoder{}
+
+	if truncated {
+		return newTenError(ErrnoInvalidArgument, "truncated base64 data")
+	}
+
+	return nil
+}
@@ -0,0 +1,87 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+
+package ten
+
+import (
+	"bytes"
+	"encoding/base64"
+	"math/rand"
+	"testing"
+)
+
+func TestBase64Stream(t *testing.T) {
+	r := rand.New(rand.NewSource(1))
+
+	for size := 0; size < 300; size++ {
+		data := make([]byte, size)
+		r.Read(data)
+		expected := base64.StdEncoding.EncodeToString(data)
+
+		var e Base64Encoder
+		var encoded []byte
+		for rest := data; len(rest) > 0; {
+			n := r.Intn(20)
+			if n > len(rest) {
+				n = len(rest)
+			}
+			encoded = e.Append(encoded, rest[:n])
+			rest = rest[n:]
+		}
+		encoded = e.Finish(encoded)
+
+		if string(encoded) != expected {
+			t.Fatalf("%d: unexpected encoding %s", size, encoded)
+		}
+
+		var d Base64Decoder
+		var decoded []byte
+		for rest := encoded; len(rest) > 0; {
+			n := r.Intn(20)
+			if n > len(rest) {
+				n = len(rest)
+			}
+
+			var err error
+			decoded, err = d.Append(decoded, rest[:n])
+			if err != nil {
+				t.Fatalf("%d: %v", size, err)
+			}
+			rest = rest[n:]
+		}
+
+		if err := d.Finish(); err != nil || !bytes.Equal(decoded, data) {
+			t.Fatalf("%d: unexpected decoding %v", size, err)
+		}
+	}
+}
+
+func TestBase64DecoderErrors(t *testing.T) {
+	for _, chunks := range [][]string{
+		{"Zg="},
+		{"Zm9v\nYmFy"},
+		{"Zm9-"},
+		{"Zg==", "Zg=="},
+		{"Zg", "==Zg"},
+		{"Zg==Zg=="},
+	} {
+		var d Base64Decoder
+		var err error
+		for _, chunk := range chunks {
+			if _, err = d.Append(nil, []byte(chunk)); err != nil {
+				break
+			}
+		}
+		if err == nil {
+			err = d.Finish()
+		}
+
+		if err == nil {
+			t.Errorf("%q: expected an error", chunks)
+		}
+	}
+}
@@ -0,0 +1,160 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+
+//go:build unix
+
+package ten
+
+import (
+	"os"
+	"sync/atomic"
+	"syscall"
+)
+
+// MmapAdvice is a hint about how the content of a MmapFile will be accessed.
+type MmapAdvice int
+
+const (
+	MmapAdviceNormal MmapAdvice = iota
+
+	// The pages will be accessed in order, the kernel could read ahead more
+	// aggressively.
+	MmapAdviceSequential
+
+	MmapAdviceRandom
+
+	// The pages will be needed soon, start reading them in now.
+	MmapAdviceWillNeed
+)
+
+// MmapFile is a read-only, reference counted view of a whole file. It is used
+// to read large documents, audio prompts and model assets without copying them
+// into the Go heap. The content stays valid until the last reference is
+// released, even if the file is removed.
+//
+// The mapping is owned by Go, so it could not back the buf of a message the
+// way nyra_data_set_buf_with_mmap_file() does in C. Passing Bytes() to
+// SetPropertyBytes or to the buf of a Data copies the content.
+type MmapFile struct {
+	data []byte
+	refs atomic.Int32
+}
+
+// OpenMmapFile maps the whole file at path into memory. The returned MmapFile
+// holds one reference, call Release() when it is no longer needed.
+func OpenMmapFile(path string, advice MmapAdvice) (*MmapFile, error) {
+	f, err := os.Open(path)
+	if err != nil {
+		return nil, newTenError(ErrnoInvalidArgument, err.Error())
+	}
+
+	// The mapping does not depend on the file descriptor anymore.
+	defer f.Close()
+
+	st, err := f.Stat()
+	if err != nil {
+		return nil, newTenError(ErrnoGeneric, err.Error())
+	}
+
+	if !st.Mode().IsRegular() {
+		return nil, newTenError(ErrnoInvalidArgument, "not a regular file")
+	}
+
+	m := &MmapFile{}
+	m.refs.Store(1)
+
+	if st.Size() == 0 {
+		// Nothing to map for an empty file.
+		return m, nil
+	}
+
+	m.data, err = syscall.Mmap(
+		int(f.Fd()),
+		0,
+		int(st.Size()),
+		syscall.PROT_READ,
+		syscall.MAP_PRIVATE,
+	)
+	if err != nil {
+		return nil, newTenError(ErrnoGeneric, err.Error())
+	}
+
+	if advice != MmapAdviceNormal {
+		// It is only a hint, the failure does not matter.
+		_ = m.Advise(advice)
+	}
+
+	return m, nil
+}
+
+// Advise gives the kernel a hint about how the content will be accessed.
+func (m *MmapFile) Advise(advice MmapAdvice) error {
+	if len(m.data) == 0 {
+		return nil
+	}
+
+	sysAdvice := syscall.MADV_NORMAL
+	switch advice {
+	case MmapAdviceSequential:
+		sysAdvice = syscall.MADV_SEQUENTIAL
+	case MmapAdviceRandom:
+		sysAdvice = syscall.MADV_RANDOM
+	case MmapAdviceWillNeed:
+		sysAdvice = syscall.MADV_WILLNEED
+	}
+
+	if err := syscall.Madvise(m.data, sysAdvice); err != nil {
+		return newTenError(ErrnoGeneric, err.Error())
+	}
+
+	return nil
+}
+
+// Bytes returns the content of the file. The returned slice must not be
+// modified, and must not be used after the last reference is released.
+func (m *MmapFile) Bytes() []byte {
+	return m.data
+}
+
+// Size returns the size of the file.
+func (m *MmapFile) Size() int {
+	return len(m.data)
+}
+
+// Retain takes one more reference.
+func (m *MmapFile) Retain() *MmapFile {
+	if m.refs.Add(1) <= 1 {
+		panic("MmapFile has been released")
+	}
+
+	return m
+}
+
+// Release drops one reference, the file will be unmapped when the last one is
+// dropped.
+func (m *MmapFile) Release() error {
+	refs := m.refs.Add(-1)
+	if refs > 0 {
+		return nil
+	}
+
+	if refs < 0 {
+		return newTenError(ErrnoGeneric, "MmapFile has been released")
+	}
+
+	data := m.data
+	m.data = nil
+	if len(data) == 0 {
+		return nil
+	}
+
+	if err := syscall.Munmap(data); err != nil {
+		return newTenError(ErrnoGeneric, err.Error())
+	}
+
+	return nil
+}
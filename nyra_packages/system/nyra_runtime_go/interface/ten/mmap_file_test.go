@@ -0,0 +1,88 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+
+//go:build unix
+
+package ten
+
+import (
+	"bytes"
+	"os"
+	"path/filepath"
+	"testing"
+)
+
+func TestMmapFile(t *testing.T) {
+	content := bytes.Repeat([]byte("nyra"), 4096)
+
+	path := filepath.Join(t.TempDir(), "asset.bin")
+	if err := os.WriteFile(path, content, 0o644); err != nil {
+		t.FailNow()
+	}
+
+	m, err := OpenMmapFile(path, MmapAdviceSequential)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	if m.Size() != len(content) || !bytes.Equal(m.Bytes(), content) {
+		t.FailNow()
+	}
+
+	// The view stays valid after the file is removed.
+	if err := os.Remove(path); err != nil {
+		t.FailNow()
+	}
+
+	m.Retain()
+	if err := m.Release(); err != nil {
+		t.Fatal(err)
+	}
+
+	if !bytes.Equal(m.Bytes(), content) {
+		t.FailNow()
+	}
+
+	if err := m.Release(); err != nil {
+		t.Fatal(err)
+	}
+
+	if m.Bytes() != nil {
+		t.FailNow()
+	}
+
+	if err := m.Release(); err == nil {
+		t.FailNow()
+	}
+}
+
+func TestMmapFileEmpty(t *testing.T) {
+	path := filepath.Join(t.TempDir(), "empty.bin")
+	if err := os.WriteFile(path, nil, 0o644); err != nil {
+		t.FailNow()
+	}
+
+	m, err := OpenMmapFile(path, MmapAdviceNormal)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	if m.Size() != 0 {
+		t.FailNow()
+	}
+
+	if err := m.Release(); err != nil {
+		t.Fatal(err)
+	}
+}
+
+func TestMmapFileNotExist(t *testing.T) {
+	_, err := OpenMmapFile(filepath.Join(t.TempDir(), "none"), MmapAdviceNormal)
+	if err == nil {
+		t.FailNow()
+	}
+}
@@ -11,9 +11,34 @@ package ten
 import "C"
 import (
 	"fmt"
+	"strings"
 	"unsafe"
 )
 
+// msgPrivatePropertyNS is NYRA_MSG_PRIVATE_PROPERTY_NS from NYRA runtime. The
+// runtime ties resources to the lifetime of a message through the properties
+// under it, ex: the mmap file behind the buf of a data message, so they must
+// not be overwritten from Go.
+const msgPrivatePropertyNS = "__nyra"
+
+// isPrivatePropertyPath is the Go version of
+// nyra_msg_property_path_is_private().
+func isPrivatePropertyPath(path string) bool {
+	rest, found := strings.CutPrefix(path, msgPrivatePropertyNS)
+	if !found {
+		return false
+	}
+
+	return len(rest) == 0 || rest[0] == '.' || rest[0] == '['
+}
+
+func newPrivatePropertyError(path string) error {
+	return newTenError(
+		ErrnoInvalidArgument,
+		fmt.Sprintf("private property: %s", path),
+	)
+}
+
 func (p *msg) getPropertyTypeAndSize(
 	path string,
 	size *propSizeInC,
@@ -440,6 +465,10 @@ func (p *msg) SetPropertyString(path string, value string) error {
 		)
 	}
 
+	if isPrivatePropertyPath(path) {
+		return newPrivatePropertyError(path)
+	}
+
 	defer p.keepAlive()
 
 	return withCGO(func() error {
@@ -480,6 +509,10 @@ func (p *msg) SetPropertyBytes(path string, value []byte) error {
 		)
 	}
 
+	if isPrivatePropertyPath(path) {
+		return newPrivatePropertyError(path)
+	}
+
 	defer p.keepAlive()
 
 	return withCGO(func() error {
@@ -670,6 +703,10 @@ func (p *msg) SetProperty(path string, value any) error {
 		)
 	}
 
+	if isPrivatePropertyPath(path) {
+		return newPrivatePropertyError(path)
+	}
+
 	defer p.keepAlive()
 
 	return withCGO(func() error {
@@ -698,6 +735,10 @@ func (p *msg) setPropertyFromJSONBytes(path string, value []byte) error {
 // structure is already known beforehand through certain methods, GetProperty
 // can be used to retrieve individual fields.
 func (p *msg) SetPropertyFromJSONBytes(path string, value []byte) error {
+	if isPrivatePropertyPath(path) {
+		return newPrivatePropertyError(path)
+	}
+
 	return withCGO(func() error {
 		return p.setPropertyFromJSONBytes(path, value)
 	})
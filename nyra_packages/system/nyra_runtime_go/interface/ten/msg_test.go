@@ -384,3 +384,30 @@ func BenchmarkMsgGetPropJSON(b *testing.B) {
 	}
 	b.ReportAllocs()
 }
+
+func TestMsgSetPrivateProperty(t *testing.T) {
+	c, err := NewCmd("test")
+	if err != nil {
+		t.FailNow()
+	}
+
+	if err := c.SetProperty("__nyra.mmap_file", 1); err == nil {
+		t.FailNow()
+	}
+
+	if err := c.SetPropertyString("__nyra", "a"); err == nil {
+		t.FailNow()
+	}
+
+	if err := c.SetPropertyFromJSONBytes(
+		"__nyra[0]",
+		[]byte(`{}`),
+	); err == nil {
+		t.FailNow()
+	}
+
+	// Only the exact namespace is private.
+	if err := c.SetProperty("__nyra_user", 1); err != nil {
+		t.FailNow()
+	}
+}
@@ -46,6 +46,9 @@ type TenEnv interface {
 	iProperty
 	InitPropertyFromJSONBytes(value []byte) error
 
+	SubscribeProperty(subtree string, handler PropertyChangedHandler) (uint64, error)
+	UnsubscribeProperty(id uint64) bool
+
 	LogVerbose(msg string)
 	LogDebug(msg string)
 	LogInfo(msg string)
@@ -88,6 +91,8 @@ type tenEnv struct {
 
 	attachToType tenAttachTo
 	attachTo     unsafe.Pointer
+
+	propertyWatcher propertyWatcher
 }
 
 func (p *tenEnv) attachToExtension(ext *extension) {
@@ -606,6 +606,9 @@ func (p *tenEnv) SetProperty(path string, value any) error {
 
 		// Wait for the async operation to complete.
 		err = <-done
+		if err == nil {
+			p.propertyWatcher.notify(p, path)
+		}
 
 		return err
 	})
@@ -646,6 +649,9 @@ func (p *tenEnv) SetPropertyString(
 
 		// Wait for the async operation to complete.
 		err = <-done
+		if err == nil {
+			p.propertyWatcher.notify(p, path)
+		}
 
 		return err
 	})
@@ -689,6 +695,9 @@ func (p *tenEnv) SetPropertyBytes(
 
 		// Wait for the async operation to complete.
 		err = <-done
+		if err == nil {
+			p.propertyWatcher.notify(p, path)
+		}
 
 		return err
 	})
@@ -718,6 +727,9 @@ func (p *tenEnv) setPropertyFromJSONBytes(path string, value []byte) error {
 
 	// Wait for the async operation to complete.
 	err = <-done
+	if err == nil {
+		p.propertyWatcher.notify(p, path)
+	}
 
 	return err
 }
@@ -0,0 +1,199 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+
+package ten
+
+import (
+	"strings"
+	"sync"
+)
+
+// PropertyChangedHandler is called with the paths of the properties which have
+// changed under the subtree of a subscription.
+type PropertyChangedHandler func(tenEnv TenEnv, paths []string)
+
+type propertySubscription struct {
+	id      uint64
+	subtree string
+	handler PropertyChangedHandler
+}
+
+// propertyWatcher calls the subscriptions to the properties of a tenEnv when
+// they are set through it. The changes made while the previous ones are being
+// dispatched, or before the dispatching goroutine runs, are batched into a
+// single call per subscription. The calls of the handlers never overlap with
+// each other, but they run on that goroutine, not on the one of the extension.
+type propertyWatcher struct {
+	mu sync.Mutex
+
+	subscriptions []propertySubscription
+	lastID        uint64
+
+	changed     []string
+	dispatching bool
+}
+
+// isPropertyPathRelated returns whether a change of path is a change of the
+// subtree, i.e. one of them is the other or a descendant of it.
+func isPropertyPathRelated(subtree string, path string) bool {
+	if len(subtree) == 0 {
+		return true
+	}
+
+	long, short := path, subtree
+	if len(subtree) > len(path) {
+		long, short = subtree, path
+	}
+
+	if !strings.HasPrefix(long, short) {
+		return false
+	}
+	if len(long) == len(short) {
+		return true
+	}
+
+	next := long[len(short)]
+	return next == '.' || next == '['
+}
+
+func (w *propertyWatcher) subscribe(
+	subtree string,
+	handler PropertyChangedHandler,
+) uint64 {
+	w.mu.Lock()
+	defer w.mu.Unlock()
+
+	w.lastID++
+	w.subscriptions = append(w.subscriptions, propertySubscription{
+		id:      w.lastID,
+		subtree: subtree,
+		handler: handler,
+	})
+
+	return w.lastID
+}
+
+func (w *propertyWatcher) isSubscribed(id uint64) bool {
+	w.mu.Lock()
+	defer w.mu.Unlock()
+
+	for i := range w.subscriptions {
+		if w.subscriptions[i].id == id {
+			return true
+		}
+	}
+
+	return false
+}
+
+func (w *propertyWatcher) unsubscribe(id uint64) bool {
+	w.mu.Lock()
+	defer w.mu.Unlock()
+
+	for i := range w.subscriptions {
+		if w.subscriptions[i].id == id {
+			// Copied on write, as a dispatch might be walking the old slice.
+			subscriptions := make(
+				[]propertySubscription,
+				0,
+				len(w.subscriptions)-1,
+			)
+			subscriptions = append(subscriptions, w.subscriptions[:i]...)
+			w.subscriptions = append(subscriptions, w.subscriptions[i+1:]...)
+			return true
+		}
+	}
+
+	return false
+}
+
+func (w *propertyWatcher) notify(tenEnv TenEnv, path string) {
+	w.mu.Lock()
+	defer w.mu.Unlock()
+
+	if len(w.subscriptions) == 0 {
+		return
+	}
+
+	for _, changed := range w.changed {
+		if changed == path {
+			path = ""
+			break
+		}
+	}
+	if len(path) > 0 {
+		w.changed = append(w.changed, path)
+	}
+
+	if !w.dispatching {
+		w.dispatching = true
+		go w.dispatch(tenEnv)
+	}
+}
+
+func (w *propertyWatcher) dispatch(tenEnv TenEnv) {
+	for {
+		w.mu.Lock()
+		changed := w.changed
+		subscriptions := w.subscriptions
+		w.changed = nil
+
+		if len(changed) == 0 {
+			w.dispatching = false
+			w.mu.Unlock()
+			return
+		}
+		w.mu.Unlock()
+
+		for _, subscription := range subscriptions {
+			var related []string
+			for _, path := range changed {
+				if isPropertyPathRelated(subscription.subtree, path) {
+					related = append(related, path)
+				}
+			}
+
+			// Removed by a previous handler, or by another goroutine, since the
+			// batch has been taken.
+			if len(related) > 0 && w.isSubscribed(subscription.id) {
+				subscription.handler(tenEnv, related)
+			}
+		}
+	}
+}
+
+// SubscribeProperty calls handler when the properties under subtree ("" for
+// all of them) are set through this TenEnv, with the paths of the changes. The
+// changes made in a row are batched into a single call, and the calls of the
+// handlers never overlap with each other.
+//
+// The handlers run on a goroutine of the watcher, not on the runloop of the
+// extension, so they run concurrently with OnCmd, OnData and the like, and
+// must synchronize with them on the state they share.
+//
+// It returns the id of the subscription, for UnsubscribeProperty.
+func (p *tenEnv) SubscribeProperty(
+	subtree string,
+	handler PropertyChangedHandler,
+) (uint64, error) {
+	if handler == nil {
+		return 0, newTenError(
+			ErrnoInvalidArgument,
+			"the handler is required",
+		)
+	}
+
+	return p.propertyWatcher.subscribe(subtree, handler), nil
+}
+
+// UnsubscribeProperty removes the subscription id, and returns false if there
+// is none. It does not wait for the goroutine of the watcher, so a call of the
+// handler which is running, or just about to start, could still happen after it
+// returns.
+func (p *tenEnv) UnsubscribeProperty(id uint64) bool {
+	return p.propertyWatcher.unsubscribe(id)
+}
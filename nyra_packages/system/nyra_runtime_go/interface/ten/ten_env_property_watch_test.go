@@ -0,0 +1,103 @@
+//
+// Copyright © 2024 Agora
+// This file is part of NYRA Framework, an open source project.
+// Licensed under the Apache License, Version 2.0, with certain conditions.
+// Refer to the "LICENSE" file in the root directory for more information.
+//
+
+package ten
+
+import (
+	"reflect"
+	"testing"
+	"time"
+)
+
+func TestIsPropertyPathRelated(t *testing.T) {
+	cases := []struct {
+		subtree string
+		path    string
+		related bool
+	}{
+		{"", "a", true},
+		{"tts", "tts", true},
+		{"tts", "tts.voice", true},
+		{"tts", "tts[0]", true},
+		{"tts.voice", "tts", true},
+		{"tts", "ttsx", false},
+		{"ttsx", "tts", false},
+		{"tts.voice", "tts.voice_id", false},
+		{"llm", "tts", false},
+	}
+
+	for _, c := range cases {
+		if isPropertyPathRelated(c.subtree, c.path) != c.related {
+			t.Errorf("%q %q: expected %v", c.subtree, c.path, c.related)
+		}
+	}
+}
+
+func TestPropertyWatcherBatches(t *testing.T) {
+	var w propertyWatcher
+
+	calls := make(chan []string, 10)
+	release := make(chan struct{})
+	id := w.subscribe("tts", func(_ TenEnv, paths []string) {
+		calls <- paths
+		<-release
+	})
+
+	next := func() []string {
+		select {
+		case paths := <-calls:
+			return paths
+		case <-time.After(5 * time.Second):
+			t.Fatal("no call")
+			return nil
+		}
+	}
+
+	w.notify(nil, "tts.voice")
+	if paths := next(); !reflect.DeepEqual(paths, []string{"tts.voice"}) {
+		t.Fatalf("unexpected paths %v", paths)
+	}
+
+	// The handler is still running, so these are batched.
+	w.notify(nil, "tts")
+	w.notify(nil, "llm.prompt")
+	w.notify(nil, "tts")
+	w.notify(nil, "tts.voice")
+	close(release)
+
+	if paths := next(); !reflect.DeepEqual(paths, []string{"tts", "tts.voice"}) {
+		t.Fatalf("unexpected paths %v", paths)
+	}
+
+	if !w.unsubscribe(id) || w.unsubscribe(id) {
+		t.FailNow()
+	}
+}
+
+func TestPropertyWatcherUnsubscribeInBatch(t *testing.T) {
+	var w propertyWatcher
+
+	done := make(chan struct{})
+	var second uint64
+	w.subscribe("", func(_ TenEnv, _ []string) {
+		w.unsubscribe(second)
+	})
+	second = w.subscribe("", func(_ TenEnv, _ []string) {
+		t.Error("called after being unsubscribed")
+	})
+	w.subscribe("", func(_ TenEnv, _ []string) {
+		close(done)
+	})
+
+	w.notify(nil, "tts")
+
+	select {
+	case <-done:
+	case <-time.After(5 * time.Second):
+		t.Fatal("no call")
+	}
+}
@@ -19,6 +19,8 @@ from .data import Data
 from .log_level import LogLevel
 from .test import ExtensionTester, TenEnvTester
 from .error import TenError
+from .mmap_file import MmapFile, MmapAdvice
+from .base64_stream import Base64Encoder, Base64Decoder
 
 # Specify what should be imported when a user imports * from the
 # nyra_runtime_python package.
@@ -43,4 +45,8 @@ __all__ = [
     "ExtensionTester",
     "TenEnvTester",
     "TenError",
+    "MmapFile",
+    "MmapAdvice",
+    "Base64Encoder",
+    "Base64Decoder",
 ]
@@ -7,7 +7,7 @@
 import asyncio
 import threading
 from asyncio import AbstractEventLoop
-from typing import AsyncGenerator, Optional
+from typing import AsyncGenerator, Callable, Optional
 
 from .cmd import Cmd
 from .data import Data
@@ -182,6 +182,8 @@ class AsyncTenEnv(TenEnvBase):
         if error is not None:
             raise RuntimeError(error.err_msg())
 
+        self._notify_property_changed(path)
+
     async def get_property_int(self, path: str) -> int:
         q = asyncio.Queue(maxsize=1)
         self._internal.get_property_int_async(
@@ -214,6 +216,8 @@ class AsyncTenEnv(TenEnvBase):
         if error is not None:
             raise RuntimeError(error.err_msg())
 
+        self._notify_property_changed(path)
+
     async def get_property_string(self, path: str) -> str:
         q = asyncio.Queue(maxsize=1)
         self._internal.get_property_string_async(
@@ -246,6 +250,8 @@ class AsyncTenEnv(TenEnvBase):
         if error is not None:
             raise RuntimeError(error.err_msg())
 
+        self._notify_property_changed(path)
+
     async def get_property_bool(self, path: str) -> bool:
         q = asyncio.Queue(maxsize=1)
         self._internal.get_property_bool_async(
@@ -277,6 +283,8 @@ class AsyncTenEnv(TenEnvBase):
         if error is not None:
             raise RuntimeError(error.err_msg())
 
+        self._notify_property_changed(path)
+
     async def get_property_float(self, path: str) -> float:
         q = asyncio.Queue(maxsize=1)
         self._internal.get_property_float_async(
@@ -308,6 +316,8 @@ class AsyncTenEnv(TenEnvBase):
         if error is not None:
             raise RuntimeError(error.err_msg())
 
+        self._notify_property_changed(path)
+
     async def is_property_exist(self, path: str) -> bool:
         q = asyncio.Queue(maxsize=1)
         self._internal.is_property_exist_async(
@@ -335,6 +345,10 @@ class AsyncTenEnv(TenEnvBase):
         if error is not None:
             raise RuntimeError(error.err_msg())
 
+    def _schedule_property_flush(self, flush: Callable[[], None]) -> None:
+        # After the tasks already queued on the loop.
+        self._nyra_loop.call_soon_threadsafe(flush)
+
     def _deinit_routine(self) -> None:
         # Wait for the internal thread to finish.
         self._nyra_thread.join()
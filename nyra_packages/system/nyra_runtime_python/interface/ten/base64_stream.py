@@ -0,0 +1,99 @@
+#
+# Copyright © 2024 Agora
+# This file is part of NYRA Framework, an open source project.
+# Licensed under the Apache License, Version 2.0, with certain conditions.
+# Refer to the "LICENSE" file in the root directory for more information.
+#
+import base64
+import binascii
+from typing import Union
+
+
+try:
+    binascii.a2b_base64(b"", strict_mode=True)
+
+    def _decode(chunk: bytes) -> bytes:
+        return binascii.a2b_base64(chunk, strict_mode=True)
+
+except TypeError:
+    # 'strict_mode' is only available since Python 3.11.
+    def _decode(chunk: bytes) -> bytes:
+        return base64.b64decode(chunk, validate=True)
+
+
+class Base64Encoder:
+    """Encodes a stream of bytes into standard base64 chunk by chunk, ex: the
+    audio frames sent to a realtime API, without joining them first.
+
+    The bytes which do not fill a group of 3 are kept for the next chunk, and
+    encoded with the padding by `finish`.
+    """
+
+    def __init__(self) -> None:
+        self._pending = b""
+
+    def update(self, data: Union[bytes, bytearray, memoryview]) -> bytes:
+        if self._pending:
+            data = self._pending + bytes(data)
+
+        view = memoryview(data)
+        whole = len(view) // 3 * 3
+        self._pending = bytes(view[whole:])
+
+        return binascii.b2a_base64(view[:whole], newline=False)
+
+    def finish(self) -> bytes:
+        pending, self._pending = self._pending, b""
+        return binascii.b2a_base64(pending, newline=False)
+
+
+class Base64Decoder:
+    """Decodes a stream of standard base64 chunk by chunk, ex: the audio deltas
+    received from a realtime API, without joining them first.
+
+    The decoding is strict: whitespace, characters out of the alphabet or data
+    after the padding raise a ValueError. The characters which do not fill a
+    group of 4 are kept for the next chunk.
+    """
+
+    def __init__(self) -> None:
+        self._pending = b""
+        self._padded = False
+
+    def update(self, data: Union[bytes, bytearray, str]) -> bytes:
+        if isinstance(data, str):
+            try:
+                data = data.encode("ascii")
+            except UnicodeEncodeError as e:
+                raise ValueError("invalid base64 data") from e
+
+        if not data:
+            return b""
+        if self._padded:
+            raise ValueError("base64 data after the padding")
+
+        if self._pending:
+            data = self._pending + bytes(data)
+
+        whole = len(data) // 4 * 4
+        self._pending = bytes(data[whole:])
+        if not whole:
+            return b""
+
+        chunk = data[:whole] if whole < len(data) else data
+        if chunk[-1:] == b"=":
+            if self._pending:
+                raise ValueError("base64 data after the padding")
+            self._padded = True
+
+        return _decode(chunk)
+
+    def finish(self) -> None:
+        """Checks the end of the stream, and resets the decoder for another
+        one."""
+        truncated = bool(self._pending)
+        self._pending = b""
+        self._padded = False
+
+        if truncated:
+            raise ValueError("truncated base64 data")
@@ -32,49 +32,49 @@ class Extension(_Extension):
             # function, it allows setting breakpoints in all Extension::on_xxx
             # methods.
             debugpy.debug_this_thread()
-        self.on_configure(nyra_env)
+        nyra_env._dispatch(self.on_configure, nyra_env)
 
     def on_configure(self, nyra_env: TenEnv) -> None:
         nyra_env.on_configure_done()
 
     @final
     def _proxy_on_init(self, nyra_env: TenEnv) -> None:
-        self.on_init(nyra_env)
+        nyra_env._dispatch(self.on_init, nyra_env)
 
     def on_init(self, nyra_env: TenEnv) -> None:
         nyra_env.on_init_done()
 
     @final
     def _proxy_on_start(self, nyra_env: TenEnv) -> None:
-        self.on_start(nyra_env)
+        nyra_env._dispatch(self.on_start, nyra_env)
 
     def on_start(self, nyra_env: TenEnv) -> None:
         nyra_env.on_start_done()
 
     @final
     def _proxy_on_stop(self, nyra_env: TenEnv) -> None:
-        self.on_stop(nyra_env)
+        nyra_env._dispatch(self.on_stop, nyra_env)
 
     def on_stop(self, nyra_env: TenEnv) -> None:
         nyra_env.on_stop_done()
 
     @final
     def _proxy_on_deinit(self, nyra_env: TenEnv) -> None:
-        self.on_deinit(nyra_env)
+        nyra_env._dispatch(self.on_deinit, nyra_env)
 
     def on_deinit(self, nyra_env: TenEnv) -> None:
         nyra_env.on_deinit_done()
 
     @final
     def _proxy_on_cmd(self, nyra_env: TenEnv, cmd: Cmd) -> None:
-        self.on_cmd(nyra_env, cmd)
+        nyra_env._dispatch(self.on_cmd, nyra_env, cmd)
 
     def on_cmd(self, nyra_env: TenEnv, cmd: Cmd) -> None:
         pass
 
     @final
     def _proxy_on_data(self, nyra_env: TenEnv, data: Data) -> None:
-        self.on_data(nyra_env, data)
+        nyra_env._dispatch(self.on_data, nyra_env, data)
 
     def on_data(self, nyra_env: TenEnv, data: Data) -> None:
         pass
@@ -83,7 +83,7 @@ class Extension(_Extension):
     def _proxy_on_video_frame(
         self, nyra_env: TenEnv, video_frame: VideoFrame
     ) -> None:
-        self.on_video_frame(nyra_env, video_frame)
+        nyra_env._dispatch(self.on_video_frame, nyra_env, video_frame)
 
     def on_video_frame(self, nyra_env: TenEnv, video_frame: VideoFrame) -> None:
         pass
@@ -92,7 +92,7 @@ class Extension(_Extension):
     def _proxy_on_audio_frame(
         self, nyra_env: TenEnv, audio_frame: AudioFrame
     ) -> None:
-        self.on_audio_frame(nyra_env, audio_frame)
+        nyra_env._dispatch(self.on_audio_frame, nyra_env, audio_frame)
 
     def on_audio_frame(self, nyra_env: TenEnv, audio_frame: AudioFrame) -> None:
         pass
@@ -0,0 +1,77 @@
+#
+# Copyright © 2024 Agora
+# This file is part of NYRA Framework, an open source project.
+# Licensed under the Apache License, Version 2.0, with certain conditions.
+# Refer to the "LICENSE" file in the root directory for more information.
+#
+import mmap
+import os
+from enum import IntEnum
+from typing import Optional
+
+
+class MmapAdvice(IntEnum):
+    NORMAL = 0
+    SEQUENTIAL = 1
+    RANDOM = 2
+    WILLNEED = 3
+
+
+_MADVISE = {
+    MmapAdvice.NORMAL: getattr(mmap, "MADV_NORMAL", None),
+    MmapAdvice.SEQUENTIAL: getattr(mmap, "MADV_SEQUENTIAL", None),
+    MmapAdvice.RANDOM: getattr(mmap, "MADV_RANDOM", None),
+    MmapAdvice.WILLNEED: getattr(mmap, "MADV_WILLNEED", None),
+}
+
+
+class MmapFile:
+    """A read-only view of a whole file, used to read large documents, audio
+    prompts and model assets without copying them into the Python heap.
+
+    The content is exposed as a memoryview, which must be released before the
+    file is closed.
+
+    The mapping is owned by Python, so it could not back the buf of a message
+    the way 'nyra_data_set_buf_with_mmap_file()' does in C. Passing the view to
+    'set_property_buf()' or to the buf of a Data copies the content.
+    """
+
+    def __init__(self, path: str, advice: MmapAdvice = MmapAdvice.NORMAL):
+        self._mmap: Optional[mmap.mmap] = None
+
+        with open(path, "rb") as f:
+            # An empty file could not be mapped.
+            if os.fstat(f.fileno()).st_size > 0:
+                self._mmap = mmap.mmap(
+                    f.fileno(), 0, access=mmap.ACCESS_READ
+                )
+
+        if advice != MmapAdvice.NORMAL:
+            self.advise(advice)
+
+    def advise(self, advice: MmapAdvice) -> None:
+        # 'mmap.madvise' is only available on some platforms, and it is only a
+        # hint anyway.
+        flag = _MADVISE.get(advice)
+        if self._mmap is not None and flag is not None:
+            self._mmap.madvise(flag)
+
+    def size(self) -> int:
+        return len(self._mmap) if self._mmap is not None else 0
+
+    def view(self) -> memoryview:
+        if self._mmap is None:
+            return memoryview(b"")
+        return memoryview(self._mmap)
+
+    def close(self) -> None:
+        if self._mmap is not None:
+            self._mmap.close()
+            self._mmap = None
+
+    def __enter__(self) -> "MmapFile":
+        return self
+
+    def __exit__(self, *_) -> None:
+        self.close()
@@ -0,0 +1,100 @@
+#
+# Copyright © 2024 Agora
+# This file is part of NYRA Framework, an open source project.
+# Licensed under the Apache License, Version 2.0, with certain conditions.
+# Refer to the "LICENSE" file in the root directory for more information.
+#
+import asyncio
+import inspect
+from typing import Any, Callable
+
+
+# Called with the ten_env and the paths of the properties which have changed
+# under the subtree of the subscription. It could be a coroutine function for
+# an AsyncTenEnv.
+PropertyChangedHandler = Callable[[Any, list[str]], Any]
+
+
+def _is_property_path_related(subtree: str, path: str) -> bool:
+    """Whether a change of `path` is a change of the subtree, i.e. one of them
+    is the other or a descendant of it."""
+    if not subtree:
+        return True
+
+    long, short = path, subtree
+    if len(subtree) > len(path):
+        long, short = subtree, path
+
+    if not long.startswith(short):
+        return False
+    if len(long) == len(short):
+        return True
+    return long[len(short)] in ".["
+
+
+class _PropertyWatcher:
+    """The subscriptions to the properties of a ten_env, which are called when
+    they are set through it.
+
+    The changes are collected until `schedule` runs the flush, so the changes
+    made in a row, or by the handlers, are batched into a single call per
+    subscription. `schedule` is given the flush, and must run it later rather
+    than before returning.
+    """
+
+    def __init__(
+        self,
+        nyra_env: Any,
+        schedule: Callable[[Callable[[], None]], None],
+    ) -> None:
+        self._nyra_env = nyra_env
+        self._schedule = schedule
+
+        self._subscriptions: dict[int, tuple[str, PropertyChangedHandler]] = {}
+        self._last_id = 0
+
+        self._changed: list[str] = []
+        self._scheduled = False
+
+    def subscribe(self, subtree: str, handler: PropertyChangedHandler) -> int:
+        self._last_id += 1
+        self._subscriptions[self._last_id] = (subtree, handler)
+        return self._last_id
+
+    def unsubscribe(self, id: int) -> bool:
+        return self._subscriptions.pop(id, None) is not None
+
+    def notify(self, path: str) -> None:
+        if not self._subscriptions:
+            return
+
+        if path not in self._changed:
+            self._changed.append(path)
+
+        if not self._scheduled:
+            self._scheduled = True
+            self._schedule(self._flush)
+
+    def _flush(self) -> None:
+        try:
+            while self._changed:
+                changed, self._changed = self._changed, []
+
+                for id, (subtree, handler) in list(
+                    self._subscriptions.items()
+                ):
+                    if id not in self._subscriptions:
+                        # Unsubscribed by a previous handler.
+                        continue
+
+                    related = [
+                        path
+                        for path in changed
+                        if _is_property_path_related(subtree, path)
+                    ]
+                    if related:
+                        result = handler(self._nyra_env, related)
+                        if inspect.isawaitable(result):
+                            asyncio.ensure_future(result)
+        finally:
+            self._scheduled = False
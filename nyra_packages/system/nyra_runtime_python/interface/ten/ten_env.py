@@ -4,7 +4,7 @@
 # Licensed under the Apache License, Version 2.0, with certain conditions.
 # Refer to the "LICENSE" file in the root directory for more information.
 #
-from typing import Callable, Optional
+from typing import Any, Callable, Optional
 
 from libnyra_runtime_python import _Extension, _TenEnv
 from .error import TenError
@@ -32,9 +32,40 @@ class TenEnv(TenEnvBase):
     def __init__(self, internal_obj: _TenEnv) -> None:
         super().__init__(internal_obj)
 
+        # The callbacks of the extension and the handlers of the results being
+        # run on the extension thread, and the flush of the property changes
+        # made by them, which is run when the outermost one returns.
+        self._dispatch_depth = 0
+        self._pending_flush: Optional[Callable[[], None]] = None
+
     def __del__(self) -> None:
         pass
 
+    def _dispatch(self, callback: Callable[..., Any], *args: Any) -> Any:
+        self._dispatch_depth += 1
+        try:
+            return callback(*args)
+        finally:
+            self._dispatch_depth -= 1
+            if self._dispatch_depth == 0 and self._pending_flush is not None:
+                flush, self._pending_flush = self._pending_flush, None
+                flush()
+
+    def _wrap_handler(
+        self, handler: Optional[Callable[..., None]]
+    ) -> Optional[Callable[..., None]]:
+        if handler is None:
+            return None
+        return lambda *args: self._dispatch(handler, *args)
+
+    def _schedule_property_flush(self, flush: Callable[[], None]) -> None:
+        if self._dispatch_depth > 0:
+            self._pending_flush = flush
+        else:
+            # Not in a callback dispatched to the extension, e.g. in the
+            # handler of an addon, so there is nothing to wait for.
+            flush()
+
     def _set_release_handler(self, handler: Callable[[], None]) -> None:
         self._release_handler = handler
 
@@ -77,26 +108,35 @@ class TenEnv(TenEnvBase):
         return self._internal.get_property_to_json(path)
 
     def set_property_from_json(self, path: str, json_str: str) -> None:
-        return self._internal.set_property_from_json(path, json_str)
+        self._internal.set_property_from_json(path, json_str)
+        self._notify_property_changed(path)
 
     def send_cmd(self, cmd: Cmd, result_handler: ResultHandler) -> None:
-        self._internal.send_cmd(cmd, result_handler, False)
+        self._internal.send_cmd(
+            cmd, self._wrap_handler(result_handler), False
+        )
 
     def send_cmd_ex(self, cmd: Cmd, result_handler: ResultHandler) -> None:
-        self._internal.send_cmd(cmd, result_handler, True)
+        self._internal.send_cmd(
+            cmd, self._wrap_handler(result_handler), True
+        )
 
     def send_data(self, data: Data, error_handler: ErrorHandler = None) -> None:
-        self._internal.send_data(data, error_handler)
+        self._internal.send_data(data, self._wrap_handler(error_handler))
 
     def send_video_frame(
         self, video_frame: VideoFrame, error_handler: ErrorHandler = None
     ) -> None:
-        self._internal.send_video_frame(video_frame, error_handler)
+        self._internal.send_video_frame(
+            video_frame, self._wrap_handler(error_handler)
+        )
 
     def send_audio_frame(
         self, audio_frame: AudioFrame, error_handler: ErrorHandler = None
     ) -> None:
-        self._internal.send_audio_frame(audio_frame, error_handler)
+        self._internal.send_audio_frame(
+            audio_frame, self._wrap_handler(error_handler)
+        )
 
     def return_result(
         self,
@@ -104,12 +144,16 @@ class TenEnv(TenEnvBase):
         target_cmd: Cmd,
         error_handler: ErrorHandler = None,
     ) -> None:
-        self._internal.return_result(result, target_cmd, error_handler)
+        self._internal.return_result(
+            result, target_cmd, self._wrap_handler(error_handler)
+        )
 
     def return_result_directly(
         self, result: CmdResult, error_handler: ErrorHandler = None
     ) -> None:
-        self._internal.return_result_directly(result, error_handler)
+        self._internal.return_result_directly(
+            result, self._wrap_handler(error_handler)
+        )
 
     def is_property_exist(self, path: str) -> bool:
         return self._internal.is_property_exist(path)
@@ -118,28 +162,32 @@ class TenEnv(TenEnvBase):
         return self._internal.get_property_int(path)
 
     def set_property_int(self, path: str, value: int) -> None:
-        return self._internal.set_property_int(path, value)
+        self._internal.set_property_int(path, value)
+        self._notify_property_changed(path)
 
     def get_property_string(self, path: str) -> str:
         return self._internal.get_property_string(path)
 
     def set_property_string(self, path: str, value: str) -> None:
-        return self._internal.set_property_string(path, value)
+        self._internal.set_property_string(path, value)
+        self._notify_property_changed(path)
 
     def get_property_bool(self, path: str) -> bool:
         return self._internal.get_property_bool(path)
 
     def set_property_bool(self, path: str, value: bool) -> None:
         if value:
-            return self._internal.set_property_bool(path, 1)
+            self._internal.set_property_bool(path, 1)
         else:
-            return self._internal.set_property_bool(path, 0)
+            self._internal.set_property_bool(path, 0)
+        self._notify_property_changed(path)
 
     def get_property_float(self, path: str) -> float:
         return self._internal.get_property_float(path)
 
     def set_property_float(self, path: str, value: float) -> None:
-        return self._internal.set_property_float(path, value)
+        self._internal.set_property_float(path, value)
+        self._notify_property_changed(path)
 
     def init_property_from_json(self, json_str: str) -> None:
         return self._internal.init_property_from_json(json_str)
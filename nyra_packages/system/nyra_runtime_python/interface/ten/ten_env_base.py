@@ -5,18 +5,51 @@
 # Refer to the "LICENSE" file in the root directory for more information.
 #
 import inspect
+from typing import Callable, Optional
 
 from libnyra_runtime_python import _TenEnv
 from .log_level import LogLevel
+from .property_watcher import PropertyChangedHandler, _PropertyWatcher
 
 
 class TenEnvBase:
     def __init__(self, internal_obj: _TenEnv) -> None:
         self._internal = internal_obj
+        self._property_watcher: Optional[_PropertyWatcher] = None
 
     def __del__(self) -> None:
         pass
 
+    def subscribe_property(
+        self, subtree: str, handler: PropertyChangedHandler
+    ) -> int:
+        """Call `handler` with the paths of the changes when the properties
+        under `subtree` ("" for all of them) are set through this ten_env. The
+        changes made in a row are batched into a single call. On a TenEnv it is
+        made on the extension thread when the callback of the extension, or the
+        handler of a result, which set the properties returns. On an
+        AsyncTenEnv it is made on its loop.
+
+        Returns the id of the subscription, for `unsubscribe_property`.
+        """
+        if self._property_watcher is None:
+            self._property_watcher = _PropertyWatcher(
+                self, self._schedule_property_flush
+            )
+        return self._property_watcher.subscribe(subtree, handler)
+
+    def unsubscribe_property(self, id: int) -> bool:
+        if self._property_watcher is None:
+            return False
+        return self._property_watcher.unsubscribe(id)
+
+    def _notify_property_changed(self, path: str) -> None:
+        if self._property_watcher is not None:
+            self._property_watcher.notify(path)
+
+    def _schedule_property_flush(self, flush: Callable[[], None]) -> None:
+        raise NotImplementedError
+
     def log_verbose(self, msg: str) -> None:
         self._log_internal(LogLevel.VERBOSE, msg, 2)
 
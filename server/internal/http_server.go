@@ -16,7 +16,6 @@ import (
 	"net/url"
 	"os"
 	"path/filepath"
-	"regexp"
 	"strings"
 	"time"
 
@@ -436,49 +435,15 @@ func (s *HttpServer) handlerVectorDocumentUpload(c *gin.Context) {
 
 func (s *HttpServer) handlerGraphs(c *gin.Context) {
 	slog.Info("handlerGraphs start", logTag)
-	content, err := os.ReadFile(PropertyJsonFile)
+	doc, err := propertyJsonCache.get()
 	if err != nil {
-		slog.Error("handlerGraphs read property.json failed", "err", err, logTag)
+		slog.Error("handlerGraphs load property.json failed", "err", err, logTag)
 		s.output(c, codeErrProcessPropertyFailed, http.StatusInternalServerError)
 		return
 	}
 
-	var propertyJson map[string]interface{}
-	err = json.Unmarshal(content, &propertyJson)
-	if err != nil {
-		slog.Error("handlerGraphs unmarshal property.json failed", "err", err, logTag)
-		s.output(c, codeErrProcessPropertyFailed, http.StatusInternalServerError)
-		return
-	}
-
-	tenSection, ok := propertyJson["_nyra"].(map[string]interface{})
-	if !ok {
-		slog.Error("Invalid format: _nyra section missing", logTag)
-		s.output(c, codeErrProcessPropertyFailed, http.StatusInternalServerError)
-		return
-	}
-
-	predefinedGraphs, ok := tenSection["predefined_graphs"].([]interface{})
-	if !ok {
-		slog.Error("Invalid format: predefined_graphs missing or not an array", logTag)
-		s.output(c, codeErrProcessPropertyFailed, http.StatusInternalServerError)
-		return
-	}
-
-	var graphs []map[string]interface{}
-	for _, graph := range predefinedGraphs {
-		graphMap, ok := graph.(map[string]interface{})
-		if !ok {
-			continue
-		}
-		graphs = append(graphs, map[string]interface{}{
-			"name": graphMap["name"],
-			"auto_start": graphMap["auto_start"],
-		})
-	}
-
 	slog.Info("handlerGraphs end", logTag)
-	s.output(c, codeSuccess, graphs)
+	s.output(c, codeSuccess, doc.graphList)
 }
 
 func (s *HttpServer) output(c *gin.Context, code *Code, data any, httpStatus ...int) {
@@ -490,17 +455,11 @@ func (s *HttpServer) output(c *gin.Context, code *Code, data any, httpStatus ...
 }
 
 func (s *HttpServer) processProperty(req *StartReq) (propertyJsonFile string, logFile string, err error) {
-	content, err := os.ReadFile(PropertyJsonFile)
-	if err != nil {
-		slog.Error("handlerStart read property.json failed", "err", err, "propertyJsonFile", propertyJsonFile, "requestId", req.RequestId, logTag)
-		return
-	}
+	start := time.Now()
 
-	// Unmarshal the JSON content into a map
-	var propertyJson map[string]interface{}
-	err = json.Unmarshal(content, &propertyJson)
+	doc, err := propertyJsonCache.get()
 	if err != nil {
-		slog.Error("handlerStart unmarshal property.json failed", "err", err, "requestId", req.RequestId, logTag)
+		slog.Error("handlerStart load property.json failed", "err", err, "requestId", req.RequestId, logTag)
 		return
 	}
 
@@ -522,126 +481,43 @@ func (s *HttpServer) processProperty(req *StartReq) (propertyJsonFile string, lo
 		}
 	}
 
-	// Locate the predefined graphs array
-	tenSection, ok := propertyJson["_nyra"].(map[string]interface{})
-	if !ok {
-		slog.Error("Invalid format: _nyra section missing", "requestId", req.RequestId, logTag)
-		return
-	}
-
-	predefinedGraphs, ok := tenSection["predefined_graphs"].([]interface{})
-	if !ok {
-		slog.Error("Invalid format: predefined_graphs missing or not an array", "requestId", req.RequestId, logTag)
-		return
-	}
-
-	// Filter the graph with the matching name
-	var newGraphs []interface{}
-	for _, graph := range predefinedGraphs {
-		graphMap, ok := graph.(map[string]interface{})
-		if ok && graphMap["name"] == graphName {
-			newGraphs = append(newGraphs, graph)
+	// Collect the properties to set, the start parameters taking precedence
+	// over the additional properties of the request.
+	overrides := make(map[string]map[string]interface{})
+	setOverride := func(extensionName string, prop string, val interface{}) {
+		if overrides[extensionName] == nil {
+			overrides[extensionName] = make(map[string]interface{})
 		}
+		overrides[extensionName][prop] = val
 	}
 
-	if len(newGraphs) == 0 {
-		slog.Error("handlerStart graph not found", "graph", graphName, "requestId", req.RequestId, logTag)
-		err = fmt.Errorf("graph not found")
-		return
-	}
-
-	// Replace the predefined_graphs array with the filtered array
-	tenSection["predefined_graphs"] = newGraphs
-
-	// Automatically start on launch
-	for _, graph := range newGraphs {
-		graphMap, _ := graph.(map[string]interface{})
-		graphMap["auto_start"] = true
-	}
-
-	// Set additional properties to property.json
 	for extensionName, props := range req.Properties {
 		if extensionName != "" {
 			for prop, val := range props {
-				// Construct the path in the nested graph structure
-				for _, graph := range newGraphs {
-					graphMap, _ := graph.(map[string]interface{})
-					nodes, _ := graphMap["nodes"].([]interface{})
-					for _, node := range nodes {
-						nodeMap, _ := node.(map[string]interface{})
-						if nodeMap["name"] == extensionName {
-							properties := nodeMap["property"].(map[string]interface{})
-							properties[prop] = val
-						}
-					}
-				}
+				setOverride(extensionName, prop, val)
 			}
 		}
 	}
 
-	// Set start parameters to property.json
 	for key, props := range startPropMap {
 		val := getFieldValue(req, key)
 		if val != "" {
 			for _, prop := range props {
-				// Set each start parameter to the appropriate graph and property
-				for _, graph := range newGraphs {
-					graphMap, _ := graph.(map[string]interface{})
-					nodes, _ := graphMap["nodes"].([]interface{})
-					for _, node := range nodes {
-						nodeMap, _ := node.(map[string]interface{})
-						if nodeMap["name"] == prop.ExtensionName {
-							properties := nodeMap["property"].(map[string]interface{})
-							properties[prop.Property] = val
-						}
-					}
-				}
+				setOverride(prop.ExtensionName, prop.Property, val)
 			}
 		}
 	}
 
-	// Validate environment variables in the "nodes" section
-	envPattern := regexp.MustCompile(`\${env:([^}|]+)}`)
-	for _, graph := range newGraphs {
-		graphMap, _ := graph.(map[string]interface{})
-		nodes, ok := graphMap["nodes"].([]interface{})
-		if !ok {
-			slog.Info("No nodes section in the graph", "graph", graphName, "requestId", req.RequestId, logTag)
-			continue
-		}
-		for _, node := range nodes {
-			nodeMap, _ := node.(map[string]interface{})
-			properties, ok := nodeMap["property"].(map[string]interface{})
-			if !ok {
-				// slog.Info("No property section in the node", "node", nodeMap, "requestId", req.RequestId, logTag)
-				continue
-			}
-			for key, val := range properties {
-				strVal, ok := val.(string)
-				if !ok {
-					continue
-				}
-				// Log the property value being processed
-				// slog.Info("Processing property", "key", key, "value", strVal)
-
-				matches := envPattern.FindAllStringSubmatch(strVal, -1)
-				// if len(matches) == 0 {
-				// 	slog.Info("No environment variable patterns found in property", "key", key, "value", strVal)
-				// }
-
-				for _, match := range matches {
-					if len(match) < 2 {
-						continue
-					}
-					variable := match[1]
-					exists := os.Getenv(variable) != ""
-					// slog.Info("Checking environment variable", "variable", variable, "exists", exists)
-					if !exists {
-						slog.Error("Environment variable not found", "variable", variable, "property", key, "requestId", req.RequestId, logTag)
-					}
-				}
-			}
+	propertyJson, envSites, err := doc.render(graphName, overrides)
+	if err != nil {
+		slog.Error("handlerStart graph not found", "graph", graphName, "requestId", req.RequestId, logTag)
+		return
+	}
 
+	// Validate environment variables in the "nodes" section
+	for _, site := range envSites {
+		if os.Getenv(site.Variable) == "" {
+			slog.Error("Environment variable not found", "variable", site.Variable, "property", site.Property, "requestId", req.RequestId, logTag)
 		}
 	}
 
@@ -657,6 +533,8 @@ func (s *HttpServer) processProperty(req *StartReq) (propertyJsonFile string, lo
 	logFile = fmt.Sprintf("%s/app-%s-%s.log", s.config.LogPath, url.QueryEscape(req.ChannelName), ts)
 	os.WriteFile(propertyJsonFile, []byte(modifiedPropertyJson), 0644)
 
+	slog.Info("handlerStart property.json generated", "graph", graphName, "duration", time.Since(start), "requestId", req.RequestId, logTag)
+
 	return
 }
 
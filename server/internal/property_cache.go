@@ -0,0 +1,250 @@
+package internal
+
+import (
+	"encoding/json"
+	"fmt"
+	"log/slog"
+	"os"
+	"regexp"
+	"sync"
+	"time"
+)
+
+// property.json is parsed once and kept until the file changes, instead of
+// being read and parsed again for each session. The graphs are indexed by
+// name, the nodes of each graph by name, and the ${env:VAR} sites of the node
+// properties are found at load time, so starting a session only copies the
+// parts of the document it overrides before marshaling it.
+//
+// The parsed document is shared by the sessions and never modified after load.
+
+var envPattern = regexp.MustCompile(`\${env:([^}|]+)}`)
+
+type envSite struct {
+	Node     string
+	Property string
+	Variable string
+}
+
+type propertyGraph struct {
+	graph     map[string]interface{}
+	nodes     []interface{}
+	nodeIndex map[string][]int
+	envSites  []envSite
+}
+
+type propertyDoc struct {
+	modTime time.Time
+	size    int64
+
+	root   map[string]interface{}
+	tenSec map[string]interface{}
+	graphs map[string][]*propertyGraph
+
+	// For handlerGraphs, in the order of the file.
+	graphList []map[string]interface{}
+}
+
+type propertyCache struct {
+	path string
+
+	mu  sync.Mutex
+	doc *propertyDoc
+}
+
+var propertyJsonCache = &propertyCache{path: PropertyJsonFile}
+
+// get returns the parsed document, parsing the file again only if its
+// modification time or size changed since the last load.
+func (c *propertyCache) get() (*propertyDoc, error) {
+	info, err := os.Stat(c.path)
+	if err != nil {
+		return nil, err
+	}
+
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	if c.doc != nil && c.doc.modTime.Equal(info.ModTime()) && c.doc.size == info.Size() {
+		return c.doc, nil
+	}
+
+	start := time.Now()
+	doc, err := loadPropertyDoc(c.path)
+	if err != nil {
+		return nil, err
+	}
+
+	doc.modTime = info.ModTime()
+	doc.size = info.Size()
+	c.doc = doc
+
+	slog.Info("property.json loaded", "file", c.path, "size", doc.size, "graphs", len(doc.graphList), "duration", time.Since(start), logTag)
+	return doc, nil
+}
+
+func loadPropertyDoc(path string) (*propertyDoc, error) {
+	content, err := os.ReadFile(path)
+	if err != nil {
+		return nil, err
+	}
+
+	var root map[string]interface{}
+	if err := json.Unmarshal(content, &root); err != nil {
+		return nil, err
+	}
+
+	tenSec, ok := root["_nyra"].(map[string]interface{})
+	if !ok {
+		return nil, fmt.Errorf("invalid format: _nyra section missing")
+	}
+
+	predefinedGraphs, ok := tenSec["predefined_graphs"].([]interface{})
+	if !ok {
+		return nil, fmt.Errorf("invalid format: predefined_graphs missing or not an array")
+	}
+
+	doc := &propertyDoc{
+		root:   root,
+		tenSec: tenSec,
+		graphs: make(map[string][]*propertyGraph),
+	}
+
+	for _, graph := range predefinedGraphs {
+		graphMap, ok := graph.(map[string]interface{})
+		if !ok {
+			continue
+		}
+
+		doc.graphList = append(doc.graphList, map[string]interface{}{
+			"name":       graphMap["name"],
+			"auto_start": graphMap["auto_start"],
+		})
+
+		name, _ := graphMap["name"].(string)
+		doc.graphs[name] = append(doc.graphs[name], newPropertyGraph(graphMap))
+	}
+
+	return doc, nil
+}
+
+func newPropertyGraph(graphMap map[string]interface{}) *propertyGraph {
+	g := &propertyGraph{
+		graph:     graphMap,
+		nodeIndex: make(map[string][]int),
+	}
+
+	g.nodes, _ = graphMap["nodes"].([]interface{})
+	for i, node := range g.nodes {
+		nodeMap, ok := node.(map[string]interface{})
+		if !ok {
+			continue
+		}
+
+		name, _ := nodeMap["name"].(string)
+		g.nodeIndex[name] = append(g.nodeIndex[name], i)
+
+		properties, _ := nodeMap["property"].(map[string]interface{})
+		for key, val := range properties {
+			strVal, ok := val.(string)
+			if !ok {
+				continue
+			}
+			for _, variable := range envVariables(strVal) {
+				g.envSites = append(g.envSites, envSite{Node: name, Property: key, Variable: variable})
+			}
+		}
+	}
+
+	return g
+}
+
+func envVariables(val string) (variables []string) {
+	for _, match := range envPattern.FindAllStringSubmatch(val, -1) {
+		if len(match) >= 2 {
+			variables = append(variables, match[1])
+		}
+	}
+	return
+}
+
+// render builds the property.json of a session running graphName, with the
+// node properties in overrides (node name -> property -> value) set on top of
+// the ones of the file. Only the graph, and the nodes which are overridden,
+// are copied; everything else is shared with the cached document.
+func (d *propertyDoc) render(graphName string, overrides map[string]map[string]interface{}) (map[string]interface{}, []envSite, error) {
+	graphs := d.graphs[graphName]
+	if len(graphs) == 0 {
+		return nil, nil, fmt.Errorf("graph not found")
+	}
+
+	var newGraphs []interface{}
+	var sites []envSite
+
+	for _, g := range graphs {
+		graphMap := shallowCopy(g.graph)
+
+		// Automatically start on launch
+		graphMap["auto_start"] = true
+
+		if len(overrides) > 0 && g.nodes != nil {
+			nodes := make([]interface{}, len(g.nodes))
+			copy(nodes, g.nodes)
+
+			for nodeName, props := range overrides {
+				for _, i := range g.nodeIndex[nodeName] {
+					nodeMap := shallowCopy(nodes[i].(map[string]interface{}))
+
+					properties, _ := nodeMap["property"].(map[string]interface{})
+					properties = shallowCopy(properties)
+					for prop, val := range props {
+						properties[prop] = val
+					}
+
+					nodeMap["property"] = properties
+					nodes[i] = nodeMap
+				}
+			}
+
+			graphMap["nodes"] = nodes
+		}
+
+		// The sites of the overridden properties are replaced by the sites of
+		// their new values.
+		for _, site := range g.envSites {
+			if _, ok := overrides[site.Node][site.Property]; !ok {
+				sites = append(sites, site)
+			}
+		}
+		for nodeName, props := range overrides {
+			if len(g.nodeIndex[nodeName]) == 0 {
+				continue
+			}
+			for prop, val := range props {
+				if strVal, ok := val.(string); ok {
+					for _, variable := range envVariables(strVal) {
+						sites = append(sites, envSite{Node: nodeName, Property: prop, Variable: variable})
+					}
+				}
+			}
+		}
+
+		newGraphs = append(newGraphs, graphMap)
+	}
+
+	tenSec := shallowCopy(d.tenSec)
+	tenSec["predefined_graphs"] = newGraphs
+
+	root := shallowCopy(d.root)
+	root["_nyra"] = tenSec
+
+	return root, sites, nil
+}
+
+func shallowCopy(m map[string]interface{}) map[string]interface{} {
+	result := make(map[string]interface{}, len(m)+1)
+	for k, v := range m {
+		result[k] = v
+	}
+	return result
+}